@@ -1,13 +1,16 @@
 #include <appdef.hpp>
 
 /*
- * Fill this section in with some information about your app.
- * All fields are optional - so if you don't need one, take it out.
+ * Fill this section in with some information about your app: its name,
+ * description, author and version.
+ * All fields are optional - so if you don't need one, leave it as "".
  */
-APP_NAME("My app name")
-APP_DESCRIPTION("A short description of my app")
-APP_AUTHOR("My name")
-APP_VERSION("1.0.0")
+APP_INFO(
+    "My app name",
+    "A short description of my app",
+    "My name",
+    "1.0.0"
+)
 
 extern "C"
 void main() {
@@ -1,4 +1,7 @@
 #include <appdef.hpp>
+#include <sdk/gfx/dirty.hpp>
+#include <sdk/gfx/fill.hpp>
+#include <sdk/gfx/text.hpp>
 #include <sdk/os/debug.hpp>
 #include <sdk/os/input.hpp>
 #include <sdk/os/lcd.hpp>
@@ -11,6 +14,8 @@ APP_VERSION("1.0.0")
 #define COLOR_BACKGROUND RGB_TO_RGB565(0, 0, 0)
 #define COLOR_SNAKE RGB_TO_RGB565(0x1F, 0, 0)
 #define COLOR_FRUIT RGB_TO_RGB565(0, 0x3F, 0)
+#define COLOR_TEXT RGB_TO_RGB565(0, 0, 0)
+#define COLOR_TEXT_BACKGROUND RGB_TO_RGB565(0x1F, 0x3F, 0x1F)
 
 #define BLOCK_SIZE 20
 #define MAX_SNAKE_LENGTH 50
@@ -21,7 +26,9 @@ APP_VERSION("1.0.0")
 #define DIRECTION_SOUTH 2
 #define DIRECTION_WEST 3
 
-uint16_t *vram;
+struct GFX_Surface screen;
+// Only the blocks which change are drawn each frame
+struct GFX_DirtyRegion dirty;
 int lcdWidth, lcdHeight;
 int numBlocksX, numBlocksY;
 
@@ -40,40 +47,43 @@ int fruitX;
 int fruitY;
 
 void drawBlock(int blockX, int blockY, uint16_t color) {
-	for (int x = blockX * BLOCK_SIZE; x < (blockX + 1) * BLOCK_SIZE; ++x) {
-		for (int y = blockY * BLOCK_SIZE; y < (blockY + 1) * BLOCK_SIZE; ++y) {
-			vram[x + (y + 24) * lcdWidth] = color;
-		}
-	}
-}
-
-void draw() {
-	Debug_SetCursorPosition(0, 0);
-	Debug_PrintString("Score: ", false);
+	int x = blockX * BLOCK_SIZE;
+	int y = blockY * BLOCK_SIZE + 24;
 
-	char *num = "0000";
-	num[0] = (snakeLength / 1000) % 10 + '0';
-	num[1] = (snakeLength / 100) % 10 + '0';
-	num[2] = (snakeLength / 10) % 10 + '0';
-	num[3] = snakeLength % 10 + '0';
-	Debug_PrintString(num, false);
+	GFX_FillRect(&screen, x, y, BLOCK_SIZE, BLOCK_SIZE, color);
+	GFX_MarkDirty(&dirty, x, y, BLOCK_SIZE, BLOCK_SIZE);
+}
 
+void drawBoard() {
 	// Draw the background
-	for (int blockY = 0; blockY < numBlocksY; ++blockY) {
-		for (int blockX = 0; blockX < numBlocksX; ++blockX) {
-			drawBlock(blockX, blockY, COLOR_BACKGROUND);
-		}
-	}
+	GFX_FillRect(
+		&screen, 0, 24, numBlocksX * BLOCK_SIZE, numBlocksY * BLOCK_SIZE,
+		COLOR_BACKGROUND
+	);
+	GFX_MarkDirty(&dirty, 0, 24, numBlocksX * BLOCK_SIZE, numBlocksY * BLOCK_SIZE);
 
 	// Draw the snake
 	for (int i = 0; i < snakeLength; ++i) {
 		drawBlock(snakeX[i], snakeY[i], COLOR_SNAKE);
 	}
+}
+
+void draw() {
+	char score[32] = "Score: ";
+	GFX_FormatNumber(&score[7], snakeLength, 4);
+
+	GFX_DrawText(&screen, &GFX_FONT_8X8, 4, 8, score, COLOR_TEXT, COLOR_TEXT_BACKGROUND);
+	GFX_MarkDirty(
+		&dirty, 4, 8, GFX_MeasureText(&GFX_FONT_8X8, score), GFX_FONT_8X8.height
+	);
+
+	// The rest of the snake is already there - moveSnake rubs out its tail
+	drawBlock(snakeX[0], snakeY[0], COLOR_SNAKE);
 
 	// Draw the fruit
 	drawBlock(fruitX, fruitY, COLOR_FRUIT);
 
-	LCD_Refresh();
+	GFX_RefreshIfDirty(&dirty);
 }
 
 bool moveSnake() {
@@ -110,6 +120,9 @@ bool moveSnake() {
 	if (numBlocksToAdd > 0) {
 		--numBlocksToAdd;
 		++snakeLength;
+	} else {
+		// The old end of the tail is no longer part of the snake
+		drawBlock(snakeX[snakeLength], snakeY[snakeLength], COLOR_BACKGROUND);
 	}
 
 	return true;
@@ -175,8 +188,10 @@ void main() {
 	// Initialize our constants
 	LCD_ClearScreen();
 
-	vram = LCD_GetVRAMAddress();
-	LCD_GetSize(&lcdWidth, &lcdHeight);
+	GFX_GetVRAMSurface(&screen);
+	lcdWidth = screen.width;
+	lcdHeight = screen.height;
+	GFX_InitDirtyRegion(&dirty, lcdWidth, lcdHeight);
 
 	numBlocksX = lcdWidth / BLOCK_SIZE;
 	numBlocksY = (lcdHeight - 24) / BLOCK_SIZE;
@@ -192,6 +207,8 @@ void main() {
 	fruitYLFSR = 0xAF05432A;
 	moveFruit();
 
+	drawBoard();
+
 	struct InputEvent event;
 
 	bool lost = false;
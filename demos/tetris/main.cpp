@@ -1,4 +1,7 @@
 #include <appdef.hpp>
+#include <sdk/gfx/color.hpp>
+#include <sdk/gfx/fill.hpp>
+#include <sdk/gfx/text.hpp>
 #include <sdk/os/debug.hpp>
 #include <sdk/os/input.hpp>
 #include <sdk/os/lcd.hpp>
@@ -10,17 +13,12 @@ APP_DESCRIPTION("A simple implementation of the game Tetris.")
 APP_AUTHOR("De_Coder")
 APP_VERSION("1.0.0")
 
-void print_score(uint32_t score){	//prints to score to the top of the screen
-	Debug_SetCursorPosition(7, 0);
-	Debug_PrintString("Score: ", false);
+struct GFX_Surface screen;
 
-	char *num = "0000";
-	num[0] = (score / 1000) % 10 + '0';
-	num[1] = (score / 100) % 10 + '0';
-	num[2] = (score / 10) % 10 + '0';
-	num[3] = score % 10 + '0';
-	Debug_SetCursorPosition(14, 0);
-	Debug_PrintString(num, false);
+void print_score(uint32_t score){	//prints to score to the top of the screen
+	char text[32] = "Score: ";
+	GFX_FormatNumber(&text[7], score, 4);
+	GFX_DrawText(&screen, &GFX_FONT_8X8, 40, 16, text, RGB_TO_RGB565(0, 0, 0), RGB_TO_RGB565(0x1F, 0x3F, 0x1F));
 }
 
 uint32_t random(uint32_t rand){ //generates a pseudo random number
@@ -32,13 +30,7 @@ uint32_t random(uint32_t rand){ //generates a pseudo random number
 
 void draw_square(unsigned int x, unsigned int y, uint8_t color_index){	//draws one square at x,y in the color given by color_index
 	if(x <= 12 && y <= 22){
-		x = x * 20 + 41;
-		y = y * 20 + 41;
-		for(int i = 0; i < 18; i++){
-			for(int j = 0; j < 18; j++){
-				LCD_SetPixelFromPalette(x + i, y + j, color_index);
-			}
-		}
+		GFX_FillRect(&screen, x * 20 + 41, y * 20 + 41, 18, 18, GFX_PALETTE_COLORS[color_index]);
 	}
 }
 
@@ -112,6 +104,7 @@ void main() {
 	unsigned char block_type = 0;		//type of the active block
 	
 	LCD_VRAMBackup();
+	GFX_GetVRAMSurface(&screen);
 
 	LCD_ClearScreen();
 	LCD_Refresh();
@@ -140,17 +133,11 @@ void main() {
 	LCD_Refresh();
 	
 	for(int i = 0; i < 13; i++){	//draw vertical lines of the board
-		for(int j = 0; j < 440; j++){
-			LCD_SetPixel(i * 20 + 39, j + 40, 0);
-			LCD_SetPixel(i * 20 + 40, j + 40, 0);
-		}
+		GFX_FillRect(&screen, i * 20 + 39, 40, 2, 440, 0);
 	}
 	
 	for(int i = 0; i < 23; i++){	//draw horizontal lines of the board
-		for(int j = 0; j < 240; j++){
-			LCD_SetPixel(j + 40, i * 20 + 39, 0);
-			LCD_SetPixel(j + 40, i * 20 + 40, 0);
-		}
+		GFX_FillRect(&screen, 40, i * 20 + 39, 240, 2, 0);
 	}
 	
 	LCD_Refresh();
@@ -1,8 +1,15 @@
+#include <appdef.hpp>
+#include <sdk/launcher.hpp>
 #include <sdk/os/file.hpp>
+#include <sdk/os/lcd.hpp>
 #include <sdk/os/mem.hpp>
 #include <sdk/os/string.hpp>
 #include "apps.hpp"
+#include "arena.hpp"
+#include "crc32.hpp"
 #include "elf.h"
+#include "lz4.hpp"
+#include "timing.hpp"
 
 class File {
 public:
@@ -18,14 +25,23 @@ public:
 
 	int open(const char *path, int flags) {
 		m_fd = ::open(path, flags);
-		m_opened = true;
+		m_opened = m_fd >= 0;
 		return m_fd;
 	}
 
 	int getAddr(int offset, const void **addr) {
+		Timing::Probe probe(Timing::PhaseGetAddr);
 		return ::getAddr(m_fd, offset, addr);
 	}
 
+	int fstat(struct stat *buf) {
+		return ::fstat(m_fd, buf);
+	}
+
+	int write(const void *buf, int count) {
+		return ::write(m_fd, buf, count);
+	}
+
 private:
 	bool m_opened;
 	int m_fd;
@@ -44,12 +60,14 @@ public:
 	}
 
 	int findFirst(const wchar_t *path, wchar_t *name, struct findInfo *findInfoBuf) {
+		Timing::Probe probe(Timing::PhaseFind);
 		int ret = ::findFirst(path, &m_findHandle, name, findInfoBuf);
 		m_opened = true;
 		return ret;
 	}
 
 	int findNext(wchar_t *name, struct findInfo *findInfoBuf) {
+		Timing::Probe probe(Timing::PhaseFind);
 		return ::findNext(m_findHandle, name, findInfoBuf);
 	}
 
@@ -59,10 +77,168 @@ private:
 };
 
 namespace Apps {
-    struct AppInfo g_apps[MAX_APPS];
+    struct AppInfo *g_apps;
     int g_numApps;
 
-    const Elf32_Ehdr *LoadELF(File f, const Elf32_Shdr **sectionHeaders) {
+	// Indexes into g_apps, in order of the apps' names
+	int *g_appOrder;
+
+	// The number of apps g_apps has room for
+	int g_appsCapacity;
+
+	// Backing storage for the strings in g_apps and g_dirs
+	Arena g_appStrings;
+
+	/**
+	 * A directory which was searched for apps.
+	 */
+	struct DirInfo {
+		const char *path;
+		// The directory this one is in, or -1 for the root
+		int parent;
+		int depth;
+
+		// The apps found directly in this directory are g_apps[firstApp] up
+		// to g_apps[firstApp + numApps - 1].
+		int firstApp;
+		int numApps;
+
+		// Whether the directory could be stat'd. If not, it's always
+		// searched.
+		bool hasStat;
+		uint16_t lastModifiedDate;
+		uint16_t lastModifiedTime;
+
+		// The number of entries listed in the directory, and the total size
+		// of its files. Not every FAT driver updates a directory's timestamp
+		// when files are added to or removed from it, so these are checked
+		// too.
+		uint32_t numEntries;
+		uint32_t entriesSize;
+	};
+
+	// Every directory searched by the last call to LoadAppInfo. Parents always
+	// come before their sub-directories.
+	struct DirInfo *g_dirs;
+	int g_numDirs;
+	int g_dirsCapacity;
+
+	/**
+	 * Moves a table of @p count elements into a new allocation with room for
+	 * @p capacity elements, freeing the old one.
+	 */
+	void *GrowTable(void *table, int count, int capacity, uint32_t elementSize) {
+		void *newTable = malloc(capacity * elementSize);
+
+		if (table != nullptr) {
+			memcpy(newTable, table, count * elementSize);
+			free(table);
+		}
+
+		return newTable;
+	}
+
+	/**
+	 * Makes sure there's room in @ref g_apps for at least @p capacity apps.
+	 */
+	void ReserveApps(int capacity) {
+		if (capacity <= g_appsCapacity) {
+			return;
+		}
+
+		g_apps = static_cast<struct AppInfo *>(
+			GrowTable(g_apps, g_numApps, capacity, sizeof(struct AppInfo))
+		);
+		g_appsCapacity = capacity;
+	}
+
+	void ReserveDirs(int capacity) {
+		if (capacity <= g_dirsCapacity) {
+			return;
+		}
+
+		g_dirs = static_cast<struct DirInfo *>(
+			GrowTable(g_dirs, g_numDirs, capacity, sizeof(struct DirInfo))
+		);
+		g_dirsCapacity = capacity;
+	}
+
+	void AddApp(const struct AppInfo *app) {
+		if (g_numApps == g_appsCapacity) {
+			ReserveApps(g_appsCapacity == 0 ? 16 : g_appsCapacity * 2);
+		}
+
+		g_apps[g_numApps++] = *app;
+	}
+
+	/**
+	 * Adds a directory to the end of @ref g_dirs, to be searched later.
+	 *
+	 * @param path The directory's path, which must already be interned.
+	 */
+	void AddDir(const char *path, int parent) {
+		if (g_numDirs == g_dirsCapacity) {
+			ReserveDirs(g_dirsCapacity == 0 ? 8 : g_dirsCapacity * 2);
+		}
+
+		struct DirInfo *dir = &g_dirs[g_numDirs++];
+		dir->path = path;
+		dir->parent = parent;
+		dir->depth = parent < 0 ? 0 : g_dirs[parent].depth + 1;
+		dir->firstApp = 0;
+		dir->numApps = 0;
+		dir->hasStat = false;
+		dir->lastModifiedDate = 0;
+		dir->lastModifiedTime = 0;
+		dir->numEntries = 0;
+		dir->entriesSize = 0;
+	}
+
+	/**
+	 * Returns the length of a string which may not be null terminated, looking
+	 * at no more than @p maxLength characters.
+	 */
+	uint32_t BoundedStrlen(const char *str, uint32_t maxLength) {
+		uint32_t length = 0;
+		while (length < maxLength && str[length] != '\0') {
+			++length;
+		}
+
+		return length;
+	}
+
+	/**
+	 * If @p str starts with @p prefix, returns the rest of @p str. Otherwise,
+	 * returns nullptr.
+	 */
+	const char *SkipPrefix(const char *str, const char *prefix) {
+		for (; *prefix != '\0'; ++str, ++prefix) {
+			if (*str != *prefix) {
+				return nullptr;
+			}
+		}
+
+		return str;
+	}
+
+	/**
+	 * Points an app's file name at the last component of its path.
+	 */
+	void SetFileName(struct AppInfo *app) {
+		app->fileName = app->path;
+
+		for (const char *c = app->path; *c != '\0'; ++c) {
+			if (*c == '\\') {
+				app->fileName = c + 1;
+			}
+		}
+	}
+
+    // sectionHeaders is set to nullptr if the file has been stripped of its
+    // section header table.
+    const Elf32_Ehdr *LoadELF(File &f, const Elf32_Shdr **sectionHeaders) {
+        Timing::Probe probe(Timing::PhaseValidateELF);
+
         const Elf32_Ehdr *elf;
         int ret = f.getAddr(0, (const void **) &elf);
         if (ret < 0) {
@@ -99,8 +275,9 @@ namespace Apps {
             return nullptr;
         }
 
-        // Check ELF is an executable file
-        if (elf->e_type != ET_EXEC) {
+        // Check ELF is an executable file (either fixed-address or
+        // position-independent)
+        if (elf->e_type != ET_EXEC && elf->e_type != ET_DYN) {
             return nullptr;
         }
 
@@ -114,44 +291,561 @@ namespace Apps {
             return nullptr;
         }
 
-        *sectionHeaders = reinterpret_cast<const Elf32_Shdr *>(
-            reinterpret_cast<const uint8_t *>(elf) + elf->e_shoff
-        );
+        if (elf->e_shoff == 0 || elf->e_shnum == 0 || elf->e_shstrndx >= elf->e_shnum) {
+            *sectionHeaders = nullptr;
+        } else {
+            *sectionHeaders = reinterpret_cast<const Elf32_Shdr *>(
+                reinterpret_cast<const uint8_t *>(elf) + elf->e_shoff
+            );
+        }
 
         return elf;
     }
 
-	void LoadApp(wchar_t *fileName) {
-		struct AppInfo app;
-		memset(&app, 0, sizeof(app));
-
-		// copy the file name (converting to a non-wide string in the
-		// process)
-		for (int i = 0; i < 100; ++i) {
-			wchar_t c = fileName[i];
-			app.fileName[i] = c;
-			if (c == 0x0000) {
-				break;
+	/**
+	 * Replaces a file with new contents, without the old file being lost if
+	 * the calculator is reset part way through.
+	 *
+	 * The new contents are written to @p tempPath first, then renamed over
+	 * @p path. The old file has to be removed before the rename, so if that's
+	 * as far as it got, @ref RecoverFile finishes the job.
+	 *
+	 * @return True if the file was replaced.
+	 */
+	bool ReplaceFile(const char *path, const char *tempPath, const void *data, int size) {
+		// Not sure if opening with OPEN_CREATE truncates an existing file, so
+		// get rid of anything left over first.
+		remove(tempPath);
+
+		bool written;
+		{
+			File f;
+			if (f.open(tempPath, OPEN_WRITE | OPEN_CREATE) < 0) {
+				return false;
+			}
+
+			written = f.write(data, size) == size;
+		}
+
+		if (!written) {
+			remove(tempPath);
+			return false;
+		}
+
+		remove(path);
+		return rename(tempPath, path) >= 0;
+	}
+
+	/**
+	 * Called when @p path can't be opened. If @ref ReplaceFile was
+	 * interrupted between removing @p path and renaming @p tempPath to it,
+	 * finishes the rename.
+	 *
+	 * @return True if there's now a file at @p path.
+	 */
+	bool RecoverFile(const char *path, const char *tempPath) {
+		struct stat fileStat;
+		if (stat(path, &fileStat) >= 0) {
+			return false;
+		}
+
+		return rename(tempPath, path) >= 0;
+	}
+
+	const char INDEX_PATH[] = "\\fls0\\.hhkindex";
+	// Where a new index is written, before replacing the old one
+	const char INDEX_TEMP_PATH[] = "\\fls0\\.hhkindex.new";
+	const uint32_t INDEX_MAGIC = 0x48484B49; // "HHKI"
+	// Bump this whenever the layout of IndexHeader or IndexRecord changes, so
+	// stale indexes are discarded rather than misread.
+	const uint32_t INDEX_VERSION = 5;
+
+	/**
+	 * Header of the on-flash app index (@ref INDEX_PATH). Followed by
+	 * @c numApps @ref IndexRecord records, and then @c numDirs
+	 * @ref IndexDirRecord records.
+	 */
+	struct IndexHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t numApps;
+		uint32_t numDirs;
+		// The total size of all the strings in the index
+		uint32_t stringsSize;
+	};
+
+	/**
+	 * An app in the app index. Followed by the app's path, name, description,
+	 * author and version (in that order, each null terminated), and then
+	 * padding to a multiple of 4 bytes.
+	 */
+	struct IndexRecord {
+		uint32_t fileSize;
+		uint16_t lastModifiedDate;
+		uint16_t lastModifiedTime;
+		uint16_t lengths[5];
+		uint16_t reserved;
+		uint32_t iconOffset;
+	};
+
+	const int INDEX_NUM_STRINGS = 5;
+
+	/**
+	 * A directory in the app index (see @ref DirInfo). Followed by the
+	 * directory's path (null terminated), and then padding to a multiple of 4
+	 * bytes.
+	 */
+	struct IndexDirRecord {
+		uint32_t firstApp;
+		uint32_t numApps;
+		int32_t parent;
+		uint16_t lastModifiedDate;
+		uint16_t lastModifiedTime;
+		uint16_t pathLength;
+		uint16_t hasStat;
+		uint32_t numEntries;
+		uint32_t entriesSize;
+	};
+
+	uint32_t IndexDirRecordSize(const struct IndexDirRecord *record) {
+		return (sizeof(struct IndexDirRecord) + record->pathLength + 1 + 3) & ~3;
+	}
+
+	/**
+	 * Returns pointers to the fields of an app which are stored in the index,
+	 * in the order they're stored.
+	 */
+	void IndexStrings(struct AppInfo *app, const char **strings[INDEX_NUM_STRINGS]) {
+		strings[0] = &app->path;
+		strings[1] = &app->name;
+		strings[2] = &app->description;
+		strings[3] = &app->author;
+		strings[4] = &app->version;
+	}
+
+	uint32_t IndexRecordSize(const struct IndexRecord *record) {
+		uint32_t size = sizeof(struct IndexRecord);
+		for (int i = 0; i < INDEX_NUM_STRINGS; ++i) {
+			size += record->lengths[i] + 1;
+		}
+
+		return (size + 3) & ~3;
+	}
+
+	/**
+	 * The app index, as read from flash.
+	 */
+	class Index {
+	public:
+		Index() :
+			m_records(nullptr), m_numRecords(0),
+			m_dirRecords(nullptr), m_numDirRecords(0),
+			m_stringsSize(0), m_next(0), m_nextDir(0) {
+
+		}
+
+		~Index() {
+			if (m_records != nullptr) {
+				free(m_records);
+			}
+
+			if (m_dirRecords != nullptr) {
+				free(m_dirRecords);
+			}
+		}
+
+		/**
+		 * Maps the app index into memory, and checks it's valid. If it isn't,
+		 * the index is treated as empty.
+		 */
+		void Load() {
+			Timing::Probe probe(Timing::PhaseIndexLoad);
+
+			if (
+				m_file.open(INDEX_PATH, OPEN_READ) < 0 &&
+				(!RecoverFile(INDEX_PATH, INDEX_TEMP_PATH) || m_file.open(INDEX_PATH, OPEN_READ) < 0)
+			) {
+				return;
+			}
+
+			struct stat indexStat;
+			if (m_file.fstat(&indexStat) < 0 || indexStat.fileSize < sizeof(IndexHeader)) {
+				return;
+			}
+
+			const uint8_t *data;
+			if (m_file.getAddr(0, (const void **) &data) < 0) {
+				return;
+			}
+
+			const struct IndexHeader *header = reinterpret_cast<const struct IndexHeader *>(data);
+			if (header->magic != INDEX_MAGIC || header->version != INDEX_VERSION) {
+				return;
+			}
+
+			// Don't trust a truncated index
+			if (header->numApps > (indexStat.fileSize - sizeof(IndexHeader)) / sizeof(IndexRecord)) {
+				return;
+			}
+
+			if (header->numDirs > (indexStat.fileSize - sizeof(IndexHeader)) / sizeof(IndexDirRecord)) {
+				return;
+			}
+
+			const struct IndexRecord **records = static_cast<const struct IndexRecord **>(
+				malloc((header->numApps + 1) * sizeof(struct IndexRecord *))
+			);
+
+			uint32_t offset = sizeof(IndexHeader);
+			for (uint32_t i = 0; i < header->numApps; ++i) {
+				if (indexStat.fileSize - offset < sizeof(IndexRecord)) {
+					free(records);
+					return;
+				}
+
+				const struct IndexRecord *record = reinterpret_cast<const struct IndexRecord *>(data + offset);
+				uint32_t recordSize = IndexRecordSize(record);
+				if (indexStat.fileSize - offset < recordSize) {
+					free(records);
+					return;
+				}
+
+				// Check the strings are null terminated where we expect
+				const char *str = reinterpret_cast<const char *>(record + 1);
+				for (int j = 0; j < INDEX_NUM_STRINGS; ++j) {
+					str += record->lengths[j];
+					if (*str++ != '\0') {
+						free(records);
+						return;
+					}
+				}
+
+				records[i] = record;
+				offset += recordSize;
+			}
+
+			const struct IndexDirRecord **dirRecords = static_cast<const struct IndexDirRecord **>(
+				malloc((header->numDirs + 1) * sizeof(struct IndexDirRecord *))
+			);
+
+			for (uint32_t i = 0; i < header->numDirs; ++i) {
+				const struct IndexDirRecord *record = reinterpret_cast<const struct IndexDirRecord *>(data + offset);
+				if (
+					indexStat.fileSize - offset < sizeof(IndexDirRecord) ||
+					indexStat.fileSize - offset < IndexDirRecordSize(record) ||
+					reinterpret_cast<const char *>(record + 1)[record->pathLength] != '\0' ||
+					// Parents must come first, and apps must be in range
+					record->parent < -1 ||
+					record->parent >= static_cast<int32_t>(i) ||
+					record->firstApp > header->numApps ||
+					record->numApps > header->numApps - record->firstApp
+				) {
+					free(dirRecords);
+					free(records);
+					return;
+				}
+
+				dirRecords[i] = record;
+				offset += IndexDirRecordSize(record);
+			}
+
+			m_records = records;
+			m_numRecords = header->numApps;
+			m_dirRecords = dirRecords;
+			m_numDirRecords = header->numDirs;
+			m_stringsSize = header->stringsSize;
+		}
+
+		/**
+		 * Finds the record for an app, if its file hasn't changed since the
+		 * index was written.
+		 *
+		 * Apps are usually found in the same order as they were when the index
+		 * was written, so the search starts just after the last match.
+		 *
+		 * @return The index of the record, or -1 if there isn't an up to date
+		 * one.
+		 */
+		int Find(const char *path, const struct stat *fileStat) {
+			int i = m_next;
+			for (int n = 0; n < m_numRecords; ++n, ++i) {
+				// The launcher isn't linked against libgcc, so there's no
+				// runtime division - wrap around by hand.
+				if (i >= m_numRecords) {
+					i = 0;
+				}
+
+				const struct IndexRecord *record = m_records[i];
+
+				if (
+					record->fileSize == fileStat->fileSize &&
+					record->lastModifiedDate == fileStat->lastModifiedDate &&
+					record->lastModifiedTime == fileStat->lastModifiedTime &&
+					strcmp(reinterpret_cast<const char *>(record + 1), path) == 0
+				) {
+					m_next = i + 1;
+					return i;
+				}
+			}
+
+			return -1;
+		}
+
+		/**
+		 * Copies an app's record into @p app, interning its strings into
+		 * @ref g_appStrings.
+		 */
+		void Read(int i, struct AppInfo *app) {
+			const struct IndexRecord *record = m_records[i];
+
+			const char **strings[INDEX_NUM_STRINGS];
+			IndexStrings(app, strings);
+
+			const char *str = reinterpret_cast<const char *>(record + 1);
+			for (int j = 0; j < INDEX_NUM_STRINGS; ++j) {
+				*strings[j] = g_appStrings.Intern(str, record->lengths[j]);
+				str += record->lengths[j] + 1;
+			}
+
+			SetFileName(app);
+			app->fileSize = record->fileSize;
+			app->lastModifiedDate = record->lastModifiedDate;
+			app->lastModifiedTime = record->lastModifiedTime;
+			app->iconOffset = record->iconOffset;
+		}
+
+		/**
+		 * Returns the path of the app an app record is for, which is the
+		 * first of its strings.
+		 */
+		const char *Path(int i) {
+			return reinterpret_cast<const char *>(m_records[i] + 1);
+		}
+
+		int PathLength(int i) {
+			return m_records[i]->lengths[0];
+		}
+
+		int NumRecords() {
+			return m_numRecords;
+		}
+
+		/**
+		 * Finds the record for a directory. Like @ref Find, the search starts
+		 * just after the last match.
+		 *
+		 * @return The index of the directory's record, or -1 if it isn't in
+		 * the index.
+		 */
+		int FindDir(const char *path) {
+			int i = m_nextDir;
+			for (int n = 0; n < m_numDirRecords; ++n, ++i) {
+				if (i >= m_numDirRecords) {
+					i = 0;
+				}
+
+				if (strcmp(DirPath(i), path) == 0) {
+					m_nextDir = i + 1;
+					return i;
+				}
+			}
+
+			return -1;
+		}
+
+		const struct IndexDirRecord *DirRecord(int i) {
+			return m_dirRecords[i];
+		}
+
+		const char *DirPath(int i) {
+			return reinterpret_cast<const char *>(m_dirRecords[i] + 1);
+		}
+
+		int NumDirRecords() {
+			return m_numDirRecords;
+		}
+
+		uint32_t StringsSize() {
+			return m_stringsSize;
+		}
+
+	private:
+		File m_file;
+		const struct IndexRecord **m_records;
+		int m_numRecords;
+		const struct IndexDirRecord **m_dirRecords;
+		int m_numDirRecords;
+		uint32_t m_stringsSize;
+		int m_next;
+		int m_nextDir;
+	};
+
+	/**
+	 * Writes the current app table to the app index.
+	 */
+	void SaveIndex() {
+		Timing::Probe probe(Timing::PhaseIndexSave);
+
+		uint32_t stringsSize = 0;
+		uint32_t indexSize = sizeof(struct IndexHeader);
+
+		for (int i = 0; i < g_numApps; ++i) {
+			const char **strings[INDEX_NUM_STRINGS];
+			IndexStrings(&g_apps[i], strings);
+
+			struct IndexRecord record;
+			for (int j = 0; j < INDEX_NUM_STRINGS; ++j) {
+				record.lengths[j] = strlen(*strings[j]);
+				stringsSize += record.lengths[j] + 1;
+			}
+
+			indexSize += IndexRecordSize(&record);
+		}
+
+		for (int i = 0; i < g_numDirs; ++i) {
+			struct IndexDirRecord record;
+			record.pathLength = strlen(g_dirs[i].path);
+			stringsSize += record.pathLength + 1;
+
+			indexSize += IndexDirRecordSize(&record);
+		}
+
+		// Build the whole index in memory, so it can be written in one go
+		uint8_t *data = static_cast<uint8_t *>(malloc(indexSize));
+		memset(data, 0, indexSize);
+
+		struct IndexHeader *header = reinterpret_cast<struct IndexHeader *>(data);
+		header->magic = INDEX_MAGIC;
+		header->version = INDEX_VERSION;
+		header->numApps = g_numApps;
+		header->numDirs = g_numDirs;
+		header->stringsSize = stringsSize;
+
+		uint32_t offset = sizeof(struct IndexHeader);
+		for (int i = 0; i < g_numApps; ++i) {
+			struct AppInfo *app = &g_apps[i];
+			struct IndexRecord *record = reinterpret_cast<struct IndexRecord *>(data + offset);
+
+			record->fileSize = app->fileSize;
+			record->lastModifiedDate = app->lastModifiedDate;
+			record->lastModifiedTime = app->lastModifiedTime;
+			record->iconOffset = app->iconOffset;
+
+			const char **strings[INDEX_NUM_STRINGS];
+			IndexStrings(app, strings);
+
+			char *str = reinterpret_cast<char *>(record + 1);
+			for (int j = 0; j < INDEX_NUM_STRINGS; ++j) {
+				record->lengths[j] = strlen(*strings[j]);
+				memcpy(str, *strings[j], record->lengths[j] + 1);
+				str += record->lengths[j] + 1;
 			}
+
+			offset += IndexRecordSize(record);
+		}
+
+		for (int i = 0; i < g_numDirs; ++i) {
+			struct DirInfo *dir = &g_dirs[i];
+			struct IndexDirRecord *record = reinterpret_cast<struct IndexDirRecord *>(data + offset);
+
+			record->firstApp = dir->firstApp;
+			record->numApps = dir->numApps;
+			record->parent = dir->parent;
+			record->lastModifiedDate = dir->lastModifiedDate;
+			record->lastModifiedTime = dir->lastModifiedTime;
+			record->pathLength = strlen(dir->path);
+			record->hasStat = dir->hasStat;
+			record->numEntries = dir->numEntries;
+			record->entriesSize = dir->entriesSize;
+			memcpy(record + 1, dir->path, record->pathLength + 1);
+
+			offset += IndexDirRecordSize(record);
+		}
+
+		ReplaceFile(INDEX_PATH, INDEX_TEMP_PATH, data, indexSize);
+
+		free(data);
+	}
+
+	/**
+	 * Reads a string out of a @c .hollyhock_meta section into
+	 * @ref g_appStrings.
+	 */
+	const char *InternMetaField(
+		const struct HollyhockMetaHeader *meta, uint32_t metaSize,
+		HollyhockMetaField field
+	) {
+		uint32_t offset = meta->fields[field].offset;
+		uint32_t length = meta->fields[field].length;
+
+		if (offset > metaSize || length > metaSize - offset) {
+			return "";
+		}
+
+		return g_appStrings.Intern(reinterpret_cast<const char *>(meta) + offset, length);
+	}
+
+	/**
+	 * Checks whether a section is a @c .hollyhock_meta section, purely from its
+	 * type, flags and contents - no need to look up its name.
+	 */
+	const struct HollyhockMetaHeader *GetMeta(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeader) {
+		if (
+			sectionHeader->sh_type != SHT_PROGBITS ||
+			(sectionHeader->sh_flags & SHF_ALLOC) == SHF_ALLOC ||
+			sectionHeader->sh_size < sizeof(struct HollyhockMetaHeader) ||
+			(sectionHeader->sh_offset & 3) != 0
+		) {
+			return nullptr;
+		}
+
+		const struct HollyhockMetaHeader *meta = reinterpret_cast<const struct HollyhockMetaHeader *>(
+			reinterpret_cast<const uint8_t *>(elf) + sectionHeader->sh_offset
+		);
+
+		if (meta->magic != HOLLYHOCK_META_MAGIC || meta->version != HOLLYHOCK_META_VERSION) {
+			return nullptr;
 		}
 
-		// build the path
-		strcat(app.path, "\\fls0\\");
-		strcat(app.path, app.fileName);
+		return meta;
+	}
 
+	/**
+	 * Parses the metadata of an app from its ELF file.
+	 *
+	 * Apps built with @c APP_INFO have all their metadata in one
+	 * @c .hollyhock_meta section. Older apps have a section per field
+	 * (@c .hollyhock_name, etc.), which are still supported.
+	 *
+	 * @param[in,out] app The app to fill the metadata of. The path must already
+	 * be set, the other strings set to empty strings, and the icon offset set
+	 * to 0.
+	 * @return True if the file is a valid app, false otherwise.
+	 */
+	bool ParseApp(struct AppInfo *app) {
 		File f;
-		int ret = f.open(app.path, OPEN_READ);
+		int ret = f.open(app->path, OPEN_READ);
 		if (ret < 0) {
-			return;
+			return false;
 		}
 
 		const Elf32_Shdr *sectionHeaders;
 		const Elf32_Ehdr *elf = LoadELF(f, &sectionHeaders);
 
 		if (elf == nullptr) {
-			return;
+			return false;
+		}
+
+		// A stripped app is still runnable, it just has no metadata
+		if (sectionHeaders == nullptr) {
+			return true;
 		}
 
+		Timing::Probe probe(Timing::PhaseParseMeta);
+
+		// Keep looking after finding the metadata, as there may be an icon
+		bool hasMeta = false;
+
 		const Elf32_Shdr *sectionHeaderStringTable = &sectionHeaders[elf->e_shstrndx];
 		for (int i = 0; i < elf->e_shnum; ++i) {
 			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
@@ -161,89 +855,1916 @@ namespace Apps {
 				continue;
 			}
 
+			const struct HollyhockMetaHeader *meta = GetMeta(elf, sectionHeader);
+			if (meta != nullptr) {
+				// Don't try to run apps which need a newer launcher
+				if (meta->minSDKVersion > HOLLYHOCK_SDK_VERSION) {
+					return false;
+				}
+
+				uint32_t metaSize = sectionHeader->sh_size;
+				app->name = InternMetaField(meta, metaSize, HollyhockMetaName);
+				app->description = InternMetaField(meta, metaSize, HollyhockMetaDescription);
+				app->author = InternMetaField(meta, metaSize, HollyhockMetaAuthor);
+				app->version = InternMetaField(meta, metaSize, HollyhockMetaVersion);
+
+				hasMeta = true;
+				continue;
+			}
+
 			const char *sectionName = reinterpret_cast<const char *>(
 				reinterpret_cast<const uint8_t *>(elf) +
 				sectionHeaderStringTable->sh_offset +
 				sectionHeader->sh_name
 			);
 
+			// Only the location is recorded - the icon itself is read when
+			// it's drawn (see DrawIcon)
+			if (strcmp(sectionName, ".hollyhock_icon") == 0) {
+				if (
+					sectionHeader->sh_type == SHT_PROGBITS &&
+					sectionHeader->sh_size >= sizeof(struct HollyhockIconHeader) &&
+					(sectionHeader->sh_offset & 3) == 0
+				) {
+					app->iconOffset = sectionHeader->sh_offset;
+				}
+
+				continue;
+			}
+
+			// The old per-field sections are only used if there's no
+			// .hollyhock_meta
+			if (hasMeta) {
+				continue;
+			}
+
 			const char *sectionData = reinterpret_cast<const char *>(
 				reinterpret_cast<const uint8_t *>(elf) +
 				sectionHeader->sh_offset
 			);
 
+			const char **field;
 			if (strcmp(sectionName, ".hollyhock_name") == 0) {
-				strcat(app.name, sectionData);
+				field = &app->name;
 			} else if (strcmp(sectionName, ".hollyhock_description") == 0) {
-				strcat(app.description, sectionData);
+				field = &app->description;
 			} else if (strcmp(sectionName, ".hollyhock_author") == 0) {
-				strcat(app.author, sectionData);
+				field = &app->author;
 			} else if (strcmp(sectionName, ".hollyhock_version") == 0) {
-				strcat(app.version, sectionData);
+				field = &app->version;
+			} else {
+				continue;
 			}
+
+			*field = g_appStrings.Intern(
+				sectionData,
+				BoundedStrlen(sectionData, sectionHeader->sh_size)
+			);
 		}
 
-		g_apps[g_numApps++] = app;
+		return true;
 	}
 
-    void LoadAppInfo() {
-		g_numApps = 0;
-
-        Find find;
+	/**
+	 * Adds an app to the app table, reusing its record from the app index if
+	 * the file hasn't changed since the index was written.
+	 *
+	 * @param path The path to the app's file.
+	 * @param pathLength The length of @p path.
+	 * @param index The app index.
+	 * @return True if the app wasn't in the index (or was out of date) and
+	 * had to be parsed, false otherwise.
+	 */
+	bool LoadApp(const char *path, int pathLength, Index &index) {
+		struct stat fileStat;
+		int ret;
+		{
+			Timing::Probe probe(Timing::PhaseStat);
+			ret = stat(path, &fileStat);
+		}
+		if (ret < 0) {
+			return false;
+		}
 
-        wchar_t fileName[100];
-        struct findInfo findInfoBuf;
+		struct AppInfo app;
 
-        int ret = find.findFirst(L"\\fls0\\*.hhk", fileName, &findInfoBuf);
-        while (ret >= 0) {
-            if (findInfoBuf.type == findInfoBuf.EntryTypeFile) {
-				LoadApp(fileName);
-			}
+		int cached = index.Find(path, &fileStat);
+		if (cached >= 0) {
+			index.Read(cached, &app);
+			AddApp(&app);
+			return false;
+		}
 
-            ret = find.findNext(fileName, &findInfoBuf);
-        }
-    }
+		app.path = g_appStrings.Intern(path, pathLength);
+		SetFileName(&app);
+		app.name = "";
+		app.description = "";
+		app.author = "";
+		app.version = "";
+		app.fileSize = fileStat.fileSize;
+		app.lastModifiedDate = fileStat.lastModifiedDate;
+		app.lastModifiedTime = fileStat.lastModifiedTime;
+		app.iconOffset = 0;
 
-    EntryPoint RunApp(int i) {
-        struct AppInfo *app = &g_apps[i];
+		// Files which aren't valid apps aren't indexed, so they don't count
+		// as a change.
+		if (!ParseApp(&app)) {
+			return false;
+		}
 
-        File f;
-        int ret = f.open(app->path, OPEN_READ);
-        if (ret < 0) {
-            return nullptr;
-        }
+		AddApp(&app);
+		return true;
+	}
 
-        const Elf32_Shdr *sectionHeaders;
-        const Elf32_Ehdr *elf = LoadELF(f, &sectionHeaders);
+	const char ROOT_DIR[] = "\\fls0";
+	const int MAX_PATH_LENGTH = 200;
+	// Bounds how far the search for apps goes into sub-directories
+	const int MAX_DIR_DEPTH = 8;
 
-		if (elf == nullptr) {
-			return nullptr;
+	/**
+	 * Appends a file name (converting it to a non-wide string in the process)
+	 * and a null terminator to a directory's path.
+	 *
+	 * @param path The directory's path. Must have room for
+	 * @ref MAX_PATH_LENGTH characters.
+	 * @param dirLength The length of the directory's path.
+	 * @return The length of the new path, or -1 if it wouldn't fit.
+	 */
+	int AppendFileName(char *path, int dirLength, const wchar_t *fileName) {
+		// The separator needs room too, as well as the terminator
+		if (dirLength + 1 >= MAX_PATH_LENGTH) {
+			return -1;
 		}
 
-		for (int i = 0; i < elf->e_shnum; ++i) {
-			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+		int pathLength = dirLength;
+		path[pathLength++] = '\\';
 
-			// skip the first empty section header
-			if (sectionHeader->sh_type == SHT_NULL) {
-				continue;
+		for (int i = 0; fileName[i] != 0x0000; ++i) {
+			if (pathLength >= MAX_PATH_LENGTH - 1) {
+				return -1;
 			}
 
-			const void *sectionData = reinterpret_cast<const void *>(
-				reinterpret_cast<const uint8_t *>(elf) +
-				sectionHeader->sh_offset
-			);
+			path[pathLength++] = fileName[i];
+		}
+		path[pathLength] = '\0';
 
-			if ((sectionHeader->sh_flags & SHF_ALLOC) == SHF_ALLOC) {
-				void *dest = reinterpret_cast<void *>(sectionHeader->sh_addr);
+		return pathLength;
+	}
 
-				if (sectionHeader->sh_type == SHT_PROGBITS) {
-					memcpy(dest, sectionData, sectionHeader->sh_size);
-				} else if (sectionHeader->sh_type == SHT_NOBITS) {
-					memset(dest, 0, sectionHeader->sh_size);
-				}
-			}
+	bool IsAppFileName(const wchar_t *fileName) {
+		const char extension[] = ".hhk";
+		const int extensionLength = sizeof(extension) - 1;
+
+		int length = 0;
+		while (fileName[length] != 0x0000) {
+			++length;
 		}
 
-		return reinterpret_cast<EntryPoint>(elf->e_entry);
-    }
+		if (length <= extensionLength) {
+			return false;
+		}
+
+		// FAT names aren't case sensitive
+		for (int i = 0; i < extensionLength; ++i) {
+			wchar_t c = fileName[length - extensionLength + i];
+			if (c >= 'A' && c <= 'Z') {
+				c += 'a' - 'A';
+			}
+
+			if (c != extension[i]) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * Builds the pattern which lists everything in a directory.
+	 *
+	 * @param pattern Must have room for @ref MAX_PATH_LENGTH + 2 characters.
+	 */
+	void MakeFindPattern(const char *path, int dirLength, wchar_t *pattern) {
+		for (int i = 0; i < dirLength; ++i) {
+			pattern[i] = path[i];
+		}
+		pattern[dirLength] = '\\';
+		pattern[dirLength + 1] = '*';
+		pattern[dirLength + 2] = 0x0000;
+	}
+
+	bool IsDotEntry(const wchar_t *fileName) {
+		return fileName[0] == '.' && (
+			fileName[1] == 0x0000 || (fileName[1] == '.' && fileName[2] == 0x0000)
+		);
+	}
+
+	/**
+	 * Lists a directory, loading the apps in it and queueing its
+	 * sub-directories to be searched.
+	 *
+	 * @return True if any app had to be parsed.
+	 */
+	bool SearchDir(int dirIndex, Index &index) {
+		char path[MAX_PATH_LENGTH];
+		strcpy(path, g_dirs[dirIndex].path);
+		int dirLength = strlen(path);
+
+		wchar_t pattern[MAX_PATH_LENGTH + 2];
+		MakeFindPattern(path, dirLength, pattern);
+
+		bool changed = false;
+		uint32_t numEntries = 0;
+		uint32_t entriesSize = 0;
+
+		Find find;
+
+		wchar_t fileName[100];
+		struct findInfo findInfoBuf;
+
+		int ret = find.findFirst(pattern, fileName, &findInfoBuf);
+		while (ret >= 0) {
+			if (!IsDotEntry(fileName)) {
+				++numEntries;
+				entriesSize += findInfoBuf.size;
+			}
+
+			int pathLength = AppendFileName(path, dirLength, fileName);
+
+			if (pathLength < 0) {
+				// too long to open - skip it
+			} else if (findInfoBuf.type == findInfoBuf.EntryTypeFile) {
+				if (IsAppFileName(fileName) && LoadApp(path, pathLength, index)) {
+					changed = true;
+				}
+			} else if (findInfoBuf.type == findInfoBuf.EntryTypeDirectory) {
+				// Skips . and .., along with hidden directories
+				if (fileName[0] != '.' && g_dirs[dirIndex].depth < MAX_DIR_DEPTH) {
+					AddDir(g_appStrings.Intern(path, pathLength), dirIndex);
+				}
+			}
+
+			ret = find.findNext(fileName, &findInfoBuf);
+		}
+
+		// The root is always searched, so its listing is never compared -
+		// and it changes every time the index (which is in it) is saved.
+		// AddDir may have moved g_dirs.
+		if (dirIndex != 0) {
+			g_dirs[dirIndex].numEntries = numEntries;
+			g_dirs[dirIndex].entriesSize = entriesSize;
+		}
+
+		return changed;
+	}
+
+	/**
+	 * Counts the entries in a directory, and adds up the sizes of its files,
+	 * without looking at any of them more closely. Much quicker than
+	 * @ref SearchDir, which has to stat every app.
+	 */
+	void CountEntries(const char *path, uint32_t *numEntries, uint32_t *entriesSize) {
+		wchar_t pattern[MAX_PATH_LENGTH + 2];
+		MakeFindPattern(path, strlen(path), pattern);
+
+		*numEntries = 0;
+		*entriesSize = 0;
+
+		Find find;
+
+		wchar_t fileName[100];
+		struct findInfo findInfoBuf;
+
+		int ret = find.findFirst(pattern, fileName, &findInfoBuf);
+		while (ret >= 0) {
+			if (!IsDotEntry(fileName)) {
+				++*numEntries;
+				*entriesSize += findInfoBuf.size;
+			}
+
+			ret = find.findNext(fileName, &findInfoBuf);
+		}
+	}
+
+	/**
+	 * Adds the apps and sub-directories of a directory which hasn't changed
+	 * since the index was written, without searching it.
+	 *
+	 * Overwriting a file in place doesn't change its directory's timestamp,
+	 * so each app's file is still checked against its record (by
+	 * @ref LoadApp), and parsed again if it's changed.
+	 *
+	 * @return True if any app had to be parsed.
+	 */
+	bool ReadDirFromIndex(int dirIndex, int record, Index &index) {
+		const struct IndexDirRecord *dirRecord = index.DirRecord(record);
+		bool changed = false;
+
+		for (uint32_t i = 0; i < dirRecord->numApps; ++i) {
+			int app = dirRecord->firstApp + i;
+			if (LoadApp(index.Path(app), index.PathLength(app), index)) {
+				changed = true;
+			}
+		}
+
+		// Sub-directories always come after their parent
+		for (int i = record + 1; i < index.NumDirRecords(); ++i) {
+			const struct IndexDirRecord *subDirRecord = index.DirRecord(i);
+			if (subDirRecord->parent == record) {
+				AddDir(
+					g_appStrings.Intern(index.DirPath(i), subDirRecord->pathLength),
+					dirIndex
+				);
+			}
+		}
+
+		return changed;
+	}
+
+	/**
+	 * Loads the apps in one of the directories in @ref g_dirs.
+	 *
+	 * The root directory is always searched. Other directories are only
+	 * searched if their timestamp, number of entries or total file size has
+	 * changed since the index was written - otherwise, the apps and
+	 * sub-directories they had are taken from the index, and only the apps'
+	 * files are checked.
+	 *
+	 * @return True if the index needs to be rewritten.
+	 */
+	bool LoadDir(int dirIndex, Index &index) {
+		struct DirInfo *dir = &g_dirs[dirIndex];
+		dir->firstApp = g_numApps;
+
+		if (dirIndex != 0) {
+			struct stat dirStat;
+			Timing::Probe probe(Timing::PhaseStat);
+			if (stat(dir->path, &dirStat) >= 0) {
+				dir->hasStat = true;
+				dir->lastModifiedDate = dirStat.lastModifiedDate;
+				dir->lastModifiedTime = dirStat.lastModifiedTime;
+			}
+		}
+
+		int record = index.FindDir(dir->path);
+		bool unchanged = record >= 0 && dir->hasStat && (
+			index.DirRecord(record)->hasStat &&
+			index.DirRecord(record)->lastModifiedDate == dir->lastModifiedDate &&
+			index.DirRecord(record)->lastModifiedTime == dir->lastModifiedTime
+		);
+
+		if (unchanged) {
+			CountEntries(dir->path, &dir->numEntries, &dir->entriesSize);
+			unchanged = index.DirRecord(record)->numEntries == dir->numEntries &&
+				index.DirRecord(record)->entriesSize == dir->entriesSize;
+		}
+
+		bool changed;
+		if (unchanged) {
+			changed = ReadDirFromIndex(dirIndex, record, index);
+		} else {
+			changed = SearchDir(dirIndex, index);
+
+			// A new directory, or a new timestamp or listing, has to be
+			// saved even if none of the apps changed.
+			if (record < 0 || g_dirs[dirIndex].hasStat) {
+				changed = true;
+			}
+		}
+
+		// AddDir may have moved g_dirs
+		dir = &g_dirs[dirIndex];
+		dir->numApps = g_numApps - dir->firstApp;
+
+		return changed;
+	}
+
+	const char *DisplayName(const struct AppInfo *app) {
+		return app->name[0] != '\0' ? app->name : app->path;
+	}
+
+	char ToLower(char c) {
+		return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+	}
+
+	/**
+	 * Compares two strings like strcmp, but ignoring the case of ASCII
+	 * letters.
+	 */
+	int CompareNames(const char *a, const char *b) {
+		while (*a != '\0' && ToLower(*a) == ToLower(*b)) {
+			++a;
+			++b;
+		}
+
+		return static_cast<uint8_t>(ToLower(*a)) - static_cast<uint8_t>(ToLower(*b));
+	}
+
+	/**
+	 * Fills @ref g_appOrder with the apps sorted by name.
+	 *
+	 * A binary insertion sort: it's stable (apps with the same name stay in
+	 * the order they were found), needs no memory beyond g_appOrder itself,
+	 * and only makes O(n log n) comparisons - the element moves are quadratic,
+	 * but each is just an int being copied.
+	 */
+	void SortApps() {
+		Timing::Probe probe(Timing::PhaseSort);
+
+		g_appOrder = static_cast<int *>(malloc((g_numApps + 1) * sizeof(int)));
+
+		for (int i = 0; i < g_numApps; ++i) {
+			const char *name = DisplayName(&g_apps[i]);
+
+			// Find the first sorted app which comes after this one
+			int low = 0;
+			int high = i;
+			while (low < high) {
+				int middle = (low + high) >> 1;
+				if (CompareNames(DisplayName(&g_apps[g_appOrder[middle]]), name) <= 0) {
+					low = middle + 1;
+				} else {
+					high = middle;
+				}
+			}
+
+			for (int j = i; j > low; --j) {
+				g_appOrder[j] = g_appOrder[j - 1];
+			}
+			g_appOrder[low] = i;
+		}
+	}
+
+    void LoadAppInfo() {
+		Timing::Probe probe(Timing::PhaseLoadAppInfo);
+
+		// The launcher is loaded as a flat binary, so .bss isn't zeroed -
+		// everything has to be set up explicitly. This is only called once
+		// per run, so there's never a previous table to free.
+		g_apps = nullptr;
+		g_numApps = 0;
+		g_appsCapacity = 0;
+		g_dirs = nullptr;
+		g_numDirs = 0;
+		g_dirsCapacity = 0;
+		g_appStrings.Init();
+
+		bool changed = false;
+
+		{
+			Index index;
+			index.Load();
+
+			// Size everything from the last scan - if nothing's changed, there
+			// won't be any further allocations.
+			ReserveApps(index.NumRecords());
+			ReserveDirs(index.NumDirRecords());
+			g_appStrings.Reserve(index.StringsSize());
+
+			// g_dirs doubles as the queue of directories still to search, so
+			// the walk doesn't need recursion or more than one open find
+			// handle.
+			AddDir(ROOT_DIR, -1);
+			for (int i = 0; i < g_numDirs; ++i) {
+				if (LoadDir(i, index)) {
+					changed = true;
+				}
+			}
+
+			// catches apps and directories which were deleted since the index
+			// was written
+			if (g_numApps != index.NumRecords() || g_numDirs != index.NumDirRecords()) {
+				changed = true;
+			}
+		}
+
+		// The index must be closed (above) before it can be rewritten
+		if (changed) {
+			SaveIndex();
+		}
+
+		SortApps();
+    }
+
+	/**
+	 * Set in the p_flags of a PT_LOAD segment which has been compressed by
+	 * tools/hhk_compress.py. The segment's data is a 32-bit uncompressed size,
+	 * followed by an LZ4 block.
+	 */
+	const uint32_t PF_HHK_LZ4 = 0x00100000;
+
+	/**
+	 * Checks whether a segment is an overlay (see sdk/overlay.hpp). Overlays
+	 * share a run address, so they're linked with load addresses which differ
+	 * from their run addresses.
+	 */
+	bool IsOverlay(const Elf32_Phdr *programHeader) {
+		return programHeader->p_paddr != programHeader->p_vaddr;
+	}
+
+	/**
+	 * Loads a single PT_LOAD segment, decompressing it if required.
+	 */
+	bool LoadSegment(const Elf32_Ehdr *elf, const Elf32_Phdr *programHeader, uint32_t bias) {
+		uint8_t *dest = reinterpret_cast<uint8_t *>(programHeader->p_vaddr + bias);
+		const uint8_t *segmentData =
+			reinterpret_cast<const uint8_t *>(elf) + programHeader->p_offset;
+
+		uint32_t dataSize = programHeader->p_filesz;
+
+		if ((programHeader->p_flags & PF_HHK_LZ4) == PF_HHK_LZ4) {
+			if (programHeader->p_filesz < sizeof(uint32_t)) {
+				return false;
+			}
+
+			dataSize = *reinterpret_cast<const uint32_t *>(segmentData);
+			if (dataSize > programHeader->p_memsz) {
+				return false;
+			}
+
+			int ret = LZ4::Decompress(
+				segmentData + sizeof(uint32_t),
+				programHeader->p_filesz - sizeof(uint32_t),
+				dest, dataSize
+			);
+			if (ret < 0 || static_cast<uint32_t>(ret) != dataSize) {
+				return false;
+			}
+		} else if (dataSize > 0) {
+			memcpy(dest, segmentData, dataSize);
+		}
+
+		if (programHeader->p_memsz > dataSize) {
+			memset(dest + dataSize, 0, programHeader->p_memsz - dataSize);
+		}
+
+		return true;
+	}
+
+	/**
+	 * Loads an app using its program headers. Each PT_LOAD segment is copied
+	 * (or decompressed) in one go, and the remainder of the segment (i.e.
+	 * .bss) zeroed.
+	 *
+	 * @param elf The app to load.
+	 * @param bias The difference between the address each segment is loaded
+	 * to and its p_vaddr. Always 0 for fixed-address apps.
+	 * @return False if a compressed segment is corrupt, true otherwise.
+	 */
+	bool LoadSegments(const Elf32_Ehdr *elf, uint32_t bias) {
+		Timing::Probe probe(Timing::PhaseLoadSegments);
+
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			reinterpret_cast<const uint8_t *>(elf) + elf->e_phoff
+		);
+
+		for (int i = 0; i < elf->e_phnum; ++i) {
+			const Elf32_Phdr *programHeader = &programHeaders[i];
+
+			if (programHeader->p_type != PT_LOAD) {
+				continue;
+			}
+
+			// Overlays are left on flash until the app asks for them
+			if (IsOverlay(programHeader)) {
+				continue;
+			}
+
+			if (!LoadSegment(elf, programHeader, bias)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * Loads an app section by section. Only used for files without program
+	 * headers, as it results in many more (and smaller) copies than
+	 * @ref LoadSegments.
+	 */
+	void LoadSections(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders) {
+		for (int i = 0; i < elf->e_shnum; ++i) {
+			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+
+			// skip the first empty section header
+			if (sectionHeader->sh_type == SHT_NULL) {
+				continue;
+			}
+
+			const void *sectionData = reinterpret_cast<const void *>(
+				reinterpret_cast<const uint8_t *>(elf) +
+				sectionHeader->sh_offset
+			);
+
+			if ((sectionHeader->sh_flags & SHF_ALLOC) == SHF_ALLOC) {
+				void *dest = reinterpret_cast<void *>(sectionHeader->sh_addr);
+
+				if (sectionHeader->sh_type == SHT_PROGBITS) {
+					memcpy(dest, sectionData, sectionHeader->sh_size);
+				} else if (sectionHeader->sh_type == SHT_NOBITS) {
+					memset(dest, 0, sectionHeader->sh_size);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Finds the lowest address of any PT_LOAD segment in a position-independent
+	 * app, i.e. the address it was linked to run at.
+	 */
+	uint32_t LinkAddress(const Elf32_Ehdr *elf) {
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			reinterpret_cast<const uint8_t *>(elf) + elf->e_phoff
+		);
+
+		uint32_t address = 0xFFFFFFFF;
+		for (int i = 0; i < elf->e_phnum; ++i) {
+			if (programHeaders[i].p_type == PT_LOAD && programHeaders[i].p_vaddr < address) {
+				address = programHeaders[i].p_vaddr;
+			}
+		}
+
+		return address;
+	}
+
+	/**
+	 * Checks whether a range of addresses (as the app was linked) lies
+	 * entirely within one of the app's PT_LOAD segments.
+	 */
+	bool InSegment(const Elf32_Ehdr *elf, uint32_t address, uint32_t size) {
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			reinterpret_cast<const uint8_t *>(elf) + elf->e_phoff
+		);
+
+		for (int i = 0; i < elf->e_phnum; ++i) {
+			const Elf32_Phdr *programHeader = &programHeaders[i];
+			if (
+				programHeader->p_type == PT_LOAD &&
+				address >= programHeader->p_vaddr &&
+				address - programHeader->p_vaddr <= programHeader->p_memsz &&
+				size <= programHeader->p_memsz - (address - programHeader->p_vaddr)
+			) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * Applies the dynamic relocations of a position-independent app, once its
+	 * segments have been loaded. Everything is read from the loaded image, so
+	 * this works for compressed apps too.
+	 *
+	 * Apps are linked into a single image, so the only symbols a relocation
+	 * can refer to are the app's own.
+	 *
+	 * @param elf The app which was loaded.
+	 * @param bias The difference between the load address and link address.
+	 * @return False if the app uses an unsupported relocation, or one which
+	 * would read or write outside the app's segments, true otherwise.
+	 */
+	bool Relocate(const Elf32_Ehdr *elf, uint32_t bias) {
+		Timing::Probe probe(Timing::PhaseRelocate);
+
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			reinterpret_cast<const uint8_t *>(elf) + elf->e_phoff
+		);
+
+		const Elf32_Phdr *dynamicHeader = nullptr;
+		for (int i = 0; i < elf->e_phnum; ++i) {
+			if (programHeaders[i].p_type == PT_DYNAMIC) {
+				dynamicHeader = &programHeaders[i];
+				break;
+			}
+		}
+
+		// Nothing to relocate
+		if (dynamicHeader == nullptr) {
+			return true;
+		}
+
+		// The dynamic section is read from the loaded image, so it has to be
+		// part of it
+		if (
+			(dynamicHeader->p_vaddr & 3) != 0 ||
+			!InSegment(elf, dynamicHeader->p_vaddr, dynamicHeader->p_memsz)
+		) {
+			return false;
+		}
+
+		const Elf32_Dyn *dynamic = reinterpret_cast<const Elf32_Dyn *>(dynamicHeader->p_vaddr + bias);
+		uint32_t numDynamic = dynamicHeader->p_memsz / sizeof(Elf32_Dyn);
+
+		uint32_t relocationsAddress = 0;
+		uint32_t relocationsSize = 0;
+		uint32_t relocationSize = sizeof(Elf32_Rela);
+		uint32_t symbolsAddress = 0;
+
+		for (uint32_t i = 0; i < numDynamic && dynamic[i].d_tag != DT_NULL; ++i) {
+			switch (dynamic[i].d_tag) {
+			case DT_RELA:
+				relocationsAddress = dynamic[i].d_un.d_ptr;
+				break;
+			case DT_RELASZ:
+				relocationsSize = dynamic[i].d_un.d_val;
+				break;
+			case DT_RELAENT:
+				relocationSize = dynamic[i].d_un.d_val;
+				break;
+			case DT_SYMTAB:
+				symbolsAddress = dynamic[i].d_un.d_ptr;
+				break;
+			}
+		}
+
+		if (relocationsAddress == 0 || relocationsSize < sizeof(Elf32_Rela)) {
+			return true;
+		}
+
+		if (
+			relocationSize < sizeof(Elf32_Rela) || (relocationSize & 3) != 0 ||
+			(relocationsAddress & 3) != 0 || (symbolsAddress & 3) != 0 ||
+			!InSegment(elf, relocationsAddress, relocationsSize)
+		) {
+			return false;
+		}
+
+		const Elf32_Rela *relocations = reinterpret_cast<const Elf32_Rela *>(relocationsAddress + bias);
+
+		// Any partial relocation at the end is ignored
+		const uint8_t *relocationsEnd = reinterpret_cast<const uint8_t *>(relocations) +
+			relocationsSize - sizeof(Elf32_Rela);
+		for (
+			const uint8_t *r = reinterpret_cast<const uint8_t *>(relocations);
+			r <= relocationsEnd;
+			r += relocationSize
+		) {
+			const Elf32_Rela *relocation = reinterpret_cast<const Elf32_Rela *>(r);
+			uint8_t *where = reinterpret_cast<uint8_t *>(relocation->r_offset + bias);
+			uint32_t value;
+
+			switch (ELF32_R_TYPE(relocation->r_info)) {
+			case R_SH_NONE:
+				continue;
+			case R_SH_RELATIVE:
+				value = bias + relocation->r_addend;
+				break;
+			case R_SH_DIR32:
+			case R_SH_GLOB_DAT:
+			case R_SH_JMP_SLOT: {
+				uint32_t symbolIndex = ELF32_R_SYM(relocation->r_info);
+				value = relocation->r_addend;
+
+				if (symbolIndex != 0) {
+					// The number of symbols isn't recorded anywhere the
+					// loader reads, but they can't go past the image
+					uint32_t symbolAddress = symbolsAddress + symbolIndex * sizeof(Elf32_Sym);
+					if (symbolsAddress == 0 || !InSegment(elf, symbolAddress, sizeof(Elf32_Sym))) {
+						return false;
+					}
+
+					const Elf32_Sym *symbol = reinterpret_cast<const Elf32_Sym *>(symbolAddress + bias);
+					if (symbol->st_shndx == SHN_UNDEF) {
+						// Unresolved weak symbols are null, anything else
+						// can't be satisfied.
+						if (ELF32_ST_BIND(symbol->st_info) != STB_WEAK) {
+							return false;
+						}
+					} else if (symbol->st_shndx == SHN_ABS) {
+						// e.g. OS functions, which don't move with the app
+						value += symbol->st_value;
+					} else {
+						value += symbol->st_value + bias;
+					}
+				}
+				break;
+			}
+			default:
+				return false;
+			}
+
+			if (!InSegment(elf, relocation->r_offset, sizeof(value))) {
+				return false;
+			}
+
+			// R_SH_DIR32 can target unaligned data
+			if ((reinterpret_cast<uintptr_t>(where) & 3) == 0) {
+				*reinterpret_cast<uint32_t *>(where) = value;
+			} else {
+				memcpy(where, &value, sizeof(value));
+			}
+		}
+
+		return true;
+	}
+
+	// The app which was most recently loaded, for loading its overlays
+	const char *g_loadedAppPath;
+	uint32_t g_loadedAppBias;
+
+	const char *SectionName(
+		const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders,
+		const Elf32_Shdr *sectionHeader
+	) {
+		return reinterpret_cast<const char *>(
+			reinterpret_cast<const uint8_t *>(elf) +
+			sectionHeaders[elf->e_shstrndx].sh_offset +
+			sectionHeader->sh_name
+		);
+	}
+
+	/**
+	 * Writes back the data cache and invalidates the instruction cache for a
+	 * region of memory, so code which was just copied there can be run. Does
+	 * nothing in a host build (see tests/).
+	 */
+	void FlushCache(const void *start, uint32_t size) {
+		const uint32_t CACHE_LINE_SIZE = 32;
+
+		uintptr_t line = reinterpret_cast<uintptr_t>(start) & ~(CACHE_LINE_SIZE - 1);
+		uintptr_t end = reinterpret_cast<uintptr_t>(start) + size;
+
+		for (; line < end; line += CACHE_LINE_SIZE) {
+#ifdef __sh__
+			__asm__ __volatile__(
+				"ocbwb @%0\n"
+				"icbi @%0"
+				: : "r" (line) : "memory"
+			);
+#endif
+		}
+	}
+
+	const char XIP_SECTION_NAME[] = ".xip_rodata";
+
+	// The smallest piece a file can be fragmented into on flash
+	const uint32_t SECTOR_SIZE = 512;
+
+	// Kept open while the app runs, so the mapping its XIP data is read
+	// through stays valid. -1 if the app's XIP data was copied into RAM (or
+	// it has none).
+	int g_xipFile;
+
+	// How far the app's XIP data is from where it was linked to run
+	uint32_t g_xipDelta;
+
+	/**
+	 * Finds the section holding an app's execute-in-place data (see
+	 * sdk/xip.hpp).
+	 *
+	 * @return The index of the section, or -1 if the app has none.
+	 */
+	int FindXIPSection(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders) {
+		if (sectionHeaders == nullptr) {
+			return -1;
+		}
+
+		for (int i = 0; i < elf->e_shnum; ++i) {
+			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+			if (
+				sectionHeader->sh_type == SHT_PROGBITS &&
+				sectionHeader->sh_size > 0 &&
+				strcmp(SectionName(elf, sectionHeaders, sectionHeader), XIP_SECTION_NAME) == 0
+			) {
+				return i;
+			}
+		}
+
+		return -1;
+	}
+
+	/**
+	 * Finds the PT_LOAD segment whose contents in the file include
+	 * @p offset.
+	 */
+	const Elf32_Phdr *FindSegment(const Elf32_Ehdr *elf, uint32_t offset) {
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			reinterpret_cast<const uint8_t *>(elf) + elf->e_phoff
+		);
+
+		for (int i = 0; i < elf->e_phnum; ++i) {
+			const Elf32_Phdr *programHeader = &programHeaders[i];
+			if (
+				programHeader->p_type == PT_LOAD &&
+				offset >= programHeader->p_offset &&
+				offset < programHeader->p_offset + programHeader->p_filesz
+			) {
+				return programHeader;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/**
+	 * Walks the relocations (kept in the app by linking with --emit-relocs)
+	 * which refer to symbols in the XIP section, pointing them at the
+	 * section's mapping (@ref g_xipDelta).
+	 *
+	 * @param overlay If not nullptr, only references from this overlay are
+	 * fixed up. Otherwise, references from everything except overlays are.
+	 * @param checkOnly If true, nothing is changed - the relocations are just
+	 * checked to all be plain 32-bit addresses in RAM (not in the read-only
+	 * XIP section itself), so the section can be left on flash.
+	 * @return False if a relocation can't be fixed up, or if the app has no
+	 * relocations at all.
+	 */
+	bool RelocateXIP(
+		const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, int xipIndex,
+		const Elf32_Shdr *overlay, bool checkOnly
+	) {
+		const uint8_t *base = reinterpret_cast<const uint8_t *>(elf);
+		const Elf32_Shdr *xip = &sectionHeaders[xipIndex];
+		bool hasRelocations = false;
+
+		for (int i = 0; i < elf->e_shnum; ++i) {
+			const Elf32_Shdr *relocationSection = &sectionHeaders[i];
+			if (
+				relocationSection->sh_type != SHT_RELA ||
+				(relocationSection->sh_flags & SHF_ALLOC) == SHF_ALLOC ||
+				relocationSection->sh_info >= elf->e_shnum ||
+				relocationSection->sh_link >= elf->e_shnum
+			) {
+				continue;
+			}
+
+			hasRelocations = true;
+
+			// e.g. debugging information, which is never loaded
+			const Elf32_Shdr *target = &sectionHeaders[relocationSection->sh_info];
+			if ((target->sh_flags & SHF_ALLOC) != SHF_ALLOC) {
+				continue;
+			}
+
+			bool targetIsOverlay =
+				SkipPrefix(SectionName(elf, sectionHeaders, target), ".overlay.") != nullptr;
+			if (!checkOnly && (overlay == nullptr ? targetIsOverlay : target != overlay)) {
+				continue;
+			}
+
+			const Elf32_Shdr *symbolTable = &sectionHeaders[relocationSection->sh_link];
+			const Elf32_Sym *symbols = reinterpret_cast<const Elf32_Sym *>(base + symbolTable->sh_offset);
+			uint32_t numSymbols = symbolTable->sh_size / sizeof(Elf32_Sym);
+
+			const Elf32_Rela *relocations = reinterpret_cast<const Elf32_Rela *>(
+				base + relocationSection->sh_offset
+			);
+			uint32_t numRelocations = relocationSection->sh_size / sizeof(Elf32_Rela);
+
+			for (uint32_t j = 0; j < numRelocations; ++j) {
+				const Elf32_Rela *relocation = &relocations[j];
+				uint32_t symbolIndex = ELF32_R_SYM(relocation->r_info);
+				if (symbolIndex >= numSymbols) {
+					return false;
+				}
+
+				const Elf32_Sym *symbol = &symbols[symbolIndex];
+				if (symbol->st_shndx != xipIndex || ELF32_R_TYPE(relocation->r_info) == R_SH_NONE) {
+					continue;
+				}
+
+				if (checkOnly) {
+					if (target == xip || ELF32_R_TYPE(relocation->r_info) != R_SH_DIR32) {
+						return false;
+					}
+
+					continue;
+				}
+
+				// Computed from the symbol and addend alone, like Relocate, so
+				// doing this twice (when relaunching) is harmless
+				uint32_t value = symbol->st_value + relocation->r_addend + g_xipDelta;
+				memcpy(reinterpret_cast<void *>(relocation->r_offset), &value, sizeof(value));
+			}
+		}
+
+		return hasRelocations;
+	}
+
+	/**
+	 * Opens a file, and checks that a range of it is mapped contiguously -
+	 * @c getAddr only promises that the data up to the end of the current
+	 * sector follows the address it returns.
+	 *
+	 * @return The address of the range, or nullptr if it's fragmented. The
+	 * file is left open in @ref g_xipFile on success.
+	 */
+	const uint8_t *MapContiguous(const char *path, uint32_t offset, uint32_t size) {
+		int fd = open(path, OPEN_READ);
+		if (fd < 0) {
+			return nullptr;
+		}
+
+		const uint8_t *start;
+		if (getAddr(fd, offset, (const void **) &start) < 0) {
+			close(fd);
+			return nullptr;
+		}
+
+		// Check the start of each sector after the first, and the very end
+		uint32_t check = (offset | (SECTOR_SIZE - 1)) + 1;
+		for (;; check += SECTOR_SIZE) {
+			if (check >= offset + size) {
+				check = offset + size - 1;
+			}
+
+			const uint8_t *address;
+			if (getAddr(fd, check, (const void **) &address) < 0 || address != start + (check - offset)) {
+				close(fd);
+				return nullptr;
+			}
+
+			if (check == offset + size - 1) {
+				break;
+			}
+		}
+
+		g_xipFile = fd;
+		return start;
+	}
+
+	/**
+	 * Makes an app's execute-in-place data available to it, once the rest of
+	 * the app has been loaded.
+	 *
+	 * The data is left on flash if the app is a fixed-address one linked
+	 * with --emit-relocs (so every reference to it can be found) and the
+	 * file isn't fragmented. Otherwise, it's copied into RAM at the address
+	 * it was linked to run at, like any other segment.
+	 *
+	 * @return False if the app's XIP data couldn't be loaded.
+	 */
+	bool SetupXIP(const char *path, const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, uint32_t bias) {
+		g_xipDelta = 0;
+
+		int xipIndex = FindXIPSection(elf, sectionHeaders);
+		if (xipIndex < 0) {
+			return true;
+		}
+
+		const Elf32_Shdr *xip = &sectionHeaders[xipIndex];
+		const Elf32_Phdr *segment = FindSegment(elf, xip->sh_offset);
+		if (segment == nullptr) {
+			return false;
+		}
+
+		if (
+			elf->e_type == ET_EXEC &&
+			segment->p_memsz == segment->p_filesz &&
+			RelocateXIP(elf, sectionHeaders, xipIndex, nullptr, true)
+		) {
+			const uint8_t *mapped = MapContiguous(path, segment->p_offset, segment->p_filesz);
+			if (mapped != nullptr) {
+				g_xipDelta = reinterpret_cast<uintptr_t>(mapped) - segment->p_vaddr;
+				RelocateXIP(elf, sectionHeaders, xipIndex, nullptr, false);
+				return true;
+			}
+
+			// When relaunching, the code still points at where the data was
+			// mapped last time - point it back at the copy in RAM.
+			RelocateXIP(elf, sectionHeaders, xipIndex, nullptr, false);
+		}
+
+		return LoadSegment(elf, segment, bias);
+	}
+
+	/**
+	 * Loads an overlay of the most recently loaded app. Called by apps through
+	 * the launch info block.
+	 *
+	 * Position-independent apps can't use overlays. Their dynamic relocations
+	 * are only found by address, and all overlays share the same addresses,
+	 * so there's no telling which overlay a relocation belongs to.
+	 *
+	 * @param name The name of the overlay, i.e. the part of its section name
+	 * after ".overlay.".
+	 * @return 0 on success, or a negative error code on failure (EINVAL for
+	 * a position-independent app).
+	 */
+	int LoadOverlay(const char *name) {
+		if (g_loadedAppPath == nullptr) {
+			return ENOENT;
+		}
+
+		File f;
+		int ret = f.open(g_loadedAppPath, OPEN_READ);
+		if (ret < 0) {
+			return ret;
+		}
+
+		const Elf32_Shdr *sectionHeaders;
+		const Elf32_Ehdr *elf = LoadELF(f, &sectionHeaders);
+
+		// Overlays can only be found by name
+		if (elf == nullptr || sectionHeaders == nullptr || elf->e_type == ET_DYN) {
+			return EINVAL;
+		}
+
+		const uint8_t *base = reinterpret_cast<const uint8_t *>(elf);
+		const Elf32_Shdr *overlay = nullptr;
+		for (int i = 0; i < elf->e_shnum; ++i) {
+			const char *overlayName = SkipPrefix(
+				SectionName(elf, sectionHeaders, &sectionHeaders[i]), ".overlay."
+			);
+			if (overlayName != nullptr && strcmp(overlayName, name) == 0) {
+				overlay = &sectionHeaders[i];
+				break;
+			}
+		}
+
+		if (overlay == nullptr) {
+			return ENOENT;
+		}
+
+		// Load the whole segment the overlay's section is in, as the linker
+		// may have put other input sections alongside it.
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			base + elf->e_phoff
+		);
+
+		for (int i = 0; i < elf->e_phnum; ++i) {
+			const Elf32_Phdr *programHeader = &programHeaders[i];
+
+			if (
+				programHeader->p_type != PT_LOAD ||
+				!IsOverlay(programHeader) ||
+				overlay->sh_offset < programHeader->p_offset ||
+				overlay->sh_offset >= programHeader->p_offset + programHeader->p_filesz
+			) {
+				continue;
+			}
+
+			uint8_t *dest = reinterpret_cast<uint8_t *>(programHeader->p_vaddr + g_loadedAppBias);
+
+			// Read straight from the file's mapping, no intermediate buffer
+			memcpy(dest, base + programHeader->p_offset, programHeader->p_filesz);
+			if (programHeader->p_memsz > programHeader->p_filesz) {
+				memset(
+					dest + programHeader->p_filesz, 0,
+					programHeader->p_memsz - programHeader->p_filesz
+				);
+			}
+
+			// The overlay was linked pointing at where the XIP data would
+			// have been copied to
+			if (g_xipDelta != 0) {
+				RelocateXIP(elf, sectionHeaders, FindXIPSection(elf, sectionHeaders), overlay, false);
+			}
+
+			FlushCache(dest, programHeader->p_memsz);
+			return 0;
+		}
+
+		return ENOENT;
+	}
+
+	/**
+	 * What the launcher remembers about the last image it loaded, so the app
+	 * can be run again without loading it from scratch (see
+	 * @ref RunLastApp).
+	 */
+	struct LastImage {
+		uint32_t magic;
+		uint32_t loadAddress;
+		uint32_t bias;
+
+		// Fingerprint of the file the image was loaded from
+		uint32_t fileSize;
+		uint16_t lastModifiedDate;
+		uint16_t lastModifiedTime;
+
+		// Of the parts of the image the app can't change (see ForEachPart)
+		uint32_t checksum;
+
+		char path[MAX_PATH_LENGTH];
+	};
+
+	const uint32_t LAST_IMAGE_MAGIC = 0x48484C43; // "HHLC"
+
+	// Kept in the reserved area at the end of the launcher's RAM, in the 256
+	// bytes just before the launch info block (see launcher/linker.ld). The
+	// launcher binary never reaches that far, so reloading the launcher
+	// doesn't overwrite it, and neither do apps.
+	const uint32_t LAST_IMAGE_AREA_SIZE = 0x100;
+	struct LastImage * const g_lastImage = reinterpret_cast<struct LastImage *>(
+		reinterpret_cast<uintptr_t>(HOLLYHOCK_LAUNCH_INFO) - LAST_IMAGE_AREA_SIZE
+	);
+
+	static_assert(sizeof(struct LastImage) <= LAST_IMAGE_AREA_SIZE, "LastImage must fit in the reserved area");
+
+	/**
+	 * Whether an image can be split into parts by section rather than by
+	 * segment (which is usually much finer - most apps have a single
+	 * writable segment holding all their code). Needs the section headers,
+	 * and the file contents of every writable section, which compressed
+	 * apps don't keep - and at least one section that's loaded, as
+	 * otherwise the section headers don't describe the image at all.
+	 */
+	bool HasSplittableSections(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders) {
+		if (sectionHeaders == nullptr) {
+			return false;
+		}
+
+		bool hasLoadedSections = false;
+		for (int i = 0; i < elf->e_shnum; ++i) {
+			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+			if (
+				(sectionHeader->sh_flags & (SHF_ALLOC | SHF_WRITE)) == (SHF_ALLOC | SHF_WRITE) &&
+				sectionHeader->sh_type == SHT_PROGBITS &&
+				sectionHeader->sh_size > 0 &&
+				sectionHeader->sh_offset == 0
+			) {
+				return false;
+			}
+
+			if ((sectionHeader->sh_flags & SHF_ALLOC) != 0 && sectionHeader->sh_size > 0) {
+				hasLoadedSections = true;
+			}
+		}
+
+		return hasLoadedSections;
+	}
+
+	uint32_t ChecksumStep(uint32_t checksum, uint32_t value) {
+		return ((checksum << 5) | (checksum >> 27)) ^ value;
+	}
+
+	/**
+	 * Adds a region of memory to a running checksum. This runs on every
+	 * relaunch, so it takes a word at a time - only the odd bytes at either
+	 * end of the region are taken one by one. Any single changed word still
+	 * changes the checksum.
+	 */
+	uint32_t Checksum(uint32_t checksum, const uint8_t *data, uint32_t size) {
+		const uint8_t *end = data + size;
+
+		for (; data < end && (reinterpret_cast<uintptr_t>(data) & 3) != 0; ++data) {
+			checksum = ChecksumStep(checksum, *data);
+		}
+
+		const uint32_t *words = reinterpret_cast<const uint32_t *>(data);
+		const uint32_t *wordsEnd = words + (end - data) / 4;
+		for (; words + 4 <= wordsEnd; words += 4) {
+			checksum = ChecksumStep(checksum, words[0]);
+			checksum = ChecksumStep(checksum, words[1]);
+			checksum = ChecksumStep(checksum, words[2]);
+			checksum = ChecksumStep(checksum, words[3]);
+		}
+		for (; words < wordsEnd; ++words) {
+			checksum = ChecksumStep(checksum, *words);
+		}
+
+		for (data = reinterpret_cast<const uint8_t *>(words); data < end; ++data) {
+			checksum = ChecksumStep(checksum, *data);
+		}
+
+		return checksum;
+	}
+
+	/**
+	 * Checksums the parts of a loaded image which the app can't have changed
+	 * while it was running, i.e. everything that isn't writable (or an
+	 * overlay).
+	 */
+	uint32_t ChecksumImage(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, uint32_t bias) {
+		uint32_t checksum = 0;
+
+		if (HasSplittableSections(elf, sectionHeaders)) {
+			for (int i = 0; i < elf->e_shnum; ++i) {
+				const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+				if (
+					(sectionHeader->sh_flags & (SHF_ALLOC | SHF_WRITE)) != SHF_ALLOC ||
+					sectionHeader->sh_type == SHT_NOBITS ||
+					SkipPrefix(SectionName(elf, sectionHeaders, sectionHeader), ".overlay.") != nullptr ||
+					strcmp(SectionName(elf, sectionHeaders, sectionHeader), XIP_SECTION_NAME) == 0
+				) {
+					continue;
+				}
+
+				checksum = Checksum(
+					checksum,
+					reinterpret_cast<const uint8_t *>(sectionHeader->sh_addr + bias),
+					sectionHeader->sh_size
+				);
+			}
+
+			return checksum;
+		}
+
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			reinterpret_cast<const uint8_t *>(elf) + elf->e_phoff
+		);
+
+		for (int i = 0; i < elf->e_phnum; ++i) {
+			const Elf32_Phdr *programHeader = &programHeaders[i];
+			if (
+				programHeader->p_type != PT_LOAD ||
+				IsOverlay(programHeader) ||
+				(programHeader->p_flags & PF_W) != 0
+			) {
+				continue;
+			}
+
+			checksum = Checksum(
+				checksum,
+				reinterpret_cast<const uint8_t *>(programHeader->p_vaddr + bias),
+				programHeader->p_memsz
+			);
+		}
+
+		return checksum;
+	}
+
+	/**
+	 * Puts the writable parts of a loaded image back to how they were when
+	 * it was first loaded - restoring .data from the file, and zeroing .bss.
+	 */
+	bool RestoreWritableParts(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, uint32_t bias) {
+		if (HasSplittableSections(elf, sectionHeaders)) {
+			for (int i = 0; i < elf->e_shnum; ++i) {
+				const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+				if (
+					(sectionHeader->sh_flags & (SHF_ALLOC | SHF_WRITE)) != (SHF_ALLOC | SHF_WRITE) ||
+					SkipPrefix(SectionName(elf, sectionHeaders, sectionHeader), ".overlay.") != nullptr
+				) {
+					continue;
+				}
+
+				void *dest = reinterpret_cast<void *>(sectionHeader->sh_addr + bias);
+				if (sectionHeader->sh_type == SHT_PROGBITS) {
+					memcpy(
+						dest,
+						reinterpret_cast<const uint8_t *>(elf) + sectionHeader->sh_offset,
+						sectionHeader->sh_size
+					);
+				} else if (sectionHeader->sh_type == SHT_NOBITS) {
+					memset(dest, 0, sectionHeader->sh_size);
+				}
+			}
+
+			return true;
+		}
+
+		if (elf->e_phoff == 0) {
+			return false;
+		}
+
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			reinterpret_cast<const uint8_t *>(elf) + elf->e_phoff
+		);
+
+		for (int i = 0; i < elf->e_phnum; ++i) {
+			const Elf32_Phdr *programHeader = &programHeaders[i];
+			if (
+				programHeader->p_type != PT_LOAD ||
+				IsOverlay(programHeader) ||
+				(programHeader->p_flags & PF_W) == 0
+			) {
+				continue;
+			}
+
+			if (!LoadSegment(elf, programHeader, bias)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	const char VERIFIED_PATH[] = "\\fls0\\.hhkverified";
+	const char VERIFIED_TEMP_PATH[] = "\\fls0\\.hhkverified.new";
+	const uint32_t VERIFIED_MAGIC = 0x48484B56; // "HHKV"
+	const uint32_t VERIFIED_VERSION = 1;
+	const uint32_t MAX_VERIFIED = 32;
+
+	/**
+	 * An app file whose checksum has been verified.
+	 */
+	struct VerifiedEntry {
+		// CRC-32 of the app's path
+		uint32_t pathHash;
+		uint32_t fileSize;
+		uint16_t lastModifiedDate;
+		uint16_t lastModifiedTime;
+	};
+
+	/**
+	 * The list of recently verified apps (@ref VERIFIED_PATH), so checksums
+	 * are only verified the first time an app is run after it changes.
+	 */
+	struct VerifiedList {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t numEntries;
+		// The entry to replace once the list is full
+		uint32_t next;
+		struct VerifiedEntry entries[MAX_VERIFIED];
+	};
+
+	/**
+	 * Reads the verified list from flash, or starts an empty one if it's
+	 * missing or invalid.
+	 */
+	void LoadVerifiedList(struct VerifiedList *list) {
+		list->numEntries = 0;
+		list->next = 0;
+
+		File f;
+		if (
+			f.open(VERIFIED_PATH, OPEN_READ) < 0 &&
+			(!RecoverFile(VERIFIED_PATH, VERIFIED_TEMP_PATH) || f.open(VERIFIED_PATH, OPEN_READ) < 0)
+		) {
+			return;
+		}
+
+		struct stat listStat;
+		if (f.fstat(&listStat) < 0 || listStat.fileSize != sizeof(struct VerifiedList)) {
+			return;
+		}
+
+		const struct VerifiedList *stored;
+		if (f.getAddr(0, (const void **) &stored) < 0) {
+			return;
+		}
+
+		if (
+			stored->magic != VERIFIED_MAGIC ||
+			stored->version != VERIFIED_VERSION ||
+			stored->numEntries > MAX_VERIFIED ||
+			stored->next >= MAX_VERIFIED
+		) {
+			return;
+		}
+
+		memcpy(list, stored, sizeof(struct VerifiedList));
+	}
+
+	void SaveVerifiedList(struct VerifiedList *list) {
+		list->magic = VERIFIED_MAGIC;
+		list->version = VERIFIED_VERSION;
+
+		ReplaceFile(VERIFIED_PATH, VERIFIED_TEMP_PATH, list, sizeof(struct VerifiedList));
+	}
+
+	/**
+	 * Finds the checksum in an app's @c .hollyhock_meta section.
+	 *
+	 * @return False if the app wasn't given a checksum.
+	 */
+	bool GetChecksum(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, uint32_t *checksum) {
+		if (sectionHeaders == nullptr) {
+			return false;
+		}
+
+		for (int i = 0; i < elf->e_shnum; ++i) {
+			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+			const struct HollyhockMetaHeader *meta = GetMeta(elf, sectionHeader);
+			if (meta == nullptr) {
+				continue;
+			}
+
+			if ((meta->flags & HOLLYHOCK_META_FLAG_CRC32) == 0) {
+				return false;
+			}
+
+			*checksum = meta->crc32;
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Computes the CRC-32 of the file contents of every PT_LOAD segment, in
+	 * program header order - the same as tools/hhk_checksum.py.
+	 *
+	 * @return False if a segment runs past the end of the file.
+	 */
+	bool ChecksumSegments(const Elf32_Ehdr *elf, uint32_t fileSize, uint32_t *checksum) {
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			reinterpret_cast<const uint8_t *>(elf) + elf->e_phoff
+		);
+
+		uint32_t crc = 0;
+		for (int i = 0; i < elf->e_phnum; ++i) {
+			const Elf32_Phdr *programHeader = &programHeaders[i];
+			if (programHeader->p_type != PT_LOAD) {
+				continue;
+			}
+
+			if (
+				programHeader->p_offset > fileSize ||
+				programHeader->p_filesz > fileSize - programHeader->p_offset
+			) {
+				return false;
+			}
+
+			crc = CRC32::Update(
+				crc,
+				reinterpret_cast<const uint8_t *>(elf) + programHeader->p_offset,
+				programHeader->p_filesz
+			);
+		}
+
+		*checksum = crc;
+		return true;
+	}
+
+	/**
+	 * Checks an app against the checksum in its metadata, if it has one.
+	 * Apps which pass are added to the verified list, so they aren't checked
+	 * again until their file changes.
+	 *
+	 * @return False if the app is corrupt, true otherwise.
+	 */
+	bool VerifyImage(File &f, const char *path, const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders) {
+		uint32_t expected;
+		if (elf->e_phoff == 0 || !GetChecksum(elf, sectionHeaders, &expected)) {
+			return true;
+		}
+
+		Timing::Probe probe(Timing::PhaseVerify);
+
+		struct stat fileStat;
+		if (f.fstat(&fileStat) < 0) {
+			return false;
+		}
+
+		if (!CRC32::Init()) {
+			return false;
+		}
+
+		struct VerifiedEntry entry;
+		entry.pathHash = CRC32::Update(0, reinterpret_cast<const uint8_t *>(path), strlen(path));
+		entry.fileSize = fileStat.fileSize;
+		entry.lastModifiedDate = fileStat.lastModifiedDate;
+		entry.lastModifiedTime = fileStat.lastModifiedTime;
+
+		struct VerifiedList list;
+		LoadVerifiedList(&list);
+
+		for (uint32_t i = 0; i < list.numEntries; ++i) {
+			const struct VerifiedEntry *verified = &list.entries[i];
+			if (
+				verified->pathHash == entry.pathHash &&
+				verified->fileSize == entry.fileSize &&
+				verified->lastModifiedDate == entry.lastModifiedDate &&
+				verified->lastModifiedTime == entry.lastModifiedTime
+			) {
+				CRC32::Shutdown();
+				return true;
+			}
+		}
+
+		uint32_t actual;
+		bool valid = ChecksumSegments(elf, fileStat.fileSize, &actual) && actual == expected;
+		CRC32::Shutdown();
+
+		if (!valid) {
+			return false;
+		}
+
+		if (list.numEntries < MAX_VERIFIED) {
+			list.entries[list.numEntries++] = entry;
+		} else {
+			list.entries[list.next] = entry;
+			list.next = list.next + 1 < MAX_VERIFIED ? list.next + 1 : 0;
+		}
+
+		SaveVerifiedList(&list);
+		return true;
+	}
+
+	void RememberImage(
+		File &f, const char *path, const Elf32_Ehdr *elf,
+		const Elf32_Shdr *sectionHeaders, uint32_t loadAddress, uint32_t bias
+	) {
+		struct stat fileStat;
+		if (f.fstat(&fileStat) < 0 || strlen(path) >= static_cast<int>(sizeof(g_lastImage->path))) {
+			return;
+		}
+
+		// When relaunching, path already points at the cached path
+		if (path != g_lastImage->path) {
+			strcpy(g_lastImage->path, path);
+		}
+
+		g_lastImage->loadAddress = loadAddress;
+		g_lastImage->bias = bias;
+		g_lastImage->fileSize = fileStat.fileSize;
+		g_lastImage->lastModifiedDate = fileStat.lastModifiedDate;
+		g_lastImage->lastModifiedTime = fileStat.lastModifiedTime;
+		g_lastImage->checksum = ChecksumImage(elf, sectionHeaders, bias);
+		g_lastImage->magic = LAST_IMAGE_MAGIC;
+	}
+
+	EntryPoint LoadImage(const char *path, uint32_t loadAddress) {
+		// Whatever was loaded before is about to be overwritten
+		g_lastImage->magic = 0;
+
+		File f;
+		int ret = f.open(path, OPEN_READ);
+		if (ret < 0) {
+			return nullptr;
+		}
+
+		const Elf32_Shdr *sectionHeaders;
+		const Elf32_Ehdr *elf = LoadELF(f, &sectionHeaders);
+
+		if (elf == nullptr) {
+			return nullptr;
+		}
+
+		// Check before anything is loaded, so nothing of a corrupt app ever
+		// runs
+		if (!VerifyImage(f, path, elf, sectionHeaders)) {
+			return nullptr;
+		}
+
+		bool hasProgramHeaders = elf->e_phoff != 0 && elf->e_phnum > 0;
+		uint32_t bias = 0;
+
+		if (elf->e_type == ET_DYN) {
+			// Position-independent apps can only be loaded by segment
+			if (!hasProgramHeaders) {
+				return nullptr;
+			}
+
+			bias = loadAddress - LinkAddress(elf);
+			if (
+				!LoadSegments(elf, bias) ||
+				!SetupXIP(path, elf, sectionHeaders, bias) ||
+				!Relocate(elf, bias)
+			) {
+				return nullptr;
+			}
+		} else if (hasProgramHeaders) {
+			if (!LoadSegments(elf, 0) || !SetupXIP(path, elf, sectionHeaders, 0)) {
+				return nullptr;
+			}
+		} else if (sectionHeaders != nullptr) {
+			LoadSections(elf, sectionHeaders);
+		} else {
+			return nullptr;
+		}
+
+		g_loadedAppPath = path;
+		g_loadedAppBias = bias;
+		RememberImage(f, path, elf, sectionHeaders, loadAddress, bias);
+		return reinterpret_cast<EntryPoint>(elf->e_entry + bias);
+	}
+
+	/**
+	 * Makes the last loaded image ready to run again, if it's still in memory
+	 * and its file hasn't changed.
+	 *
+	 * @return The app's entry point, or nullptr if the image has to be loaded
+	 * from scratch.
+	 */
+	EntryPoint ReloadImage() {
+		if (g_lastImage->magic != LAST_IMAGE_MAGIC) {
+			return nullptr;
+		}
+
+		File f;
+		if (f.open(g_lastImage->path, OPEN_READ) < 0) {
+			return nullptr;
+		}
+
+		struct stat fileStat;
+		if (
+			f.fstat(&fileStat) < 0 ||
+			fileStat.fileSize != g_lastImage->fileSize ||
+			fileStat.lastModifiedDate != g_lastImage->lastModifiedDate ||
+			fileStat.lastModifiedTime != g_lastImage->lastModifiedTime
+		) {
+			return nullptr;
+		}
+
+		const Elf32_Shdr *sectionHeaders;
+		const Elf32_Ehdr *elf = LoadELF(f, &sectionHeaders);
+		if (elf == nullptr) {
+			return nullptr;
+		}
+
+		// Catches the image being overwritten by anything else since
+		uint32_t bias = g_lastImage->bias;
+		if (ChecksumImage(elf, sectionHeaders, bias) != g_lastImage->checksum) {
+			return nullptr;
+		}
+
+		if (!RestoreWritableParts(elf, sectionHeaders, bias)) {
+			return nullptr;
+		}
+
+		// Relocations are computed from their addends alone, so applying them
+		// again is harmless, and fixes up any pointers in .data.
+		if (elf->e_type == ET_DYN && !Relocate(elf, bias)) {
+			return nullptr;
+		}
+
+		// The file may be mapped somewhere else now, so find the XIP data
+		// again. That can change the code, so the checksum changes with it.
+		if (elf->e_phoff != 0 && !SetupXIP(g_lastImage->path, elf, sectionHeaders, bias)) {
+			return nullptr;
+		}
+		g_lastImage->checksum = ChecksumImage(elf, sectionHeaders, bias);
+
+		g_loadedAppPath = g_lastImage->path;
+		g_loadedAppBias = bias;
+		return reinterpret_cast<EntryPoint>(elf->e_entry + bias);
+	}
+
+	/**
+	 * Fills in the launch info block, so the app can call back into the
+	 * launcher.
+	 */
+	void SetLaunchInfo() {
+		struct HollyhockLaunchInfo *launchInfo = HOLLYHOCK_LAUNCH_INFO;
+		launchInfo->magic = HOLLYHOCK_LAUNCH_INFO_MAGIC;
+		launchInfo->version = HOLLYHOCK_LAUNCH_INFO_VERSION;
+		launchInfo->loadOverlay = LoadOverlay;
+	}
+
+    EntryPoint RunApp(int i) {
+		Timing::Probe probe(Timing::PhaseRunApp);
+
+		// .bss isn't zeroed for the launcher (see LoadAppInfo)
+		g_loadedAppPath = nullptr;
+		g_xipFile = -1;
+		g_xipDelta = 0;
+
+		EntryPoint entryPoint = LoadImage(g_apps[i].path, APP_LOAD_ADDRESS);
+		if (entryPoint == nullptr) {
+			return nullptr;
+		}
+
+		SetLaunchInfo();
+		return entryPoint;
+    }
+
+	EntryPoint RunLastApp() {
+		Timing::Probe probe(Timing::PhaseRunApp);
+
+		// .bss isn't zeroed for the launcher (see LoadAppInfo)
+		g_loadedAppPath = nullptr;
+		g_xipFile = -1;
+		g_xipDelta = 0;
+
+		EntryPoint entryPoint = ReloadImage();
+		if (entryPoint == nullptr && g_lastImage->magic == LAST_IMAGE_MAGIC) {
+			// The image is stale - load it again from scratch. LoadImage
+			// clears the magic, so copy the path out first.
+			char path[sizeof(g_lastImage->path)];
+			strcpy(path, g_lastImage->path);
+			uint32_t loadAddress = g_lastImage->loadAddress;
+
+			entryPoint = LoadImage(path, loadAddress);
+
+			// path won't outlive this function, so point overlays at the
+			// cached copy instead
+			g_loadedAppPath = g_lastImage->path;
+		}
+
+		if (entryPoint == nullptr) {
+			return nullptr;
+		}
+
+		SetLaunchInfo();
+		return entryPoint;
+	}
+
+	/**
+	 * Copies part of a file out of its mapping. @c getAddr only promises that
+	 * the data up to the end of the current sector is contiguous, so this
+	 * goes a sector at a time.
+	 */
+	bool ReadMapped(File &f, uint32_t offset, void *dest, uint32_t size) {
+		uint8_t *out = static_cast<uint8_t *>(dest);
+
+		while (size > 0) {
+			const uint8_t *data;
+			if (f.getAddr(offset, (const void **) &data) < 0) {
+				return false;
+			}
+
+			uint32_t chunk = SECTOR_SIZE - (offset & (SECTOR_SIZE - 1));
+			if (chunk > size) {
+				chunk = size;
+			}
+
+			memcpy(out, data, chunk);
+			out += chunk;
+			offset += chunk;
+			size -= chunk;
+		}
+
+		return true;
+	}
+
+	bool DrawIcon(int i, int x, int y) {
+		const struct AppInfo *app = &g_apps[i];
+		if (app->iconOffset == 0) {
+			return false;
+		}
+
+		File f;
+		if (f.open(app->path, OPEN_READ) < 0) {
+			return false;
+		}
+
+		struct stat fileStat;
+		if (
+			f.fstat(&fileStat) < 0 ||
+			app->iconOffset > fileStat.fileSize ||
+			fileStat.fileSize - app->iconOffset < sizeof(struct HollyhockIconHeader)
+		) {
+			return false;
+		}
+
+		struct HollyhockIconHeader icon;
+		if (!ReadMapped(f, app->iconOffset, &icon, sizeof(icon))) {
+			return false;
+		}
+
+		uint32_t width = icon.width;
+		uint32_t height = icon.height;
+		if (
+			icon.magic != HOLLYHOCK_ICON_MAGIC ||
+			width == 0 || width > HOLLYHOCK_ICON_MAX_SIZE ||
+			height == 0 || height > HOLLYHOCK_ICON_MAX_SIZE ||
+			(icon.format != HollyhockIconRGB565 && icon.format != HollyhockIconPalette16)
+		) {
+			return false;
+		}
+
+		uint32_t dataSize = HOLLYHOCK_ICON_DATA_SIZE(width, height, icon.format) * sizeof(uint16_t);
+		if (fileStat.fileSize - app->iconOffset - sizeof(struct HollyhockIconHeader) < dataSize) {
+			return false;
+		}
+
+		int screenWidth, screenHeight;
+		LCD_GetSize(&screenWidth, &screenHeight);
+
+		x += (HOLLYHOCK_ICON_MAX_SIZE - width) >> 1;
+		y += (HOLLYHOCK_ICON_MAX_SIZE - height) >> 1;
+		if (
+			x < 0 || x + static_cast<int>(width) > screenWidth ||
+			y < 0 || y + static_cast<int>(height) > screenHeight
+		) {
+			return false;
+		}
+
+		// The icon may span several sectors, so it's read a row at a time
+		// rather than decoded straight out of the mapping
+		uint16_t *vram = LCD_GetVRAMAddress() + y * screenWidth + x;
+		uint32_t offset = app->iconOffset + sizeof(struct HollyhockIconHeader);
+
+		if (icon.format == HollyhockIconRGB565) {
+			for (uint32_t row = 0; row < height; ++row) {
+				if (!ReadMapped(f, offset, vram, width * sizeof(uint16_t))) {
+					return false;
+				}
+
+				vram += screenWidth;
+				offset += width * sizeof(uint16_t);
+			}
+
+			return true;
+		}
+
+		uint16_t palette[16];
+		if (!ReadMapped(f, offset, palette, sizeof(palette))) {
+			return false;
+		}
+		offset += sizeof(palette);
+
+		uint16_t indexes[(HOLLYHOCK_ICON_MAX_SIZE + 3) >> 2];
+		uint32_t stride = (width + 3) >> 2;
+
+		for (uint32_t row = 0; row < height; ++row) {
+			if (!ReadMapped(f, offset, indexes, stride * sizeof(uint16_t))) {
+				return false;
+			}
+
+			for (uint32_t column = 0; column < width; ++column) {
+				uint16_t packed = indexes[column >> 2];
+				vram[column] = palette[(packed >> (12 - ((column & 3) << 2))) & 0xF];
+			}
+
+			vram += screenWidth;
+			offset += stride * sizeof(uint16_t);
+		}
+
+		return true;
+	}
+
+	void FinishApp() {
+		if (g_xipFile >= 0) {
+			close(g_xipFile);
+			g_xipFile = -1;
+		}
+	}
 }
@@ -1,22 +1,108 @@
 #pragma once
+#include <stdint.h>
 
 namespace Apps {
+    /**
+     * An app found on the flash. All strings are stored in a shared arena,
+     * and are empty (not null) if the app didn't provide that field.
+     */
     struct AppInfo {
-        char fileName[100];
-        char path[200];
-        char name[100];
-        char description[100];
-        char author[100];
-        char version[100];
+        const char *path;
+        // Points into path
+        const char *fileName;
+        const char *name;
+        const char *description;
+        const char *author;
+        const char *version;
+
+        // Fingerprint of the file the metadata was read from, used to tell
+        // whether the cached copy in the app index is still valid.
+        uint32_t fileSize;
+        uint16_t lastModifiedDate;
+        uint16_t lastModifiedTime;
+
+        // Where the app's HollyhockIconHeader is in its file, or 0 if it
+        // doesn't have an icon. Cached in the app index along with the
+        // strings, so showing an icon doesn't need the ELF file parsing
+        // again.
+        uint32_t iconOffset;
     };
 
     typedef void (*EntryPoint)();
 
-    const int MAX_APPS = 64;
+    // Where apps are linked to run (see app_template/linker.ld), and so where
+    // position-independent apps are loaded by default.
+    const uint32_t APP_LOAD_ADDRESS = 0x8CFF0000;
 
-    extern struct AppInfo g_apps[MAX_APPS];
+    extern struct AppInfo *g_apps;
     extern int g_numApps;
 
+    /**
+     * Indexes into @ref g_apps, sorted by the apps' names (ignoring case).
+     * Apps with the same name are kept in the order they were found.
+     */
+    extern int *g_appOrder;
+
+    /**
+     * Finds the apps on the flash, filling in @ref g_apps and
+     * @ref g_appOrder.
+     */
     void LoadAppInfo();
+
+    /**
+     * Returns what the launcher lists an app as - its name, or its path if
+     * it doesn't have one.
+     */
+    const char *DisplayName(const struct AppInfo *app);
+
+    /**
+     * Compares two strings like @c strcmp, but ignoring the case of ASCII
+     * letters.
+     */
+    int CompareNames(const char *a, const char *b);
+    char ToLower(char c);
     EntryPoint RunApp(int i);
+
+    /**
+     * Draws an app's icon (see @c APP_ICON) into VRAM, centred in the
+     * @c HOLLYHOCK_ICON_MAX_SIZE pixel square box whose top-left corner is at
+     * @p x, @p y. The pixels are decoded straight from the file, without
+     * being copied onto the heap. Doesn't refresh the LCD.
+     *
+     * @return False if the app has no icon (or it couldn't be read).
+     */
+    bool DrawIcon(int i, int x, int y);
+
+    /**
+     * Gets the last app the launcher loaded ready to run again, without
+     * needing @ref LoadAppInfo to have been called.
+     *
+     * If the app's file hasn't changed and its image is still intact in
+     * memory, only its writable data is reset. Otherwise, it's loaded again
+     * from scratch.
+     *
+     * @return The app's entry point, or nullptr if there's no last app or it
+     * couldn't be loaded.
+     */
+    EntryPoint RunLastApp();
+
+    /**
+     * Releases what the launcher kept hold of for the app while it ran (the
+     * file its execute-in-place data was mapped from). Called once the app
+     * returns.
+     */
+    void FinishApp();
+
+    /**
+     * Loads an app into memory, ready to be run.
+     *
+     * Fixed-address apps (ET_EXEC) are always loaded to the address they were
+     * linked at, and @p loadAddress is ignored. Position-independent apps
+     * (ET_DYN) are loaded at @p loadAddress and relocated.
+     *
+     * @param path The path to the app's .hhk file.
+     * @param loadAddress Where to load a position-independent app.
+     * @return The app's entry point, or nullptr if it couldn't be loaded.
+     */
+    EntryPoint LoadImage(const char *path, uint32_t loadAddress);
 };
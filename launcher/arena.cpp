@@ -0,0 +1,87 @@
+#include <sdk/os/mem.hpp>
+#include "arena.hpp"
+
+/**
+ * Allocates @p size bytes. The returned memory is not aligned.
+ *
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the allocated memory.
+ */
+char *Arena::Alloc(uint32_t size) {
+	if (m_head == nullptr || size > static_cast<uint32_t>(m_end - m_cur)) {
+		uint32_t blockSize = size > m_nextBlockSize ? size : m_nextBlockSize;
+
+		struct Block *block = static_cast<struct Block *>(
+			malloc(sizeof(struct Block) + blockSize)
+		);
+		block->next = m_head;
+		m_head = block;
+
+		m_cur = reinterpret_cast<char *>(block + 1);
+		m_end = m_cur + blockSize;
+		m_nextBlockSize = DEFAULT_BLOCK_SIZE;
+	}
+
+	char *ptr = m_cur;
+	m_cur += size;
+	return ptr;
+}
+
+/**
+ * Copies a string into the arena.
+ *
+ * @param str The string to copy. Does not need to be null terminated.
+ * @param length The length of the string.
+ * @return The null terminated copy of the string.
+ */
+const char *Arena::Intern(const char *str, uint32_t length) {
+	// No need to waste space on all the missing metadata fields
+	if (length == 0) {
+		return "";
+	}
+
+	char *copy = Alloc(length + 1);
+	memcpy(copy, str, length);
+	copy[length] = '\0';
+	return copy;
+}
+
+/**
+ * Makes sure the next block allocated is at least @p size bytes. If the
+ * total size of the strings is known up front, this lets them all fit in one
+ * block.
+ *
+ * @param size The minimum size of the next block.
+ */
+void Arena::Reserve(uint32_t size) {
+	if (size > m_nextBlockSize) {
+		m_nextBlockSize = size;
+	}
+
+	// Force the next allocation to start a new block
+	m_end = m_cur;
+}
+
+/**
+ * Sets up an empty arena. Doesn't free anything which was previously
+ * allocated.
+ */
+void Arena::Init() {
+	m_head = nullptr;
+	m_cur = nullptr;
+	m_end = nullptr;
+	m_nextBlockSize = DEFAULT_BLOCK_SIZE;
+}
+
+/**
+ * Frees all memory allocated from the arena.
+ */
+void Arena::Free() {
+	while (m_head != nullptr) {
+		struct Block *next = m_head->next;
+		free(m_head);
+		m_head = next;
+	}
+
+	Init();
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * A bump allocator for strings. Memory is handed out from large blocks, and
+ * can only be freed all at once with @ref Free.
+ *
+ * Has no constructor or destructor, so it can be used as a global. Call
+ * @ref Init before using it.
+ */
+class Arena {
+public:
+    char *Alloc(uint32_t size);
+    const char *Intern(const char *str, uint32_t length);
+    void Reserve(uint32_t size);
+    void Init();
+    void Free();
+
+private:
+    struct Block {
+        struct Block *next;
+    };
+
+    static const uint32_t DEFAULT_BLOCK_SIZE = 1024;
+
+    struct Block *m_head;
+    char *m_cur;
+    char *m_end;
+    uint32_t m_nextBlockSize;
+};
@@ -0,0 +1,96 @@
+#include <sdk/os/mem.hpp>
+#include "crc32.hpp"
+
+namespace CRC32 {
+	const uint32_t POLYNOMIAL = 0xEDB88320;
+
+	/**
+	 * The slicing-by-8 tables. g_tables[0] is the usual byte-at-a-time
+	 * table, and g_tables[n][b] is the CRC of byte b followed by n zero bytes.
+	 */
+	uint32_t (*g_tables)[256];
+
+	// For reading 4 bytes at a time out of arbitrary data
+	typedef uint32_t __attribute__ ((may_alias)) AliasedWord;
+
+	bool Init() {
+		g_tables = static_cast<uint32_t (*)[256]>(malloc(8 * 256 * sizeof(uint32_t)));
+		if (g_tables == nullptr) {
+			return false;
+		}
+
+		for (uint32_t b = 0; b < 256; ++b) {
+			uint32_t crc = b;
+			for (int bit = 0; bit < 8; ++bit) {
+				crc = (crc >> 1) ^ (POLYNOMIAL & -(crc & 1));
+			}
+
+			g_tables[0][b] = crc;
+		}
+
+		for (uint32_t b = 0; b < 256; ++b) {
+			for (int n = 1; n < 8; ++n) {
+				uint32_t prev = g_tables[n - 1][b];
+				g_tables[n][b] = (prev >> 8) ^ g_tables[0][prev & 0xFF];
+			}
+		}
+
+		return true;
+	}
+
+	void Shutdown() {
+		free(g_tables);
+	}
+
+	/**
+	 * Reads an aligned 32-bit word as little-endian, the byte order the
+	 * tables are built for.
+	 */
+	static inline uint32_t ReadLE32(const uint8_t *p) {
+		uint32_t word = *reinterpret_cast<const AliasedWord *>(p);
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		word = __builtin_bswap32(word);
+#endif
+
+		return word;
+	}
+
+	uint32_t Update(uint32_t crc, const uint8_t *data, uint32_t size) {
+		const uint32_t (*t)[256] = g_tables;
+		crc = ~crc;
+
+		// Byte at a time up to a word boundary...
+		while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 3) != 0) {
+			crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+			--size;
+		}
+
+		// ...then 8 bytes (and 8 table lookups) per iteration...
+		while (size >= 8) {
+			uint32_t one = ReadLE32(data) ^ crc;
+			uint32_t two = ReadLE32(data + 4);
+
+			crc =
+				t[7][one & 0xFF] ^
+				t[6][(one >> 8) & 0xFF] ^
+				t[5][(one >> 16) & 0xFF] ^
+				t[4][one >> 24] ^
+				t[3][two & 0xFF] ^
+				t[2][(two >> 8) & 0xFF] ^
+				t[1][(two >> 16) & 0xFF] ^
+				t[0][two >> 24];
+
+			data += 8;
+			size -= 8;
+		}
+
+		// ...and whatever's left a byte at a time.
+		while (size > 0) {
+			crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+			--size;
+		}
+
+		return ~crc;
+	}
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+
+namespace CRC32 {
+    /**
+     * Builds the lookup tables, which @ref Update needs. They're generated
+     * rather than stored, to keep 8KiB of tables out of the launcher binary.
+     *
+     * @return False if there wasn't enough memory for the tables.
+     */
+    bool Init();
+
+    /**
+     * Frees the tables built by @ref Init.
+     */
+    void Shutdown();
+
+    /**
+     * Adds data to a running CRC-32 (the same one as zlib's @c crc32). Start
+     * with a CRC of 0.
+     */
+    uint32_t Update(uint32_t crc, const uint8_t *data, uint32_t size);
+};
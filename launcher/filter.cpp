@@ -0,0 +1,166 @@
+#include <sdk/os/mem.hpp>
+#include <sdk/os/string.hpp>
+#include "apps.hpp"
+#include "filter.hpp"
+
+namespace Apps {
+	enum Match {
+		MatchNone,
+		MatchSubstring,
+		MatchPrefix
+	};
+
+	/**
+	 * Checks whether (and where) the name of the app at position @p position
+	 * in g_appOrder contains @p query.
+	 */
+	static Match MatchApp(int position, const char *query) {
+		const char *name = DisplayName(&g_apps[g_appOrder[position]]);
+
+		for (const char *start = name; *start != '\0'; ++start) {
+			const char *n = start;
+			const char *q = query;
+			while (*q != '\0' && ToLower(*n) == ToLower(*q)) {
+				++n;
+				++q;
+			}
+
+			if (*q == '\0') {
+				return start == name ? MatchPrefix : MatchSubstring;
+			}
+		}
+
+		// Everything contains the empty string
+		return *query == '\0' ? MatchPrefix : MatchNone;
+	}
+
+	/**
+	 * Steps through a list of positions, stopping only at those whose match
+	 * is @p wanted.
+	 */
+	class MatchCursor {
+	public:
+		MatchCursor(
+			const int *list, int count, const char *query, Match wanted
+		) : m_list(list), m_count(count), m_i(-1), m_query(query), m_wanted(wanted) {
+			Next();
+		}
+
+		bool Done() {
+			return m_i >= m_count;
+		}
+
+		int Position() {
+			return m_list[m_i];
+		}
+
+		void Next() {
+			for (++m_i; m_i < m_count; ++m_i) {
+				if (MatchApp(m_list[m_i], m_query) == m_wanted) {
+					return;
+				}
+			}
+		}
+
+	private:
+		const int *m_list;
+		int m_count;
+		int m_i;
+		const char *m_query;
+		Match m_wanted;
+	};
+
+	Filter::Filter() :
+		m_matches(nullptr), m_numMatches(0), m_numPrefixMatches(0),
+		m_scratch(nullptr) {
+
+		m_query[0] = '\0';
+	}
+
+	Filter::~Filter() {
+		if (m_matches != nullptr) {
+			free(m_matches);
+		}
+
+		if (m_scratch != nullptr) {
+			free(m_scratch);
+		}
+	}
+
+	void Filter::Reset() {
+		if (m_matches == nullptr) {
+			m_matches = static_cast<int *>(malloc((g_numApps + 1) * sizeof(int)));
+			m_scratch = static_cast<int *>(malloc((g_numApps + 1) * sizeof(int)));
+		}
+
+		for (int i = 0; i < g_numApps; ++i) {
+			m_matches[i] = i;
+		}
+
+		m_numMatches = g_numApps;
+		m_numPrefixMatches = g_numApps;
+		m_query[0] = '\0';
+	}
+
+	void Filter::SetQuery(const char *query) {
+		// Adding to the end of the query can only ever remove matches
+		int queryLength = strlen(m_query);
+		bool refine = true;
+		for (int i = 0; i < queryLength; ++i) {
+			if (query[i] != m_query[i]) {
+				refine = false;
+				break;
+			}
+		}
+
+		if (!refine) {
+			Reset();
+		}
+
+		int length = 0;
+		while (query[length] != '\0' && length < MAX_QUERY_LENGTH) {
+			m_query[length] = query[length];
+			length++;
+		}
+		m_query[length] = '\0';
+
+		// The previous matches are in two runs, each in name order: names
+		// which started with the old query, and names which only contained
+		// it. The new prefix matches can only come from the first run.
+		const int *prefixRun = m_matches;
+		int prefixRunLength = m_numPrefixMatches;
+		const int *substringRun = m_matches + m_numPrefixMatches;
+		int substringRunLength = m_numMatches - m_numPrefixMatches;
+
+		int count = 0;
+		for (int i = 0; i < prefixRunLength; ++i) {
+			if (MatchApp(prefixRun[i], m_query) == MatchPrefix) {
+				m_scratch[count++] = prefixRun[i];
+			}
+		}
+		m_numPrefixMatches = count;
+
+		// The new substring matches can come from either run, so merge them
+		// to keep them in name order
+		MatchCursor demoted(prefixRun, prefixRunLength, m_query, MatchSubstring);
+		MatchCursor remaining(substringRun, substringRunLength, m_query, MatchSubstring);
+		while (!demoted.Done() || !remaining.Done()) {
+			if (remaining.Done() || (!demoted.Done() && demoted.Position() < remaining.Position())) {
+				m_scratch[count++] = demoted.Position();
+				demoted.Next();
+			} else {
+				m_scratch[count++] = remaining.Position();
+				remaining.Next();
+			}
+		}
+		m_numMatches = count;
+
+		int *matches = m_matches;
+		m_matches = m_scratch;
+		m_scratch = matches;
+	}
+
+	int Filter::GetMatch(int i) {
+		return g_appOrder[m_matches[i]];
+	}
+};
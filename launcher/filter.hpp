@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+
+namespace Apps {
+    /**
+     * The apps whose names contain a search query, in the order they're
+     * listed: apps whose names start with the query first, then the rest,
+     * each in name order.
+     *
+     * Matches are kept as positions in @ref g_appOrder, which makes it cheap
+     * to keep them in name order. When the query only has characters added
+     * to the end, just the previous matches are searched again.
+     */
+    class Filter {
+    public:
+        Filter();
+        ~Filter();
+
+        /**
+         * Matches every app. Must be called once @ref LoadAppInfo has found
+         * the apps, and before anything else.
+         */
+        void Reset();
+
+        /**
+         * Changes the query, updating the matches. Matching ignores the case
+         * of ASCII letters.
+         */
+        void SetQuery(const char *query);
+
+        const char *GetQuery() {
+            return m_query;
+        }
+
+        int NumMatches() {
+            return m_numMatches;
+        }
+
+        /**
+         * Returns the index into @ref g_apps of the @p i th match.
+         */
+        int GetMatch(int i);
+
+        static const int MAX_QUERY_LENGTH = 32;
+
+    private:
+        // Positions in g_appOrder. Matches whose names start with the query
+        // come first, m_numPrefixMatches of them.
+        int *m_matches;
+        int m_numMatches;
+        int m_numPrefixMatches;
+
+        // Where the next set of matches is built, before being swapped with
+        // m_matches
+        int *m_scratch;
+
+        char m_query[MAX_QUERY_LENGTH + 1];
+    };
+};
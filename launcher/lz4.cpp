@@ -0,0 +1,108 @@
+#include <sdk/os/mem.hpp>
+#include "lz4.hpp"
+
+namespace LZ4 {
+	/**
+	 * Reads the extra bytes of a literal/match length. Each byte is added to
+	 * the length, with a byte of 255 meaning another byte follows.
+	 *
+	 * @return False if the input ran out before the length was terminated.
+	 */
+	static bool ReadLength(const uint8_t **ip, const uint8_t *srcEnd, uint32_t *length) {
+		uint8_t b;
+		do {
+			if (*ip >= srcEnd) {
+				return false;
+			}
+
+			b = *(*ip)++;
+			*length += b;
+		} while (b == 255);
+
+		return true;
+	}
+
+	/**
+	 * Decompresses an LZ4 block (as produced by tools/hhk_compress.py).
+	 *
+	 * Matches are copied out of the data which has already been decompressed,
+	 * so the output is written straight to @p dest without needing any
+	 * intermediate buffer.
+	 *
+	 * @param[in] src The compressed block.
+	 * @param srcSize The size of the compressed block, in bytes.
+	 * @param[out] dest Where to write the decompressed data.
+	 * @param destSize The maximum number of bytes to write to @p dest.
+	 * @return The number of bytes written to @p dest, or -1 if the block is
+	 * malformed or doesn't fit in @p destSize bytes.
+	 */
+	int Decompress(
+		const uint8_t *src, uint32_t srcSize,
+		uint8_t *dest, uint32_t destSize
+	) {
+		const uint8_t *ip = src;
+		const uint8_t *srcEnd = src + srcSize;
+		uint8_t *op = dest;
+		uint8_t *destEnd = dest + destSize;
+
+		while (ip < srcEnd) {
+			uint8_t token = *ip++;
+
+			uint32_t literalLength = token >> 4;
+			if (literalLength == 15 && !ReadLength(&ip, srcEnd, &literalLength)) {
+				return -1;
+			}
+
+			if (
+				literalLength > static_cast<uint32_t>(srcEnd - ip) ||
+				literalLength > static_cast<uint32_t>(destEnd - op)
+			) {
+				return -1;
+			}
+
+			memcpy(op, ip, literalLength);
+			ip += literalLength;
+			op += literalLength;
+
+			// The last sequence only has literals
+			if (ip == srcEnd) {
+				break;
+			}
+
+			if (srcEnd - ip < 2) {
+				return -1;
+			}
+
+			uint32_t offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+
+			if (offset == 0 || offset > static_cast<uint32_t>(op - dest)) {
+				return -1;
+			}
+
+			uint32_t matchLength = token & 0xF;
+			if (matchLength == 15 && !ReadLength(&ip, srcEnd, &matchLength)) {
+				return -1;
+			}
+			matchLength += 4;
+
+			if (matchLength > static_cast<uint32_t>(destEnd - op)) {
+				return -1;
+			}
+
+			const uint8_t *match = op - offset;
+			if (offset >= matchLength) {
+				memcpy(op, match, matchLength);
+				op += matchLength;
+			} else {
+				// Overlapping match (i.e. a repeating pattern) - has to be
+				// copied a byte at a time so it picks up the bytes it writes.
+				for (uint32_t i = 0; i < matchLength; ++i) {
+					*op++ = *match++;
+				}
+			}
+		}
+
+		return op - dest;
+	}
+}
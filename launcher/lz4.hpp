@@ -0,0 +1,9 @@
+#pragma once
+#include <stdint.h>
+
+namespace LZ4 {
+    int Decompress(
+        const uint8_t *src, uint32_t srcSize,
+        uint8_t *dest, uint32_t destSize
+    );
+};
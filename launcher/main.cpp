@@ -1,9 +1,16 @@
+#include <appdef.hpp>
 #include <sdk/os/debug.hpp>
 #include <sdk/os/gui.hpp>
+#include <sdk/os/input.hpp>
 #include <sdk/os/lcd.hpp>
 #include <sdk/os/mem.hpp>
 #include <sdk/os/string.hpp>
 #include "apps.hpp"
+#include "filter.hpp"
+#include "timing.hpp"
+
+// Create this (empty) file to have launch timings appended to it
+#define TIMING_LOG_PATH "\\fls0\\hhk_timing.log"
 
 class Launcher : public GUIDialog {
 public:
@@ -12,50 +19,76 @@ public:
     Launcher() : GUIDialog(
         GUIDialog::Height95, GUIDialog::AlignTop,
         "Hollyhock Launcher",
-        GUIDialog::KeyboardStateNone
+        // For typing into the search box
+        GUIDialog::KeyboardStateABC
+    ), m_search(
+        GetLeftX() + 10, GetTopY() + 10, GetRightX() - GetLeftX() - 20,
+        Apps::Filter::MAX_QUERY_LENGTH, true
     ), m_appNames(
-        GetLeftX() + 10, GetTopY() + 10, GetRightX() - 10, GetBottomY() - 10,
+        GetLeftX() + 10, GetTopY() + 45, GetRightX() - 10, GetBottomY() - 10,
         APP_NAMES_EVENT_ID
     ), m_appInfo(
-        GetLeftX() + 10, GetTopY() + 90, GetRightX() - 10, GetBottomY() - 10,
+        GetLeftX() + 10, GetTopY() + 125, GetRightX() - 10, GetBottomY() - 10,
         // Since the app info string is immediately updated based on the
         // selected app, if no apps are found, this is the string that stays
         // displayed.
         // Use it to communicate to the user that we couldn't find any apps.
-        "No apps were found on your calculator.\n\nEnsure their .hhk files have been copied to the root directory of your calculator's flash."
+        "No apps were found on your calculator.\n\nEnsure their .hhk files have been copied to your calculator's flash, either in the root directory or in a folder."
     ), m_run(
-        GetLeftX() + 10, GetTopY() + 45, GetLeftX() + 10 + 100, GetTopY() + 45 + 35,
+        GetLeftX() + 10, GetTopY() + 80, GetLeftX() + 10 + 100, GetTopY() + 80 + 35,
         "Run", RUN_EVENT_ID
     ), m_close(
-        GetRightX() - 10 - 100, GetTopY() + 45, GetRightX() - 10, GetTopY() + 45 + 35,
+        GetRightX() - 10 - 100, GetTopY() + 80, GetRightX() - 10, GetTopY() + 80 + 35,
         "Close", CLOSE_EVENT_ID
+    ), m_previousPage(
+        GetLeftX() + 10 + 100 + 10, GetTopY() + 80, GetLeftX() + 10 + 100 + 10 + 35, GetTopY() + 80 + 35,
+        "<", PREVIOUS_PAGE_EVENT_ID
+    ), m_nextPage(
+        GetRightX() - 10 - 100 - 10 - 35, GetTopY() + 80, GetRightX() - 10 - 100 - 10, GetTopY() + 80 + 35,
+        ">", NEXT_PAGE_EVENT_ID
     ) {
+        Timing::Probe probe(Timing::PhaseLauncher);
+
         m_selectedApp = 0;
+        m_selectedRow = 0;
+        m_firstApp = 0;
+        m_dialogShown = false;
 
         Apps::LoadAppInfo();
-
-        for (int i = 0; i < Apps::g_numApps; ++i) {
-            struct Apps::AppInfo *app = &Apps::g_apps[i];
-
-            const char *name = app->path;
-
-            // first char of the name will not be \0 if a name was included.
-            if (app->name[0] != '\0') {  
-                name = app->name;
-            }
-
-            m_appNames.AddMenuItem(*(
-                new GUIDropDownMenuItem(
-                    name, i + 1,
-                    GUIDropDownMenuItem::FlagEnabled |
-                    GUIDropDownMenuItem::FlagTextAlignLeft
-                )
-            ));
+        m_filter.Reset();
+
+        // Only one page of apps is ever in the drop down menu. Each row's
+        // text lives in m_rowText, which is rewritten when the page changes,
+        // so the number of items the OS has to lay out doesn't depend on how
+        // many apps there are.
+        //
+        // That relies on the OS keeping the pointer it's given for each
+        // item's text and reading it again whenever the menu is drawn - the
+        // SDK has no way to remove items or change their text, so they can't
+        // be recreated for each page. Before paging, items pointed straight
+        // at the names in Apps::g_apps in the same way. If a firmware copies
+        // the text instead, the rows would go stale, but never the selection:
+        // it's worked out from the row number alone (see SelectRow), and the
+        // app info below the menu always names the app Run will start.
+        m_numRows = Apps::g_numApps < PAGE_SIZE ? Apps::g_numApps : PAGE_SIZE;
+        FillRows();
+
+        uint32_t menuStart = Timing::Now();
+        for (int i = 0; i < m_numRows; ++i) {
+            // The OS keeps its own item - the wrapper is only needed to add it
+            GUIDropDownMenuItem item(
+                m_rowText[i], i + 1,
+                GUIDropDownMenuItem::FlagEnabled |
+                GUIDropDownMenuItem::FlagTextAlignLeft
+            );
+            m_appNames.AddMenuItem(item);
         }
+        Timing::Record(Timing::PhaseBuildMenu, menuStart);
 
         m_appNames.SetScrollBarVisibility(
             GUIDropDownMenu::ScrollBarVisibleWhenRequired
         );
+        AddElement(m_search);
         AddElement(m_appNames);
 
         AddElement(m_appInfo);
@@ -67,24 +100,75 @@ public:
 
         AddElement(m_close);
 
+        if (Apps::g_numApps > PAGE_SIZE) {
+            AddElement(m_previousPage);
+            AddElement(m_nextPage);
+        }
+
         UpdateAppInfo();
     }
 
     virtual int OnEvent(GUIDialog_Wrapped *dialog, GUIDialog_OnEvent_Data *event) {
+        // The dialog isn't on screen until it starts getting events, so the
+        // first icon can't be drawn by the constructor - draw it now instead
+        if (!m_dialogShown) {
+            m_dialogShown = true;
+            Refresh();
+            DrawSelectedIcon();
+        }
+
+        // The text box doesn't have an event of its own, so check whether
+        // the search has changed whenever anything happens
+        const char *query = m_search.GetText();
+        if (query == nullptr) {
+            query = "";
+        }
+
+        if (strcmp(query, m_filter.GetQuery()) != 0) {
+            // The OS's highlight stays on the same row, and there's no way to
+            // move it, so m_selectedRow is kept in step with it rather than
+            // reset
+            m_filter.SetQuery(query);
+            ShowPage(0);
+        }
+
         if (event->GetEventID() == APP_NAMES_EVENT_ID && (event->type & 0xF) == 0xD) {
-            m_selectedApp = event->data - 1;
+            m_selectedRow = event->data - 1;
+            SelectRow();
 
             UpdateAppInfo();
 
             return 0;
         }
 
+        if (event->GetEventID() == PREVIOUS_PAGE_EVENT_ID) {
+            ShowPage(m_firstApp - PAGE_SIZE);
+            return 0;
+        }
+
+        if (event->GetEventID() == NEXT_PAGE_EVENT_ID) {
+            ShowPage(m_firstApp + PAGE_SIZE);
+            return 0;
+        }
+
         return GUIDialog::OnEvent(dialog, event);
     }
 
     void UpdateAppInfo() {
-        // If an invalid index is selected, don't do anything
-        if (m_selectedApp >= Apps::g_numApps) return;
+        // If an invalid index is selected, don't do anything (this includes
+        // there being no apps at all, which the initial text explains)
+        if (Apps::g_numApps == 0 || m_selectedApp >= Apps::g_numApps) return;
+
+        if (m_selectedApp < 0) {
+            m_appInfo.SetText(
+                m_filter.NumMatches() == 0 ?
+                "No apps match your search." :
+                "No app is selected. Choose one from the list above."
+            );
+            m_appInfo.Refresh();
+            Refresh();
+            return;
+        }
 
         struct Apps::AppInfo *app = &Apps::g_apps[m_selectedApp];
         bool hasName = app->name[0] != '\0';
@@ -95,41 +179,41 @@ public:
         memset(m_appInfoString, 0, sizeof(m_appInfoString));
 
         if (hasName) {
-            strcat(m_appInfoString, app->name);
+            AppendInfo(app->name);
         } else {
-            strcat(m_appInfoString, app->path);
+            AppendInfo(app->path);
         }
 
         if (hasAuthor || hasVersion) {
-            strcat(m_appInfoString, "\n(");
+            AppendInfo("\n(");
 
             if (hasVersion) {
-                strcat(m_appInfoString, "version ");
-                strcat(m_appInfoString, app->version);
+                AppendInfo("version ");
+                AppendInfo(app->version);
             }
 
             if (hasAuthor) {
                 if (hasVersion) {
-                    strcat(m_appInfoString, " by ");
+                    AppendInfo(" by ");
                 } else {
-                    strcat(m_appInfoString, "by ");
+                    AppendInfo("by ");
                 }
 
-                strcat(m_appInfoString, app->author);
+                AppendInfo(app->author);
             }
 
-            strcat(m_appInfoString, ")");
+            AppendInfo(")");
         }
 
         if (hasName) {
-            strcat(m_appInfoString, "\n(from ");
-            strcat(m_appInfoString, app->path);
-            strcat(m_appInfoString, ")");
+            AppendInfo("\n(from ");
+            AppendInfo(app->path);
+            AppendInfo(")");
         }
 
         if (hasDescription) {
-            strcat(m_appInfoString, "\n\n");
-            strcat(m_appInfoString, app->description);
+            AppendInfo("\n\n");
+            AppendInfo(app->description);
         }
 
         // App Name (version 1.0.0 by Meme King)
@@ -140,9 +224,116 @@ public:
         m_appInfo.SetText(m_appInfoString);
         m_appInfo.Refresh();
         Refresh();
+
+        if (m_dialogShown) {
+            DrawSelectedIcon();
+        }
     }
 
 private:
+    /**
+     * Draws the selected app's icon over the dialog. Refreshing the dialog
+     * draws over the last icon, so this has to be called after each refresh.
+     * Only the selected app's icon is ever decoded, in the gap between the
+     * page buttons.
+     */
+    void DrawSelectedIcon() {
+        if (m_selectedApp < 0 || m_selectedApp >= Apps::g_numApps) {
+            return;
+        }
+
+        int iconX = (GetLeftX() + GetRightX()) / 2 - HOLLYHOCK_ICON_MAX_SIZE / 2;
+        int iconY = GetTopY() + 80 + (35 - HOLLYHOCK_ICON_MAX_SIZE) / 2;
+        if (Apps::DrawIcon(m_selectedApp, iconX, iconY)) {
+            LCD_Refresh();
+        }
+    }
+
+    /**
+     * Appends text to m_appInfoString, cutting it short rather than
+     * overflowing the buffer - the path and description come straight from
+     * the app, so can be any length.
+     */
+    void AppendInfo(const char *text) {
+        unsigned int length = strlen(m_appInfoString);
+        while (*text != '\0' && length < sizeof(m_appInfoString) - 1) {
+            m_appInfoString[length++] = *text++;
+        }
+        m_appInfoString[length] = '\0';
+    }
+
+    /**
+     * Rewrites the text of each row in the drop down menu, for the page
+     * starting at m_firstApp. Rows past the last matching app are left
+     * blank.
+     */
+    void FillRows() {
+        for (int i = 0; i < m_numRows; ++i) {
+            char *text = m_rowText[i];
+            text[0] = '\0';
+
+            int match = m_firstApp + i;
+            if (match >= m_filter.NumMatches()) {
+                continue;
+            }
+
+            const char *name = Apps::DisplayName(&Apps::g_apps[m_filter.GetMatch(match)]);
+
+            int length = 0;
+            while (name[length] != '\0' && length < ROW_TEXT_LENGTH - 1) {
+                text[length] = name[length];
+                length++;
+            }
+            text[length] = '\0';
+        }
+    }
+
+    /**
+     * Points m_selectedApp at the app in the selected row. If the row is one
+     * of the blank ones on the last page, or nothing matches the search, no
+     * app is selected (-1) - the app that was may not match any more.
+     */
+    void SelectRow() {
+        int match = m_firstApp + m_selectedRow;
+        if (match < m_filter.NumMatches()) {
+            m_selectedApp = m_filter.GetMatch(match);
+        } else {
+            m_selectedApp = -1;
+        }
+    }
+
+    void ShowPage(int firstApp) {
+        // Page 0 always exists, even if nothing matches
+        if (firstApp < 0 || (firstApp > 0 && firstApp >= m_filter.NumMatches())) {
+            return;
+        }
+
+        m_firstApp = firstApp;
+        FillRows();
+        SelectRow();
+
+        // Redraws the whole dialog, including the drop down menu
+        UpdateAppInfo();
+    }
+
+    static const int PAGE_SIZE = 16;
+    static const int ROW_TEXT_LENGTH = 64;
+
+    // The apps matching what's typed in m_search, in the order they're
+    // listed
+    Apps::Filter m_filter;
+    GUITextBox m_search;
+
+    // Set once the dialog has had its first event, i.e. it's on screen
+    bool m_dialogShown;
+
+    // The first match on the current page, and the number of rows in the
+    // drop down menu (which never changes once it's been filled).
+    int m_firstApp;
+    int m_numRows;
+    int m_selectedRow;
+    char m_rowText[PAGE_SIZE][ROW_TEXT_LENGTH];
+
     const uint16_t APP_NAMES_EVENT_ID = 1;
     GUIDropDownMenu m_appNames;
 
@@ -160,14 +351,71 @@ private:
 
     const uint16_t CLOSE_EVENT_ID = GUIDialog::DialogResultCancel;
     GUIButton m_close;
+
+    const uint16_t PREVIOUS_PAGE_EVENT_ID = 2;
+    GUIButton m_previousPage;
+
+    const uint16_t NEXT_PAGE_EVENT_ID = 3;
+    GUIButton m_nextPage;
 };
 
+/**
+ * Checks for the key combo (Shift + EXE, held while the launcher opens) that
+ * shows the timing breakdown.
+ */
+bool WantsTimingBreakdown() {
+    InputScancode shift = ScancodeShift;
+    InputScancode exe = ScancodeEXE;
+    return Input_GetKeyState(&shift) && Input_GetKeyState(&exe);
+}
+
+/**
+ * Checks for the key (EXE on its own, held while the launcher opens) that
+ * runs the last app again without showing the launcher.
+ */
+bool WantsRelaunch() {
+    InputScancode shift = ScancodeShift;
+    InputScancode exe = ScancodeEXE;
+    return !Input_GetKeyState(&shift) && Input_GetKeyState(&exe);
+}
+
+/**
+ * Hands over to an app (if there is one), tidying up after the launcher
+ * first.
+ */
+void Launch(Apps::EntryPoint ep) {
+    Timing::AppendToLog(TIMING_LOG_PATH);
+    Timing::Shutdown();
+
+    if (ep != nullptr) {
+        ep();
+        Apps::FinishApp();
+    }
+}
+
 void main() {
-    Launcher launcher;
-    if (launcher.ShowDialog() == GUIDialog::DialogResultOK) {
-        Apps::EntryPoint ep = Apps::RunApp(launcher.m_selectedApp);
+    // The TMU is only borrowed from the OS when the timings will be used
+    bool showTimings = WantsTimingBreakdown();
+    Timing::Init(showTimings || Timing::LogEnabled(TIMING_LOG_PATH));
+
+    if (WantsRelaunch()) {
+        Apps::EntryPoint ep = Apps::RunLastApp();
         if (ep != nullptr) {
-            ep();
+            Launch(ep);
+            return;
         }
     }
+
+    Launcher launcher;
+    if (showTimings) {
+        Timing::ShowBreakdown();
+    }
+
+    Apps::EntryPoint ep = nullptr;
+    // Nothing is selected if no apps match the search
+    if (launcher.ShowDialog() == GUIDialog::DialogResultOK && launcher.m_selectedApp >= 0) {
+        ep = Apps::RunApp(launcher.m_selectedApp);
+    }
+
+    Launch(ep);
 }
@@ -0,0 +1,291 @@
+#include <sdk/os/debug.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/os/lcd.hpp>
+#include <sdk/os/mem.hpp>
+#include <sdk/os/string.hpp>
+#include "timing.hpp"
+
+#ifndef __sh__
+#include <time.h>
+#endif
+
+namespace Timing {
+    const char *const PHASE_NAMES[NumPhases] = {
+        "Launcher",
+        " LoadAppInfo",
+        "  Index load",
+        "  Find",
+        "  stat",
+        "  getAddr",
+        "  ELF check",
+        "  Metadata",
+        "  Index save",
+        "  Sort",
+        " Menu items",
+        "RunApp",
+        " Verify",
+        " Segments",
+        " Relocate"
+    };
+
+    struct PhaseTotal g_totals[NumPhases];
+    const struct TimerSource *g_timerSource;
+
+    uint32_t NullRead() {
+        return 0;
+    }
+
+    uint32_t NullToMicroseconds(uint32_t ticks) {
+        return ticks;
+    }
+
+    // Used when timings weren't asked for, so every phase reads as taking no
+    // time and no hardware is touched
+    const struct TimerSource NULL_TIMER_SOURCE = {
+        NullRead, NullToMicroseconds
+    };
+
+    bool g_defaultTimerStarted;
+
+#ifdef __sh__
+    // TMU channel 2 of the SH7305, used as a free-running down-counter.
+    //
+    // The OS owns the TMU, and nothing documents which channels it leaves
+    // free. Channel 2 isn't seen in use while the launcher runs, but that's
+    // an assumption - so it's only taken over when timings were asked for
+    // (see Init), and its registers are put back before any app runs.
+    volatile uint8_t *const TMU_TSTR = reinterpret_cast<volatile uint8_t *>(0xA4490004);
+    volatile uint32_t *const TMU_TCOR2 = reinterpret_cast<volatile uint32_t *>(0xA4490020);
+    volatile uint32_t *const TMU_TCNT2 = reinterpret_cast<volatile uint32_t *>(0xA4490024);
+    volatile uint16_t *const TMU_TCR2 = reinterpret_cast<volatile uint16_t *>(0xA4490028);
+
+    const uint8_t TMU_TSTR_STR2 = 1 << 2;
+    // TPSC = 0: count on P-phi / 4
+    const uint16_t TMU_TCR_PPHI_4 = 0;
+
+    // Assumes a 29.4912MHz peripheral clock. If that's off, the breakdown is
+    // still right relative to itself.
+    const uint32_t TMU_CLOCK_HZ = 29491200 / 4;
+    const uint32_t MICROSECONDS_PER_TICK_0_32 = (1000000ull << 32) / TMU_CLOCK_HZ;
+
+    uint8_t g_savedTSTR;
+    uint32_t g_savedTCOR2;
+    uint32_t g_savedTCNT2;
+    uint16_t g_savedTCR2;
+
+    uint32_t TMURead() {
+        // The TMU counts down, so flip it around
+        return ~*TMU_TCNT2;
+    }
+
+    uint32_t TMUToMicroseconds(uint32_t ticks) {
+        // Fixed-point, as the launcher has no runtime division
+        return (static_cast<uint64_t>(ticks) * MICROSECONDS_PER_TICK_0_32) >> 32;
+    }
+
+    const struct TimerSource TMU_TIMER_SOURCE = {
+        TMURead, TMUToMicroseconds
+    };
+
+    void StartDefaultTimer() {
+        g_savedTSTR = *TMU_TSTR;
+        g_savedTCOR2 = *TMU_TCOR2;
+        g_savedTCNT2 = *TMU_TCNT2;
+        g_savedTCR2 = *TMU_TCR2;
+
+        *TMU_TSTR = g_savedTSTR & ~TMU_TSTR_STR2;
+        *TMU_TCR2 = TMU_TCR_PPHI_4;
+        *TMU_TCOR2 = 0xFFFFFFFF;
+        *TMU_TCNT2 = 0xFFFFFFFF;
+        *TMU_TSTR = g_savedTSTR | TMU_TSTR_STR2;
+
+        g_timerSource = &TMU_TIMER_SOURCE;
+    }
+
+    void StopDefaultTimer() {
+        *TMU_TSTR = g_savedTSTR & ~TMU_TSTR_STR2;
+        *TMU_TCR2 = g_savedTCR2;
+        *TMU_TCOR2 = g_savedTCOR2;
+        *TMU_TCNT2 = g_savedTCNT2;
+        *TMU_TSTR = g_savedTSTR;
+    }
+#else
+    uint32_t ClockRead() {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return now.tv_sec * 1000000u + now.tv_nsec / 1000;
+    }
+
+    uint32_t ClockToMicroseconds(uint32_t ticks) {
+        return ticks;
+    }
+
+    const struct TimerSource CLOCK_TIMER_SOURCE = {
+        ClockRead, ClockToMicroseconds
+    };
+
+    void StartDefaultTimer() {
+        g_timerSource = &CLOCK_TIMER_SOURCE;
+    }
+
+    void StopDefaultTimer() {
+
+    }
+#endif
+
+    void Init(bool enabled) {
+        memset(g_totals, 0, sizeof(g_totals));
+
+        g_defaultTimerStarted = enabled;
+        if (enabled) {
+            StartDefaultTimer();
+        } else {
+            g_timerSource = &NULL_TIMER_SOURCE;
+        }
+    }
+
+    void Shutdown() {
+        if (g_defaultTimerStarted) {
+            StopDefaultTimer();
+            g_defaultTimerStarted = false;
+        }
+    }
+
+    bool LogEnabled(const char *path) {
+        struct stat fileStat;
+        return stat(path, &fileStat) >= 0;
+    }
+
+    void SetTimerSource(const struct TimerSource *source) {
+        g_timerSource = source;
+    }
+
+    uint32_t Now() {
+        return g_timerSource->read();
+    }
+
+    void Record(Phase phase, uint32_t startTicks) {
+        struct PhaseTotal *total = &g_totals[phase];
+        // unsigned subtraction copes with the counter wrapping around
+        total->ticks += Now() - startTicks;
+        total->count++;
+    }
+
+    const struct PhaseTotal *GetTotal(Phase phase) {
+        return &g_totals[phase];
+    }
+
+    const char *GetPhaseName(Phase phase) {
+        return PHASE_NAMES[phase];
+    }
+
+    uint32_t ToMicroseconds(uint32_t ticks) {
+        return g_timerSource->toMicroseconds(ticks);
+    }
+
+    /**
+     * Appends the decimal representation of @p value to @p str.
+     */
+    void AppendNumber(char *str, uint32_t value) {
+        char digits[11];
+        int i = sizeof(digits) - 1;
+        digits[i] = '\0';
+
+        do {
+            digits[--i] = '0' + value % 10;
+            value /= 10;
+        } while (value != 0);
+
+        strcat(str, &digits[i]);
+    }
+
+    /**
+     * Appends @p text to @p str, padded with spaces to @p width characters -
+     * before the text if @p alignRight is true, and after it otherwise. The
+     * OS's printf isn't relied on to support field widths.
+     */
+    void AppendColumn(char *str, const char *text, int width, bool alignRight) {
+        int padding = width - static_cast<int>(strlen(text));
+        char *end = str + strlen(str);
+
+        if (!alignRight) {
+            strcat(end, text);
+            end += strlen(end);
+        }
+
+        for (; padding > 0; --padding) {
+            *end++ = ' ';
+        }
+        *end = '\0';
+
+        if (alignRight) {
+            strcat(end, text);
+        }
+    }
+
+    /**
+     * Lays out a row of the breakdown table in @p line: the phase, its time
+     * and its count.
+     */
+    void FormatRow(char *line, const char *phase, const char *time, const char *count) {
+        line[0] = '\0';
+        AppendColumn(line, phase, 14, false);
+        strcat(line, " ");
+        AppendColumn(line, time, 10, true);
+        strcat(line, " ");
+        AppendColumn(line, count, 6, true);
+    }
+
+    void ShowBreakdown() {
+        const int LINE_HEIGHT = 12;
+
+        LCD_ClearScreen();
+
+        char line[48];
+        FormatRow(line, "Phase", "us", "count");
+        Debug_Printf(0, 0, true, 0, "%s", line);
+
+        for (int i = 0; i < NumPhases; ++i) {
+            Phase phase = static_cast<Phase>(i);
+            const struct PhaseTotal *total = GetTotal(phase);
+
+            char time[11] = "";
+            char count[11] = "";
+            AppendNumber(time, ToMicroseconds(total->ticks));
+            AppendNumber(count, total->count);
+
+            FormatRow(line, GetPhaseName(phase), time, count);
+            Debug_Printf(0, (i + 1) * LINE_HEIGHT, false, 0, "%s", line);
+        }
+
+        LCD_Refresh();
+        Debug_WaitKey();
+    }
+
+    void AppendToLog(const char *path) {
+        // Without OPEN_CREATE, this fails if logging hasn't been turned on
+        int fd = open(path, OPEN_WRITE | OPEN_APPEND);
+        if (fd < 0) {
+            return;
+        }
+
+        char line[64];
+        for (int i = 0; i < NumPhases; ++i) {
+            Phase phase = static_cast<Phase>(i);
+            const struct PhaseTotal *total = GetTotal(phase);
+
+            line[0] = '\0';
+            strcat(line, GetPhaseName(phase));
+            strcat(line, ": ");
+            AppendNumber(line, ToMicroseconds(total->ticks));
+            strcat(line, "us x");
+            AppendNumber(line, total->count);
+            strcat(line, "\n");
+
+            write(fd, line, strlen(line));
+        }
+
+        write(fd, "\n", 1);
+        close(fd);
+    }
+}
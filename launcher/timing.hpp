@@ -0,0 +1,120 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Lightweight timing probes for the phases of starting the launcher and
+ * launching an app.
+ *
+ * Each phase accumulates the total time spent in it and how many times it
+ * was entered. Phases nest - the time of an inner phase is also counted in
+ * the phase around it.
+ *
+ * Like the rest of the launcher, nothing here has a constructor that runs
+ * at startup, so @ref Init must be called before any probes are used.
+ */
+namespace Timing {
+    enum Phase {
+        PhaseLauncher,
+        PhaseLoadAppInfo,
+        PhaseIndexLoad,
+        PhaseFind,
+        PhaseStat,
+        PhaseGetAddr,
+        PhaseValidateELF,
+        PhaseParseMeta,
+        PhaseIndexSave,
+        PhaseSort,
+        PhaseBuildMenu,
+        PhaseRunApp,
+        PhaseVerify,
+        PhaseLoadSegments,
+        PhaseRelocate,
+
+        NumPhases
+    };
+
+    /**
+     * A free-running counter to take timings from.
+     */
+    struct TimerSource {
+        /**
+         * Returns the current value of the counter. It must count upwards,
+         * and may wrap around at 2^32.
+         */
+        uint32_t (*read)();
+
+        /**
+         * Converts a number of ticks of the counter into microseconds.
+         */
+        uint32_t (*toMicroseconds)(uint32_t ticks);
+    };
+
+    struct PhaseTotal {
+        uint32_t ticks;
+        uint32_t count;
+    };
+
+    /**
+     * Resets all phase totals and starts the default timer source - a TMU
+     * channel on the calculator, or @c clock_gettime on a host build.
+     *
+     * @param enabled If false, no timer is started (so the TMU is left
+     * alone), and every phase records a time of 0.
+     */
+    void Init(bool enabled);
+
+    /**
+     * Stops the timer started by @ref Init, putting the TMU back the way it
+     * was. Must be called before handing control to an app.
+     */
+    void Shutdown();
+
+    /**
+     * Checks whether logging to @p path is turned on (see
+     * @ref AppendToLog).
+     */
+    bool LogEnabled(const char *path);
+
+    /**
+     * Replaces the timer the probes read from. Totals already recorded are
+     * kept, so this should be called straight after @ref Init.
+     */
+    void SetTimerSource(const struct TimerSource *source);
+
+    uint32_t Now();
+    void Record(Phase phase, uint32_t startTicks);
+
+    const struct PhaseTotal *GetTotal(Phase phase);
+    const char *GetPhaseName(Phase phase);
+    uint32_t ToMicroseconds(uint32_t ticks);
+
+    /**
+     * Draws a table of the phase totals over the screen, and waits for a key
+     * press.
+     */
+    void ShowBreakdown();
+
+    /**
+     * Appends the phase totals to @p path, if that file exists. Creating the
+     * (empty) file is what turns logging on.
+     */
+    void AppendToLog(const char *path);
+
+    /**
+     * Times the enclosing scope, adding it to a phase's total when it ends.
+     */
+    class Probe {
+    public:
+        Probe(Phase phase) : m_phase(phase), m_start(Now()) {
+
+        }
+
+        ~Probe() {
+            Record(m_phase, m_start);
+        }
+
+    private:
+        Phase m_phase;
+        uint32_t m_start;
+    };
+}
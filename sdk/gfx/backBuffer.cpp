@@ -0,0 +1,36 @@
+#include <sdk/gfx/backBuffer.hpp>
+#include <sdk/gfx/copy.hpp>
+#include <sdk/os/mem.hpp>
+
+bool GFX_CreateBackBuffer(struct GFX_BackBuffer *buffer) {
+	GFX_GetVRAMSurface(&buffer->vram);
+
+	int width = buffer->vram.width;
+	int height = buffer->vram.height;
+
+	uint16_t *pixels = static_cast<uint16_t *>(malloc(width * height * sizeof(uint16_t)));
+	if (pixels == nullptr) {
+		return false;
+	}
+
+	GFX_InitSurface(&buffer->surface, pixels, width, height);
+	GFX_InitDirtyRegion(&buffer->dirty, width, height);
+
+	struct GFX_Rect all = {0, 0, width, height};
+	GFX_CopyRect(&buffer->surface, &buffer->vram, &all);
+
+	return true;
+}
+
+void GFX_DestroyBackBuffer(struct GFX_BackBuffer *buffer) {
+	free(buffer->surface.pixels);
+	buffer->surface.pixels = nullptr;
+}
+
+void GFX_Present(struct GFX_BackBuffer *buffer) {
+	for (int i = 0; i < buffer->dirty.numRects; ++i) {
+		GFX_CopyRect(&buffer->vram, &buffer->surface, &buffer->dirty.rects[i]);
+	}
+
+	GFX_RefreshIfDirty(&buffer->dirty);
+}
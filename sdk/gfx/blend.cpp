@@ -0,0 +1,228 @@
+#include <sdk/gfx/blend.hpp>
+
+// Two pixels, loaded and stored together. may_alias, as it's used to access
+// arrays of uint16_t.
+typedef uint32_t __attribute__((__may_alias__)) PixelPair;
+
+/*
+ * A pair of pixels is split into two sets of fields, each with enough space
+ * above every field to multiply it by up to 32:
+ *
+ *   FIELDS_A: [ - G - ][ R - B ] = the green of one pixel, red and blue of
+ *                                   the other
+ *   FIELDS_B: [ R - B ][ - G - ], shifted right by 5
+ *
+ * Neither set has two fields closer than 5 bits apart, or any field within
+ * 5 bits of the top, so nothing carries into its neighbour.
+ */
+const uint32_t FIELDS_A = 0x07E0F81F;
+const uint32_t FIELDS_B = 0x07C0F83F;
+
+// The channels of both pixels of a pair, shifted down to bit 0
+const uint32_t CHANNEL_5 = 0x001F001F;
+const uint32_t CHANNEL_6 = 0x003F003F;
+
+static int ClampAlpha(int alpha) {
+	if (alpha < 0) {
+		return 0;
+	}
+
+	return alpha > GFX_ALPHA_OPAQUE ? GFX_ALPHA_OPAQUE : alpha;
+}
+
+/**
+ * Blends a pair of pixels into another, with @p colorA and @p colorB already
+ * multiplied by alpha, and @p inverseAlpha being <tt>32 - alpha</tt>.
+ */
+static inline uint32_t BlendPair(uint32_t pair, uint32_t colorA, uint32_t colorB, uint32_t inverseAlpha) {
+	uint32_t a = (((pair & FIELDS_A) * inverseAlpha + colorA) >> 5) & FIELDS_A;
+	uint32_t b = (((pair >> 5) & FIELDS_B) * inverseAlpha + colorB) & (FIELDS_B << 5);
+	return a | b;
+}
+
+/**
+ * Blends a pair of pixels towards one color.
+ */
+struct BlendColorKernel {
+	uint32_t colorA, colorB, inverseAlpha;
+
+	BlendColorKernel(uint16_t color, int alpha) {
+		uint32_t pair = color * 0x00010001u;
+		colorA = (pair & FIELDS_A) * alpha;
+		colorB = ((pair >> 5) & FIELDS_B) * alpha;
+		inverseAlpha = GFX_ALPHA_OPAQUE - alpha;
+	}
+
+	uint32_t operator()(uint32_t pair) const {
+		return BlendPair(pair, colorA, colorB, inverseAlpha);
+	}
+};
+
+struct InvertKernel {
+	uint32_t operator()(uint32_t pair) const {
+		return ~pair;
+	}
+};
+
+/**
+ * Takes a weighted sum of the channels, scaled up to 6 bits, and uses it for
+ * all three. The weights add up so that white stays white.
+ */
+struct GrayscaleKernel {
+	uint32_t operator()(uint32_t pair) const {
+		uint32_t r = (pair >> 11) & CHANNEL_5;
+		uint32_t g = (pair >> 5) & CHANNEL_6;
+		uint32_t b = pair & CHANNEL_5;
+
+		uint32_t gray = ((r * 155 + g * 151 + b * 59) >> 8) & CHANNEL_6;
+		return ((gray >> 1) & CHANNEL_5) * 0x0801 | (gray << 5);
+	}
+};
+
+struct TintKernel {
+	uint32_t scaleR, scaleG, scaleB;
+
+	TintKernel(uint16_t color) {
+		scaleR = ((color >> 11) & 0x1F) + 1;
+		scaleG = ((color >> 5) & 0x3F) + 1;
+		scaleB = (color & 0x1F) + 1;
+	}
+
+	uint32_t operator()(uint32_t pair) const {
+		uint32_t r = ((((pair >> 11) & CHANNEL_5) * scaleR) >> 5) & CHANNEL_5;
+		uint32_t g = ((((pair >> 5) & CHANNEL_6) * scaleG) >> 6) & CHANNEL_6;
+		uint32_t b = (((pair & CHANNEL_5) * scaleB) >> 5) & CHANNEL_5;
+		return (r << 11) | (g << 5) | b;
+	}
+};
+
+/**
+ * Runs @p kernel over @p count pixels, a pair at a time. A pixel on its own
+ * at either end is run as a pair of two copies of itself.
+ */
+template<typename Kernel>
+static void TransformSpan(uint16_t *pixels, int count, const Kernel &kernel) {
+	if (count <= 0) {
+		return;
+	}
+
+	// Pairs have to be 4-byte aligned
+	if ((reinterpret_cast<uintptr_t>(pixels) & 2) != 0) {
+		*pixels = kernel(*pixels * 0x00010001u);
+		pixels++;
+		count--;
+	}
+
+	PixelPair *pairs = reinterpret_cast<PixelPair *>(pixels);
+	int numPairs = count >> 1;
+
+	while (numPairs >= 2) {
+		uint32_t a = kernel(pairs[0]);
+		uint32_t b = kernel(pairs[1]);
+		pairs[0] = a;
+		pairs[1] = b;
+		pairs += 2;
+		numPairs -= 2;
+	}
+
+	if (numPairs > 0) {
+		*pairs = kernel(*pairs);
+		pairs++;
+	}
+
+	if ((count & 1) != 0) {
+		uint16_t *pixel = reinterpret_cast<uint16_t *>(pairs);
+		*pixel = kernel(*pixel * 0x00010001u);
+	}
+}
+
+uint16_t GFX_BlendColor(uint16_t background, uint16_t color, int alpha) {
+	BlendColorKernel kernel(color, ClampAlpha(alpha));
+	return kernel(background * 0x00010001u);
+}
+
+void GFX_BlendSpan(uint16_t *destination, const uint16_t *source, int count, int alpha) {
+	if (count <= 0) {
+		return;
+	}
+
+	alpha = ClampAlpha(alpha);
+	uint32_t inverseAlpha = GFX_ALPHA_OPAQUE - alpha;
+
+	// Pairs can only be used if both rows are on a 4-byte boundary at the
+	// same point
+	uintptr_t misalignment = reinterpret_cast<uintptr_t>(destination) ^ reinterpret_cast<uintptr_t>(source);
+	if ((misalignment & 2) != 0) {
+		for (int i = 0; i < count; ++i) {
+			destination[i] = GFX_BlendColor(destination[i], source[i], alpha);
+		}
+
+		return;
+	}
+
+	if ((reinterpret_cast<uintptr_t>(destination) & 2) != 0) {
+		*destination = GFX_BlendColor(*destination, *source, alpha);
+		destination++;
+		source++;
+		count--;
+	}
+
+	PixelPair *destinationPairs = reinterpret_cast<PixelPair *>(destination);
+	const PixelPair *sourcePairs = reinterpret_cast<const PixelPair *>(source);
+
+	for (int i = count >> 1; i > 0; --i) {
+		uint32_t pair = *sourcePairs++;
+		uint32_t colorA = (pair & FIELDS_A) * alpha;
+		uint32_t colorB = ((pair >> 5) & FIELDS_B) * alpha;
+
+		*destinationPairs = BlendPair(*destinationPairs, colorA, colorB, inverseAlpha);
+		destinationPairs++;
+	}
+
+	if ((count & 1) != 0) {
+		uint16_t *pixel = reinterpret_cast<uint16_t *>(destinationPairs);
+		*pixel = GFX_BlendColor(*pixel, *reinterpret_cast<const uint16_t *>(sourcePairs), alpha);
+	}
+}
+
+void GFX_BlendColorSpan(uint16_t *pixels, int count, uint16_t color, int alpha) {
+	TransformSpan(pixels, count, BlendColorKernel(color, ClampAlpha(alpha)));
+}
+
+void GFX_DarkenSpan(uint16_t *pixels, int count, int alpha) {
+	GFX_BlendColorSpan(pixels, count, 0x0000, alpha);
+}
+
+void GFX_LightenSpan(uint16_t *pixels, int count, int alpha) {
+	GFX_BlendColorSpan(pixels, count, 0xFFFF, alpha);
+}
+
+void GFX_InvertSpan(uint16_t *pixels, int count) {
+	TransformSpan(pixels, count, InvertKernel());
+}
+
+void GFX_GrayscaleSpan(uint16_t *pixels, int count) {
+	TransformSpan(pixels, count, GrayscaleKernel());
+}
+
+void GFX_TintSpan(uint16_t *pixels, int count, uint16_t color) {
+	TransformSpan(pixels, count, TintKernel(color));
+}
+
+void GFX_BlendRect(
+	struct GFX_Surface *surface, int x, int y, int width, int height,
+	uint16_t color, int alpha
+) {
+	struct GFX_Rect rect = {x, y, width, height};
+	if (!GFX_ClipRect(surface, &rect)) {
+		return;
+	}
+
+	BlendColorKernel kernel(color, ClampAlpha(alpha));
+	uint16_t *row = &surface->pixels[rect.y * surface->stride + rect.x];
+
+	for (int i = 0; i < rect.height; ++i) {
+		TransformSpan(row, rect.width, kernel);
+		row += surface->stride;
+	}
+}
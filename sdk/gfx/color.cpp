@@ -0,0 +1,12 @@
+#include <sdk/gfx/color.hpp>
+
+const uint16_t GFX_PALETTE_COLORS[8] = {
+	RGB_TO_RGB565(0x00, 0x00, 0x00), // black
+	RGB_TO_RGB565(0x00, 0x00, 0x1F), // blue
+	RGB_TO_RGB565(0x00, 0x3F, 0x00), // green
+	RGB_TO_RGB565(0x00, 0x3F, 0x1F), // cyan
+	RGB_TO_RGB565(0x1F, 0x00, 0x00), // red
+	RGB_TO_RGB565(0x1F, 0x00, 0x1F), // magenta
+	RGB_TO_RGB565(0x1F, 0x3F, 0x00), // yellow
+	RGB_TO_RGB565(0x1F, 0x3F, 0x1F)  // white
+};
@@ -0,0 +1,104 @@
+#include <sdk/gfx/copy.hpp>
+
+// Two pixels, copied with one load and one store. may_alias, as it's used to
+// access arrays of uint16_t.
+typedef uint32_t __attribute__((__may_alias__)) PixelPair;
+
+void GFX_CopySpan(uint16_t *destination, const uint16_t *source, int count) {
+	if (count <= 0) {
+		return;
+	}
+
+	// Pairs can only be used if both rows are on a 4-byte boundary at the
+	// same point
+	uintptr_t misalignment = reinterpret_cast<uintptr_t>(destination) ^ reinterpret_cast<uintptr_t>(source);
+	if ((misalignment & 2) != 0) {
+		for (int i = 0; i < count; ++i) {
+			destination[i] = source[i];
+		}
+
+		return;
+	}
+
+	if ((reinterpret_cast<uintptr_t>(destination) & 2) != 0) {
+		*destination++ = *source++;
+		count--;
+	}
+
+	PixelPair *destinationPairs = reinterpret_cast<PixelPair *>(destination);
+	const PixelPair *sourcePairs = reinterpret_cast<const PixelPair *>(source);
+	int numPairs = count >> 1;
+
+	// Eight pixels per iteration
+	while (numPairs >= 4) {
+		PixelPair a = sourcePairs[0];
+		PixelPair b = sourcePairs[1];
+		PixelPair c = sourcePairs[2];
+		PixelPair d = sourcePairs[3];
+		destinationPairs[0] = a;
+		destinationPairs[1] = b;
+		destinationPairs[2] = c;
+		destinationPairs[3] = d;
+		destinationPairs += 4;
+		sourcePairs += 4;
+		numPairs -= 4;
+	}
+
+	while (numPairs > 0) {
+		*destinationPairs++ = *sourcePairs++;
+		numPairs--;
+	}
+
+	if ((count & 1) != 0) {
+		*reinterpret_cast<uint16_t *>(destinationPairs) = *reinterpret_cast<const uint16_t *>(sourcePairs);
+	}
+}
+
+void GFX_CopyRect(
+	struct GFX_Surface *destination, const struct GFX_Surface *source,
+	const struct GFX_Rect *rect
+) {
+	int x = rect->x;
+	int y = rect->y;
+	int width = rect->width;
+	int height = rect->height;
+
+	if (x < 0) {
+		width += x;
+		x = 0;
+	}
+
+	if (y < 0) {
+		height += y;
+		y = 0;
+	}
+
+	int maxWidth = destination->width < source->width ? destination->width : source->width;
+	if (width > maxWidth - x) {
+		width = maxWidth - x;
+	}
+
+	int maxHeight = destination->height < source->height ? destination->height : source->height;
+	if (height > maxHeight - y) {
+		height = maxHeight - y;
+	}
+
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	uint16_t *destinationRow = &destination->pixels[y * destination->stride + x];
+	const uint16_t *sourceRow = &source->pixels[y * source->stride + x];
+
+	// Whole rows with no gap between them are one long span
+	if (width == destination->stride && width == source->stride) {
+		GFX_CopySpan(destinationRow, sourceRow, width * height);
+		return;
+	}
+
+	for (int i = 0; i < height; ++i) {
+		GFX_CopySpan(destinationRow, sourceRow, width);
+		destinationRow += destination->stride;
+		sourceRow += source->stride;
+	}
+}
@@ -0,0 +1,133 @@
+#include <sdk/gfx/dirty.hpp>
+
+/**
+ * Checks whether two rectangles overlap, or share part of an edge or corner.
+ * Merging those doesn't add any pixels which aren't already dirty, other
+ * than to square off the corners.
+ */
+static bool Touches(const struct GFX_Rect *a, const struct GFX_Rect *b) {
+	return a->x <= b->x + b->width && b->x <= a->x + a->width &&
+		a->y <= b->y + b->height && b->y <= a->y + a->height;
+}
+
+/**
+ * Grows @p rect to also cover @p other.
+ */
+static void Union(struct GFX_Rect *rect, const struct GFX_Rect *other) {
+	int right = rect->x + rect->width;
+	int bottom = rect->y + rect->height;
+	int otherRight = other->x + other->width;
+	int otherBottom = other->y + other->height;
+
+	if (other->x < rect->x) {
+		rect->x = other->x;
+	}
+
+	if (other->y < rect->y) {
+		rect->y = other->y;
+	}
+
+	rect->width = (otherRight > right ? otherRight : right) - rect->x;
+	rect->height = (otherBottom > bottom ? otherBottom : bottom) - rect->y;
+}
+
+/**
+ * Finds the rectangle in the region which grows the least if it's merged with
+ * @p rect.
+ */
+static int CheapestMerge(const struct GFX_DirtyRegion *region, const struct GFX_Rect *rect) {
+	int best = 0;
+	int bestGrowth = 0;
+
+	for (int i = 0; i < region->numRects; ++i) {
+		struct GFX_Rect merged = region->rects[i];
+		Union(&merged, rect);
+
+		int growth = merged.width * merged.height -
+			region->rects[i].width * region->rects[i].height;
+		if (i == 0 || growth < bestGrowth) {
+			best = i;
+			bestGrowth = growth;
+		}
+	}
+
+	return best;
+}
+
+void GFX_InitDirtyRegion(struct GFX_DirtyRegion *region, int width, int height) {
+	region->numRects = 0;
+	region->width = width;
+	region->height = height;
+}
+
+void GFX_MarkDirty(struct GFX_DirtyRegion *region, int x, int y, int width, int height) {
+	if (x < 0) {
+		width += x;
+		x = 0;
+	}
+
+	if (y < 0) {
+		height += y;
+		y = 0;
+	}
+
+	if (width > region->width - x) {
+		width = region->width - x;
+	}
+
+	if (height > region->height - y) {
+		height = region->height - y;
+	}
+
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	struct GFX_Rect rect = {x, y, width, height};
+
+	// Take in every rectangle this touches. Each one taken in makes the new
+	// rectangle bigger, so it may now touch ones it didn't before - keep going
+	// until it doesn't touch any.
+	for (;;) {
+		int i;
+		for (i = 0; i < region->numRects; ++i) {
+			if (Touches(&region->rects[i], &rect)) {
+				break;
+			}
+		}
+
+		if (i == region->numRects) {
+			if (region->numRects < GFX_DIRTY_MAX_RECTS) {
+				break;
+			}
+
+			i = CheapestMerge(region, &rect);
+		}
+
+		Union(&rect, &region->rects[i]);
+		region->rects[i] = region->rects[--region->numRects];
+	}
+
+	region->rects[region->numRects++] = rect;
+}
+
+void GFX_MarkAllDirty(struct GFX_DirtyRegion *region) {
+	region->rects[0].x = 0;
+	region->rects[0].y = 0;
+	region->rects[0].width = region->width;
+	region->rects[0].height = region->height;
+	region->numRects = 1;
+}
+
+void GFX_ClearDirty(struct GFX_DirtyRegion *region) {
+	region->numRects = 0;
+}
+
+int GFX_GetDirtyArea(const struct GFX_DirtyRegion *region) {
+	int area = 0;
+	for (int i = 0; i < region->numRects; ++i) {
+		area += region->rects[i].width * region->rects[i].height;
+	}
+
+	return area;
+}
@@ -0,0 +1,192 @@
+#include <sdk/gfx/ellipse.hpp>
+#include <sdk/gfx/fill.hpp>
+
+/**
+ * Sets one pixel, if it's inside the surface's clip rectangle.
+ */
+static inline void Plot(struct GFX_Surface *surface, int x, int y, uint16_t color) {
+	const struct GFX_Rect *clip = &surface->clip;
+	if (x < clip->x || x >= clip->x + clip->width || y < clip->y || y >= clip->y + clip->height) {
+		return;
+	}
+
+	surface->pixels[y * surface->stride + x] = color;
+}
+
+/**
+ * Sets the pixels at @p x, @p y from the center in each quadrant - which are
+ * the same pixels, if either is 0.
+ */
+static void Plot4(
+	struct GFX_Surface *surface, int centerX, int centerY, int x, int y,
+	uint16_t color
+) {
+	Plot(surface, centerX + x, centerY + y, color);
+
+	if (x != 0) {
+		Plot(surface, centerX - x, centerY + y, color);
+	}
+
+	if (y != 0) {
+		Plot(surface, centerX + x, centerY - y, color);
+
+		if (x != 0) {
+			Plot(surface, centerX - x, centerY - y, color);
+		}
+	}
+}
+
+/**
+ * Fills the rows @p y above and below the center, from @p halfWidth left of
+ * the center to @p halfWidth right of it.
+ */
+static void Span2(
+	struct GFX_Surface *surface, int centerX, int centerY, int y,
+	int halfWidth, uint16_t color
+) {
+	GFX_HLine(surface, centerX - halfWidth, centerY + y, 2 * halfWidth + 1, color);
+
+	if (y != 0) {
+		GFX_HLine(surface, centerX - halfWidth, centerY - y, 2 * halfWidth + 1, color);
+	}
+}
+
+void GFX_DrawCircle(
+	struct GFX_Surface *surface, int centerX, int centerY, int radius,
+	uint16_t color
+) {
+	if (radius < 0) {
+		return;
+	}
+
+	// Steps through one eighth of the circle, from the right going down,
+	// until the outline is at 45 degrees. The rest is mirrored.
+	int x = radius;
+	int y = 0;
+	int error = 1 - radius;
+
+	while (x >= y) {
+		Plot4(surface, centerX, centerY, x, y, color);
+		if (x != y) {
+			Plot4(surface, centerX, centerY, y, x, color);
+		}
+
+		y++;
+		if (error < 0) {
+			error += 2 * y + 1;
+		} else {
+			x--;
+			error += 2 * (y - x) + 1;
+		}
+	}
+}
+
+void GFX_FillCircle(
+	struct GFX_Surface *surface, int centerX, int centerY, int radius,
+	uint16_t color
+) {
+	if (radius < 0) {
+		return;
+	}
+
+	// The same steps as GFX_DrawCircle. Each step is on a new row of the
+	// steep part of the outline (near the top and bottom), so those rows are
+	// filled as they're reached. Rows of the shallow part (near the middle)
+	// are filled once the step leaves them, as that's when they're widest.
+	// They never overlap, so each row is filled once.
+	int x = radius;
+	int y = 0;
+	int error = 1 - radius;
+
+	while (x >= y) {
+		Span2(surface, centerX, centerY, y, x, color);
+
+		y++;
+		if (error < 0) {
+			error += 2 * y + 1;
+		} else {
+			if (x >= y) {
+				Span2(surface, centerX, centerY, x, y - 1, color);
+			}
+
+			x--;
+			error += 2 * (y - x) + 1;
+		}
+	}
+}
+
+/**
+ * Steps around a quarter of an ellipse (the method from Alois Zingl's "A
+ * Rasterizing Algorithm for Drawing Curves"), mirroring it into the other
+ * quarters. It either draws the outline, or fills each row the first time
+ * it's reached, which is when it's widest.
+ */
+static void Ellipse(
+	struct GFX_Surface *surface, int centerX, int centerY,
+	int radiusX, int radiusY, uint16_t color, bool fill
+) {
+	if (radiusX < 0 || radiusY < 0) {
+		return;
+	}
+
+	// From the left end of the ellipse, going down to the bottom. The errors
+	// can be far bigger than an int, but only additions are needed per step.
+	int x = -radiusX;
+	int y = 0;
+
+	int64_t xStep = static_cast<int64_t>(radiusY) * (2 * radiusY);
+	int64_t yStep = static_cast<int64_t>(radiusX) * (2 * radiusX);
+	int64_t dx = static_cast<int64_t>(1 - 2 * radiusX) * (radiusY * radiusY);
+	int64_t dy = static_cast<int64_t>(radiusX) * radiusX;
+	int64_t error = dx + dy;
+
+	bool newRow = true;
+	do {
+		if (!fill) {
+			Plot4(surface, centerX, centerY, x, y, color);
+		} else if (newRow) {
+			Span2(surface, centerX, centerY, y, -x, color);
+		}
+
+		int64_t error2 = 2 * error;
+		newRow = false;
+
+		if (error2 >= dx) {
+			x++;
+			dx += xStep;
+			error += dx;
+		}
+
+		if (error2 <= dy) {
+			y++;
+			dy += yStep;
+			error += dy;
+			newRow = true;
+		}
+	} while (x <= 0);
+
+	// Very flat ellipses finish before reaching the bottom
+	while (y < radiusY) {
+		y++;
+
+		if (fill) {
+			Span2(surface, centerX, centerY, y, 0, color);
+		} else {
+			Plot4(surface, centerX, centerY, 0, y, color);
+		}
+	}
+}
+
+void GFX_DrawEllipse(
+	struct GFX_Surface *surface, int centerX, int centerY,
+	int radiusX, int radiusY, uint16_t color
+) {
+	Ellipse(surface, centerX, centerY, radiusX, radiusY, color, false);
+}
+
+void GFX_FillEllipse(
+	struct GFX_Surface *surface, int centerX, int centerY,
+	int radiusX, int radiusY, uint16_t color
+) {
+	Ellipse(surface, centerX, centerY, radiusX, radiusY, color, true);
+}
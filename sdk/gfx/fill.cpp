@@ -0,0 +1,85 @@
+#include <sdk/gfx/fill.hpp>
+
+// Two pixels, written with one store. may_alias, as it's used to write to
+// arrays of uint16_t.
+typedef uint32_t __attribute__((__may_alias__)) PixelPair;
+
+void GFX_FillSpan(uint16_t *pixels, int count, uint16_t color) {
+	if (count <= 0) {
+		return;
+	}
+
+	// Pairs have to be 4-byte aligned
+	if ((reinterpret_cast<uintptr_t>(pixels) & 2) != 0) {
+		*pixels++ = color;
+		count--;
+	}
+
+	// Both halves are the same color, so byte order doesn't matter
+	PixelPair pair = color | (static_cast<uint32_t>(color) << 16);
+	PixelPair *pairs = reinterpret_cast<PixelPair *>(pixels);
+	int numPairs = count >> 1;
+
+	// Eight pixels per iteration
+	while (numPairs >= 4) {
+		pairs[0] = pair;
+		pairs[1] = pair;
+		pairs[2] = pair;
+		pairs[3] = pair;
+		pairs += 4;
+		numPairs -= 4;
+	}
+
+	while (numPairs > 0) {
+		*pairs++ = pair;
+		numPairs--;
+	}
+
+	if ((count & 1) != 0) {
+		*reinterpret_cast<uint16_t *>(pairs) = color;
+	}
+}
+
+void GFX_HLine(struct GFX_Surface *surface, int x, int y, int length, uint16_t color) {
+	GFX_FillRect(surface, x, y, length, 1, color);
+}
+
+void GFX_VLine(struct GFX_Surface *surface, int x, int y, int length, uint16_t color) {
+	struct GFX_Rect rect = {x, y, 1, length};
+	if (!GFX_ClipRect(surface, &rect)) {
+		return;
+	}
+
+	uint16_t *pixel = &surface->pixels[rect.y * surface->stride + rect.x];
+	for (int i = 0; i < rect.height; ++i) {
+		*pixel = color;
+		pixel += surface->stride;
+	}
+}
+
+void GFX_FillRect(
+	struct GFX_Surface *surface, int x, int y, int width, int height,
+	uint16_t color
+) {
+	struct GFX_Rect rect = {x, y, width, height};
+	if (!GFX_ClipRect(surface, &rect)) {
+		return;
+	}
+
+	uint16_t *row = &surface->pixels[rect.y * surface->stride + rect.x];
+
+	// Whole rows with no gap between them are one long span
+	if (rect.width == surface->stride) {
+		GFX_FillSpan(row, rect.width * rect.height, color);
+		return;
+	}
+
+	for (int i = 0; i < rect.height; ++i) {
+		GFX_FillSpan(row, rect.width, color);
+		row += surface->stride;
+	}
+}
+
+void GFX_Clear(struct GFX_Surface *surface, uint16_t color) {
+	GFX_FillRect(surface, 0, 0, surface->width, surface->height, color);
+}
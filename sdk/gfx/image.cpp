@@ -0,0 +1,1114 @@
+#include <sdk/gfx/blend.hpp>
+#include <sdk/gfx/image.hpp>
+#include <sdk/os/mem.hpp>
+
+// The largest image which can be drawn. Keeps pixel counts and offsets well
+// within an int.
+const int MAX_IMAGE_SIZE = 32767;
+
+static int NextMemory(struct GFX_ImageSource *source) {
+	// All of the data was made available straight away
+	source->length = 0;
+	return 0;
+}
+
+void GFX_InitMemorySource(struct GFX_ImageSource *source, const void *data, int size) {
+	source->next = NextMemory;
+	source->data = static_cast<const uint8_t *>(data);
+	source->length = size;
+	source->fd = -1;
+	source->offset = size;
+	source->size = size;
+}
+
+/**
+ * Returns the next byte of the image, or a negative error code.
+ */
+static inline int ReadByte(struct GFX_ImageSource *source) {
+	if (source->length <= 0) {
+		int ret = source->next(source);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (ret == 0) {
+			return GFX_IMAGE_ECORRUPT;
+		}
+	}
+
+	source->length--;
+	return *source->data++;
+}
+
+/**
+ * Reads @p count bytes into @p bytes, which may be nullptr to skip them.
+ *
+ * @return 0 on success, or a negative error code.
+ */
+static int ReadBytes(struct GFX_ImageSource *source, uint8_t *bytes, uint32_t count) {
+	for (uint32_t i = 0; i < count; ++i) {
+		int byte = ReadByte(source);
+		if (byte < 0) {
+			return byte;
+		}
+
+		if (bytes != nullptr) {
+			bytes[i] = byte;
+		}
+	}
+
+	return 0;
+}
+
+static uint32_t GetBigEndian32(const uint8_t *bytes) {
+	return (bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+}
+
+/**
+ * Where the visible part of an image goes on a surface.
+ */
+struct Target {
+	/// Where the top left visible pixel of the image goes.
+	uint16_t *pixels;
+	int stride;
+
+	/// The visible columns, from @ref left to (but not including)
+	/// @ref right.
+	int left, right;
+
+	/// The visible rows.
+	int top, bottom;
+};
+
+static inline uint16_t ToRGB565(int r, int g, int b) {
+	return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+static inline void PutPixel(uint16_t *pixel, uint16_t color, int alpha) {
+	if (alpha == 0xFF) {
+		*pixel = color;
+	} else if (alpha != 0) {
+		*pixel = GFX_BlendColor(*pixel, color, (alpha + 4) >> 3);
+	}
+}
+
+/**
+ * Returns where the first visible pixel of a (visible) row of the image goes.
+ */
+static uint16_t *GetRow(const struct Target *target, int row) {
+	return target->pixels + (row - target->top) * target->stride;
+}
+
+/*
+ * QOI
+ */
+
+const uint8_t QOI_OP_RGB = 0xFE;
+const uint8_t QOI_OP_RGBA = 0xFF;
+const uint8_t QOI_OP_INDEX = 0x00;
+const uint8_t QOI_OP_DIFF = 0x40;
+const uint8_t QOI_OP_LUMA = 0x80;
+const uint8_t QOI_TAG_MASK = 0xC0;
+
+static int OpenQOI(struct GFX_Image *image) {
+	// Everything after the magic
+	uint8_t header[10];
+	int ret = ReadBytes(image->source, header, sizeof(header));
+	if (ret < 0) {
+		return ret;
+	}
+
+	uint32_t width = GetBigEndian32(&header[0]);
+	uint32_t height = GetBigEndian32(&header[4]);
+	if (width == 0 || height == 0) {
+		return GFX_IMAGE_ECORRUPT;
+	}
+
+	if (width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE) {
+		return GFX_IMAGE_EUNSUPPORTED;
+	}
+
+	image->width = width;
+	image->height = height;
+	image->png = false;
+
+	return 0;
+}
+
+static int DrawQOI(struct GFX_Image *image, const struct Target *target) {
+	struct GFX_ImageSource *source = image->source;
+
+	uint8_t seen[64][4] = {};
+	int r = 0, g = 0, b = 0, a = 0xFF;
+	uint16_t color = 0;
+	int run = 0;
+
+	for (int row = 0; row < target->bottom; ++row) {
+		uint16_t *pixels = row >= target->top ? GetRow(target, row) : nullptr;
+
+		for (int column = 0; column < image->width; ++column) {
+			if (run > 0) {
+				run--;
+			} else {
+				int op = ReadByte(source);
+				if (op < 0) {
+					return op;
+				}
+
+				if (op == QOI_OP_RGB || op == QOI_OP_RGBA) {
+					uint8_t bytes[4];
+					int ret = ReadBytes(source, bytes, op == QOI_OP_RGB ? 3 : 4);
+					if (ret < 0) {
+						return ret;
+					}
+
+					r = bytes[0];
+					g = bytes[1];
+					b = bytes[2];
+					if (op == QOI_OP_RGBA) {
+						a = bytes[3];
+					}
+				} else if ((op & QOI_TAG_MASK) == QOI_OP_INDEX) {
+					r = seen[op][0];
+					g = seen[op][1];
+					b = seen[op][2];
+					a = seen[op][3];
+				} else if ((op & QOI_TAG_MASK) == QOI_OP_DIFF) {
+					r = (r + ((op >> 4) & 3) - 2) & 0xFF;
+					g = (g + ((op >> 2) & 3) - 2) & 0xFF;
+					b = (b + (op & 3) - 2) & 0xFF;
+				} else if ((op & QOI_TAG_MASK) == QOI_OP_LUMA) {
+					int next = ReadByte(source);
+					if (next < 0) {
+						return next;
+					}
+
+					int greenDiff = (op & 0x3F) - 32;
+					r = (r + greenDiff - 8 + (next >> 4)) & 0xFF;
+					g = (g + greenDiff) & 0xFF;
+					b = (b + greenDiff - 8 + (next & 0xF)) & 0xFF;
+				} else {
+					// QOI_OP_RUN: this pixel, and then the run
+					run = op & 0x3F;
+				}
+
+				uint8_t *entry = seen[(r * 3 + g * 5 + b * 7 + a * 11) & 63];
+				entry[0] = r;
+				entry[1] = g;
+				entry[2] = b;
+				entry[3] = a;
+
+				color = ToRGB565(r, g, b);
+			}
+
+			if (pixels != nullptr && column >= target->left && column < target->right) {
+				PutPixel(&pixels[column - target->left], color, a);
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * PNG
+ */
+
+const uint32_t PNG_IHDR = 0x49484452;
+const uint32_t PNG_PLTE = 0x504C5445;
+const uint32_t PNG_tRNS = 0x74524E53;
+const uint32_t PNG_IDAT = 0x49444154;
+const uint32_t PNG_IEND = 0x49454E44;
+
+const uint8_t PNG_GRAY = 0;
+const uint8_t PNG_RGB = 2;
+const uint8_t PNG_PALETTE = 3;
+const uint8_t PNG_GRAY_ALPHA = 4;
+const uint8_t PNG_RGBA = 6;
+
+/**
+ * Returns the number of samples per pixel of a PNG color type, or 0 if the
+ * bit depth isn't allowed for it.
+ */
+static int GetChannels(uint8_t colorType, uint8_t bitDepth) {
+	bool low = bitDepth == 1 || bitDepth == 2 || bitDepth == 4;
+	bool high = bitDepth == 8 || bitDepth == 16;
+
+	switch (colorType) {
+	case PNG_GRAY:
+		return (low || high) ? 1 : 0;
+	case PNG_RGB:
+		return high ? 3 : 0;
+	case PNG_PALETTE:
+		return (low || bitDepth == 8) ? 1 : 0;
+	case PNG_GRAY_ALPHA:
+		return high ? 2 : 0;
+	case PNG_RGBA:
+		return high ? 4 : 0;
+	default:
+		return 0;
+	}
+}
+
+static int ReadChunkHeader(struct GFX_ImageSource *source, uint32_t *length, uint32_t *type) {
+	uint8_t header[8];
+	int ret = ReadBytes(source, header, sizeof(header));
+	if (ret < 0) {
+		return ret;
+	}
+
+	*length = GetBigEndian32(&header[0]);
+	*type = GetBigEndian32(&header[4]);
+	if (*length > 0x7FFFFFFF) {
+		return GFX_IMAGE_ECORRUPT;
+	}
+
+	return 0;
+}
+
+/**
+ * Reads the chunks up to the first image data chunk.
+ */
+static int OpenPNG(struct GFX_Image *image) {
+	struct GFX_ImageSource *source = image->source;
+
+	// The rest of the signature
+	uint8_t signature[4];
+	int ret = ReadBytes(source, signature, sizeof(signature));
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (signature[0] != '\r' || signature[1] != '\n' || signature[2] != 0x1A || signature[3] != '\n') {
+		return GFX_IMAGE_EUNSUPPORTED;
+	}
+
+	image->png = true;
+	image->hasColorKey = false;
+	for (int i = 0; i < 256; ++i) {
+		image->palette[i] = 0;
+		image->paletteAlpha[i] = 0xFF;
+	}
+
+	bool hasHeader = false;
+	bool hasPalette = false;
+	for (;;) {
+		uint32_t length, type;
+		ret = ReadChunkHeader(source, &length, &type);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (!hasHeader && type != PNG_IHDR) {
+			return GFX_IMAGE_ECORRUPT;
+		}
+
+		uint8_t data[13];
+		uint32_t dataSize = 0;
+
+		if (type == PNG_IHDR) {
+			if (length != 13) {
+				return GFX_IMAGE_ECORRUPT;
+			}
+
+			ret = ReadBytes(source, data, 13);
+			if (ret < 0) {
+				return ret;
+			}
+
+			dataSize = 13;
+			uint32_t width = GetBigEndian32(&data[0]);
+			uint32_t height = GetBigEndian32(&data[4]);
+			if (width == 0 || height == 0) {
+				return GFX_IMAGE_ECORRUPT;
+			}
+
+			// Compression and filter method 0, not interlaced
+			if (
+				width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE ||
+				GetChannels(data[9], data[8]) == 0 ||
+				data[10] != 0 || data[11] != 0 || data[12] != 0
+			) {
+				return GFX_IMAGE_EUNSUPPORTED;
+			}
+
+			image->width = width;
+			image->height = height;
+			image->bitDepth = data[8];
+			image->colorType = data[9];
+			hasHeader = true;
+		} else if (type == PNG_PLTE) {
+			if (length > 256 * 3) {
+				return GFX_IMAGE_ECORRUPT;
+			}
+
+			for (uint32_t i = 0; i < length / 3; ++i) {
+				uint8_t rgb[3];
+				ret = ReadBytes(source, rgb, sizeof(rgb));
+				if (ret < 0) {
+					return ret;
+				}
+
+				image->palette[i] = ToRGB565(rgb[0], rgb[1], rgb[2]);
+			}
+
+			dataSize = length - length % 3;
+			hasPalette = true;
+		} else if (type == PNG_tRNS && image->colorType == PNG_PALETTE) {
+			if (length > 256) {
+				return GFX_IMAGE_ECORRUPT;
+			}
+
+			ret = ReadBytes(source, image->paletteAlpha, length);
+			if (ret < 0) {
+				return ret;
+			}
+
+			dataSize = length;
+		} else if (type == PNG_tRNS && (image->colorType == PNG_GRAY || image->colorType == PNG_RGB)) {
+			uint32_t size = image->colorType == PNG_GRAY ? 2 : 6;
+			if (length != size) {
+				return GFX_IMAGE_ECORRUPT;
+			}
+
+			ret = ReadBytes(source, data, size);
+			if (ret < 0) {
+				return ret;
+			}
+
+			for (uint32_t i = 0; i < size / 2; ++i) {
+				image->colorKey[i] = (data[i * 2] << 8) | data[i * 2 + 1];
+			}
+
+			dataSize = size;
+			image->hasColorKey = true;
+		} else if (type == PNG_IDAT) {
+			if (image->colorType == PNG_PALETTE && !hasPalette) {
+				return GFX_IMAGE_ECORRUPT;
+			}
+
+			image->chunkLeft = length;
+			return 0;
+		} else if (type == PNG_IEND) {
+			return GFX_IMAGE_ECORRUPT;
+		}
+
+		// Whatever wasn't read of the chunk, then its CRC
+		ret = ReadBytes(source, nullptr, length - dataSize + 4);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+}
+
+/*
+ * Inflate (RFC 1951), for the PNG's image data. Each byte decompressed is
+ * added to the current row, and each row is drawn as soon as it's complete.
+ */
+
+const int WINDOW_SIZE = 32768;
+const int WINDOW_MASK = WINDOW_SIZE - 1;
+
+// Codes up to this long are decoded with one table lookup
+const int FAST_BITS = 9;
+const int FAST_SIZE = 1 << FAST_BITS;
+const int MAX_CODE_LENGTH = 15;
+
+// Bytes of zeroes allowed past the end of the data, so the last code can be
+// looked up like any other
+const int MAX_PADDING = 4;
+
+struct Huffman {
+	/// The number of codes of each length.
+	uint16_t counts[MAX_CODE_LENGTH + 1];
+
+	/// The symbols, in order of their codes.
+	uint16_t symbols[288];
+
+	/// For each value of the next FAST_BITS bits: the length of the code
+	/// they start with shifted left by 9, plus its symbol. 0 if the code is
+	/// longer.
+	uint16_t fast[FAST_SIZE];
+};
+
+struct PNGDecoder {
+	uint8_t window[WINDOW_SIZE];
+	struct Huffman lengths, distances;
+
+	struct GFX_Image *image;
+	const struct Target *target;
+	int error;
+	bool done;
+
+	// Reading bits
+	uint32_t bitBuffer;
+	int bitCount;
+	int padding;
+	bool endOfData;
+
+	// Decompressed bytes
+	uint32_t windowPosition;
+	uint32_t totalOut;
+
+	// The row being decompressed, and the one before it. Each starts with
+	// the filter type.
+	uint8_t *row;
+	uint8_t *previousRow;
+	int rowSize;
+	int rowPosition;
+	int rowNumber;
+	int bytesPerPixel;
+};
+
+const uint16_t LENGTH_BASES[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+const uint8_t LENGTH_EXTRA_BITS[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+const uint16_t DISTANCE_BASES[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+const uint8_t DISTANCE_EXTRA_BITS[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// The order the lengths of the code length codes are stored in
+const uint8_t CODE_LENGTH_ORDER[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/**
+ * Returns the next byte of image data, moving on to the next data chunk when
+ * one runs out, or -1 after the last one.
+ */
+static int ReadDataByte(struct PNGDecoder *decoder) {
+	struct GFX_Image *image = decoder->image;
+
+	while (image->chunkLeft == 0) {
+		if (decoder->endOfData) {
+			return -1;
+		}
+
+		// The CRC of this chunk, then the header of the next
+		int ret = ReadBytes(image->source, nullptr, 4);
+		uint32_t length, type;
+		if (ret == 0) {
+			ret = ReadChunkHeader(image->source, &length, &type);
+		}
+
+		if (ret < 0) {
+			decoder->error = ret;
+			decoder->endOfData = true;
+			return -1;
+		}
+
+		if (type != PNG_IDAT) {
+			decoder->endOfData = true;
+			return -1;
+		}
+
+		image->chunkLeft = length;
+	}
+
+	int byte = ReadByte(image->source);
+	if (byte < 0) {
+		decoder->error = byte;
+		decoder->endOfData = true;
+		return -1;
+	}
+
+	image->chunkLeft--;
+	return byte;
+}
+
+/**
+ * Makes sure there are at least @p count bits in the bit buffer (up to 25).
+ */
+static inline void NeedBits(struct PNGDecoder *decoder, int count) {
+	while (decoder->bitCount < count) {
+		int byte = ReadDataByte(decoder);
+		if (byte < 0) {
+			if (decoder->error == 0 && ++decoder->padding > MAX_PADDING) {
+				decoder->error = GFX_IMAGE_ECORRUPT;
+			}
+
+			byte = 0;
+		}
+
+		decoder->bitBuffer |= static_cast<uint32_t>(byte) << decoder->bitCount;
+		decoder->bitCount += 8;
+	}
+}
+
+static inline void DropBits(struct PNGDecoder *decoder, int count) {
+	decoder->bitBuffer >>= count;
+	decoder->bitCount -= count;
+}
+
+static inline uint32_t GetBits(struct PNGDecoder *decoder, int count) {
+	NeedBits(decoder, count);
+
+	uint32_t value = decoder->bitBuffer & ((1u << count) - 1);
+	DropBits(decoder, count);
+	return value;
+}
+
+/**
+ * Sets up a Huffman code from the code length of each symbol.
+ *
+ * @return False if the lengths don't make a valid code.
+ */
+static bool BuildHuffman(struct Huffman *huffman, const uint8_t *lengths, int numSymbols) {
+	for (int i = 0; i <= MAX_CODE_LENGTH; ++i) {
+		huffman->counts[i] = 0;
+	}
+
+	for (int i = 0; i < numSymbols; ++i) {
+		huffman->counts[lengths[i]]++;
+	}
+
+	huffman->counts[0] = 0;
+
+	// Codes may be left unused, but there mustn't be more than fit
+	int left = 1;
+	for (int i = 1; i <= MAX_CODE_LENGTH; ++i) {
+		left = (left << 1) - huffman->counts[i];
+		if (left < 0) {
+			return false;
+		}
+	}
+
+	// The first code and symbol index of each length
+	uint16_t codes[MAX_CODE_LENGTH + 1];
+	uint16_t offsets[MAX_CODE_LENGTH + 1];
+	int code = 0;
+	offsets[1] = 0;
+	for (int i = 1; i <= MAX_CODE_LENGTH; ++i) {
+		codes[i] = code;
+		code = (code + huffman->counts[i]) << 1;
+
+		if (i < MAX_CODE_LENGTH) {
+			offsets[i + 1] = offsets[i] + huffman->counts[i];
+		}
+	}
+
+	for (int i = 0; i < FAST_SIZE; ++i) {
+		huffman->fast[i] = 0;
+	}
+
+	for (int symbol = 0; symbol < numSymbols; ++symbol) {
+		int length = lengths[symbol];
+		if (length == 0) {
+			continue;
+		}
+
+		huffman->symbols[offsets[length]++] = symbol;
+
+		int symbolCode = codes[length]++;
+		if (length > FAST_BITS) {
+			continue;
+		}
+
+		// Codes are stored starting from their top bit
+		int reversed = 0;
+		for (int i = 0; i < length; ++i) {
+			reversed = (reversed << 1) | ((symbolCode >> i) & 1);
+		}
+
+		for (int i = reversed; i < FAST_SIZE; i += 1 << length) {
+			huffman->fast[i] = (length << 9) | symbol;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Reads a symbol, or returns -1 if the bits aren't a valid code.
+ */
+static inline int DecodeSymbol(struct PNGDecoder *decoder, const struct Huffman *huffman) {
+	NeedBits(decoder, MAX_CODE_LENGTH);
+
+	int entry = huffman->fast[decoder->bitBuffer & (FAST_SIZE - 1)];
+	if (entry != 0) {
+		DropBits(decoder, entry >> 9);
+		return entry & 0x1FF;
+	}
+
+	// A longer code - go through it a bit at a time
+	uint32_t bits = decoder->bitBuffer;
+	int code = 0;
+	int first = 0;
+	int index = 0;
+	for (int length = 1; length <= MAX_CODE_LENGTH; ++length) {
+		code |= bits & 1;
+		bits >>= 1;
+
+		int count = huffman->counts[length];
+		if (code - count < first) {
+			DropBits(decoder, length);
+			return huffman->symbols[index + (code - first)];
+		}
+
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+
+	return -1;
+}
+
+static uint8_t Paeth(uint8_t left, uint8_t up, uint8_t upLeft) {
+	int estimate = left + up - upLeft;
+	int distanceLeft = estimate > left ? estimate - left : left - estimate;
+	int distanceUp = estimate > up ? estimate - up : up - estimate;
+	int distanceUpLeft = estimate > upLeft ? estimate - upLeft : upLeft - estimate;
+
+	if (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft) {
+		return left;
+	}
+
+	return distanceUp <= distanceUpLeft ? up : upLeft;
+}
+
+/**
+ * Undoes the filter on the current row.
+ */
+static bool Unfilter(struct PNGDecoder *decoder) {
+	uint8_t *row = decoder->row + 1;
+	const uint8_t *above = decoder->previousRow + 1;
+	int size = decoder->rowSize - 1;
+	int step = decoder->bytesPerPixel;
+
+	switch (decoder->row[0]) {
+	case 0:
+		break;
+	case 1:
+		for (int i = step; i < size; ++i) {
+			row[i] += row[i - step];
+		}
+		break;
+	case 2:
+		for (int i = 0; i < size; ++i) {
+			row[i] += above[i];
+		}
+		break;
+	case 3:
+		for (int i = 0; i < step; ++i) {
+			row[i] += above[i] >> 1;
+		}
+
+		for (int i = step; i < size; ++i) {
+			row[i] += (row[i - step] + above[i]) >> 1;
+		}
+		break;
+	case 4:
+		for (int i = 0; i < step; ++i) {
+			row[i] += above[i];
+		}
+
+		for (int i = step; i < size; ++i) {
+			row[i] += Paeth(row[i - step], above[i], above[i - step]);
+		}
+		break;
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Draws the visible part of the current (unfiltered) row. @p pixels is where
+ * the first visible pixel goes.
+ */
+static void DrawRow(struct PNGDecoder *decoder, uint16_t *pixels) {
+	const struct GFX_Image *image = decoder->image;
+	const struct Target *target = decoder->target;
+	const uint8_t *row = decoder->row + 1;
+	int depth = image->bitDepth;
+
+	if (depth < 8) {
+		// Gray levels or palette indexes, packed into bytes
+		int mask = (1 << depth) - 1;
+		int scale = depth == 1 ? 0xFF : (depth == 2 ? 0x55 : 0x11);
+
+		for (int x = target->left; x < target->right; ++x) {
+			int bit = x * depth;
+			int value = (row[bit >> 3] >> (8 - depth - (bit & 7))) & mask;
+
+			if (image->colorType == PNG_PALETTE) {
+				PutPixel(&pixels[x - target->left], image->palette[value], image->paletteAlpha[value]);
+			} else {
+				int gray = value * scale;
+				int alpha = (image->hasColorKey && value == image->colorKey[0]) ? 0 : 0xFF;
+				PutPixel(&pixels[x - target->left], ToRGB565(gray, gray, gray), alpha);
+			}
+		}
+
+		return;
+	}
+
+	// Samples are one or two bytes, and only the top byte is used
+	int sampleSize = depth >> 3;
+	int pixelSize = decoder->bytesPerPixel;
+	const uint8_t *pixel = &row[target->left * pixelSize];
+
+	for (int x = target->left; x < target->right; ++x, pixel += pixelSize) {
+		int r, g, b;
+		int alpha = 0xFF;
+
+		switch (image->colorType) {
+		case PNG_PALETTE:
+			PutPixel(&pixels[x - target->left], image->palette[*pixel], image->paletteAlpha[*pixel]);
+			continue;
+		case PNG_GRAY:
+		case PNG_GRAY_ALPHA:
+			r = g = b = pixel[0];
+			if (image->colorType == PNG_GRAY_ALPHA) {
+				alpha = pixel[sampleSize];
+			}
+			break;
+		default:
+			r = pixel[0];
+			g = pixel[sampleSize];
+			b = pixel[sampleSize * 2];
+			if (image->colorType == PNG_RGBA) {
+				alpha = pixel[sampleSize * 3];
+			}
+			break;
+		}
+
+		if (image->hasColorKey) {
+			// Compare whole samples, at their full depth
+			bool match = true;
+			int numSamples = image->colorType == PNG_GRAY ? 1 : 3;
+			for (int i = 0; i < numSamples; ++i) {
+				const uint8_t *sample = &pixel[i * sampleSize];
+				int value = sampleSize == 2 ? (sample[0] << 8) | sample[1] : sample[0];
+				match = match && value == image->colorKey[i];
+			}
+
+			if (match) {
+				alpha = 0;
+			}
+		}
+
+		PutPixel(&pixels[x - target->left], ToRGB565(r, g, b), alpha);
+	}
+}
+
+/**
+ * Called once a row has been decompressed.
+ */
+static void FinishRow(struct PNGDecoder *decoder) {
+	const struct Target *target = decoder->target;
+
+	if (!Unfilter(decoder)) {
+		// Nothing more can be drawn
+		decoder->error = GFX_IMAGE_ECORRUPT;
+		decoder->done = true;
+		return;
+	}
+
+	if (decoder->rowNumber >= target->top) {
+		DrawRow(decoder, GetRow(target, decoder->rowNumber));
+	}
+
+	uint8_t *swap = decoder->previousRow;
+	decoder->previousRow = decoder->row;
+	decoder->row = swap;
+	decoder->rowPosition = 0;
+
+	decoder->rowNumber++;
+	if (decoder->rowNumber >= target->bottom) {
+		decoder->done = true;
+	}
+}
+
+static inline void Output(struct PNGDecoder *decoder, uint8_t byte) {
+	decoder->window[decoder->windowPosition++ & WINDOW_MASK] = byte;
+	decoder->totalOut++;
+
+	decoder->row[decoder->rowPosition++] = byte;
+	if (decoder->rowPosition == decoder->rowSize) {
+		FinishRow(decoder);
+	}
+}
+
+static void InflateStored(struct PNGDecoder *decoder) {
+	// Stored blocks start on a byte boundary
+	DropBits(decoder, decoder->bitCount & 7);
+
+	uint32_t length = GetBits(decoder, 16);
+	uint32_t check = GetBits(decoder, 16);
+	if (length != (~check & 0xFFFF)) {
+		decoder->error = GFX_IMAGE_ECORRUPT;
+		return;
+	}
+
+	for (uint32_t i = 0; i < length && !decoder->done && decoder->error == 0; ++i) {
+		Output(decoder, GetBits(decoder, 8));
+	}
+}
+
+static void InflateCodes(struct PNGDecoder *decoder) {
+	while (!decoder->done && decoder->error == 0) {
+		int symbol = DecodeSymbol(decoder, &decoder->lengths);
+		if (symbol < 0) {
+			decoder->error = GFX_IMAGE_ECORRUPT;
+			return;
+		}
+
+		if (symbol < 256) {
+			Output(decoder, symbol);
+			continue;
+		}
+
+		if (symbol == 256) {
+			return;
+		}
+
+		symbol -= 257;
+		if (symbol >= 29) {
+			decoder->error = GFX_IMAGE_ECORRUPT;
+			return;
+		}
+
+		int length = LENGTH_BASES[symbol] + GetBits(decoder, LENGTH_EXTRA_BITS[symbol]);
+
+		symbol = DecodeSymbol(decoder, &decoder->distances);
+		if (symbol < 0 || symbol >= 30) {
+			decoder->error = GFX_IMAGE_ECORRUPT;
+			return;
+		}
+
+		uint32_t distance = DISTANCE_BASES[symbol] + GetBits(decoder, DISTANCE_EXTRA_BITS[symbol]);
+		if (distance > decoder->totalOut) {
+			decoder->error = GFX_IMAGE_ECORRUPT;
+			return;
+		}
+
+		for (int i = 0; i < length && !decoder->done; ++i) {
+			Output(decoder, decoder->window[(decoder->windowPosition - distance) & WINDOW_MASK]);
+		}
+	}
+}
+
+static void BuildFixedCodes(struct PNGDecoder *decoder) {
+	uint8_t lengths[288];
+
+	for (int i = 0; i < 288; ++i) {
+		lengths[i] = i < 144 ? 8 : (i < 256 ? 9 : (i < 280 ? 7 : 8));
+	}
+
+	BuildHuffman(&decoder->lengths, lengths, 288);
+
+	for (int i = 0; i < 30; ++i) {
+		lengths[i] = 5;
+	}
+
+	BuildHuffman(&decoder->distances, lengths, 30);
+}
+
+static bool BuildDynamicCodes(struct PNGDecoder *decoder) {
+	int numLengths = GetBits(decoder, 5) + 257;
+	int numDistances = GetBits(decoder, 5) + 1;
+	int numCodeLengths = GetBits(decoder, 4) + 4;
+	if (numLengths > 286 || numDistances > 30) {
+		return false;
+	}
+
+	uint8_t lengths[286 + 30];
+	for (int i = 0; i < 19; ++i) {
+		lengths[CODE_LENGTH_ORDER[i]] = i < numCodeLengths ? GetBits(decoder, 3) : 0;
+	}
+
+	// The code lengths are themselves Huffman coded. The distance table is
+	// free to hold that code for now.
+	struct Huffman *codeLengths = &decoder->distances;
+	if (!BuildHuffman(codeLengths, lengths, 19)) {
+		return false;
+	}
+
+	int total = numLengths + numDistances;
+	for (int i = 0; i < total;) {
+		int symbol = DecodeSymbol(decoder, codeLengths);
+		if (symbol < 0) {
+			return false;
+		}
+
+		if (symbol < 16) {
+			lengths[i++] = symbol;
+			continue;
+		}
+
+		int value = 0;
+		int repeat;
+		if (symbol == 16) {
+			if (i == 0) {
+				return false;
+			}
+
+			value = lengths[i - 1];
+			repeat = 3 + GetBits(decoder, 2);
+		} else if (symbol == 17) {
+			repeat = 3 + GetBits(decoder, 3);
+		} else {
+			repeat = 11 + GetBits(decoder, 7);
+		}
+
+		if (i + repeat > total) {
+			return false;
+		}
+
+		while (repeat-- > 0) {
+			lengths[i++] = value;
+		}
+	}
+
+	// There has to be an end of block code
+	if (lengths[256] == 0) {
+		return false;
+	}
+
+	return BuildHuffman(&decoder->lengths, lengths, numLengths) &&
+		BuildHuffman(&decoder->distances, &lengths[numLengths], numDistances);
+}
+
+static void Inflate(struct PNGDecoder *decoder) {
+	// The zlib header: deflate, with no preset dictionary
+	uint32_t method = GetBits(decoder, 8);
+	uint32_t flags = GetBits(decoder, 8);
+	if ((method & 0x0F) != 8 || (method >> 4) > 7 || ((method << 8) | flags) % 31 != 0 || (flags & 0x20) != 0) {
+		decoder->error = GFX_IMAGE_ECORRUPT;
+		return;
+	}
+
+	bool last = false;
+	while (!last && !decoder->done && decoder->error == 0) {
+		last = GetBits(decoder, 1) != 0;
+
+		switch (GetBits(decoder, 2)) {
+		case 0:
+			InflateStored(decoder);
+			break;
+		case 1:
+			BuildFixedCodes(decoder);
+			InflateCodes(decoder);
+			break;
+		case 2:
+			if (!BuildDynamicCodes(decoder)) {
+				decoder->error = GFX_IMAGE_ECORRUPT;
+				return;
+			}
+
+			InflateCodes(decoder);
+			break;
+		default:
+			decoder->error = GFX_IMAGE_ECORRUPT;
+			return;
+		}
+	}
+
+	// Not enough data for all the rows which were needed
+	if (!decoder->done && decoder->error == 0) {
+		decoder->error = GFX_IMAGE_ECORRUPT;
+	}
+}
+
+static int DrawPNG(struct GFX_Image *image, const struct Target *target) {
+	int bitsPerPixel = GetChannels(image->colorType, image->bitDepth) * image->bitDepth;
+	int rowSize = 1 + ((image->width * bitsPerPixel + 7) >> 3);
+
+	struct PNGDecoder *decoder = static_cast<struct PNGDecoder *>(
+		malloc(sizeof(struct PNGDecoder) + rowSize * 2)
+	);
+	if (decoder == nullptr) {
+		return GFX_IMAGE_ENOMEM;
+	}
+
+	decoder->image = image;
+	decoder->target = target;
+	decoder->error = 0;
+	decoder->done = false;
+	decoder->bitBuffer = 0;
+	decoder->bitCount = 0;
+	decoder->padding = 0;
+	decoder->endOfData = false;
+	decoder->windowPosition = 0;
+	decoder->totalOut = 0;
+
+	decoder->row = reinterpret_cast<uint8_t *>(decoder + 1);
+	decoder->previousRow = decoder->row + rowSize;
+	decoder->rowSize = rowSize;
+	decoder->rowPosition = 0;
+	decoder->rowNumber = 0;
+	decoder->bytesPerPixel = bitsPerPixel < 8 ? 1 : bitsPerPixel >> 3;
+
+	// The row above the first is all zeroes
+	for (int i = 0; i < rowSize; ++i) {
+		decoder->previousRow[i] = 0;
+	}
+
+	Inflate(decoder);
+
+	int error = decoder->error;
+	free(decoder);
+	return error;
+}
+
+int GFX_OpenImage(struct GFX_Image *image, struct GFX_ImageSource *source) {
+	image->source = source;
+
+	uint8_t magic[4];
+	int ret = ReadBytes(source, magic, sizeof(magic));
+	if (ret < 0) {
+		return ret == GFX_IMAGE_ECORRUPT ? GFX_IMAGE_EUNSUPPORTED : ret;
+	}
+
+	if (magic[0] == 'q' && magic[1] == 'o' && magic[2] == 'i' && magic[3] == 'f') {
+		return OpenQOI(image);
+	}
+
+	if (magic[0] == 0x89 && magic[1] == 'P' && magic[2] == 'N' && magic[3] == 'G') {
+		return OpenPNG(image);
+	}
+
+	return GFX_IMAGE_EUNSUPPORTED;
+}
+
+int GFX_DrawImage(struct GFX_Image *image, struct GFX_Surface *surface, int x, int y) {
+	const struct GFX_Rect *clip = &surface->clip;
+
+	struct Target target;
+	target.left = clip->x > x ? clip->x - x : 0;
+	target.top = clip->y > y ? clip->y - y : 0;
+	target.right = clip->x + clip->width - x;
+	target.bottom = clip->y + clip->height - y;
+
+	if (target.right > image->width) {
+		target.right = image->width;
+	}
+
+	if (target.bottom > image->height) {
+		target.bottom = image->height;
+	}
+
+	if (target.left >= target.right || target.top >= target.bottom) {
+		return 0;
+	}
+
+	target.pixels = &surface->pixels[(y + target.top) * surface->stride + x + target.left];
+	target.stride = surface->stride;
+
+	return image->png ? DrawPNG(image, &target) : DrawQOI(image, &target);
+}
@@ -0,0 +1,73 @@
+#include <sdk/gfx/image.hpp>
+#include <sdk/os/file.hpp>
+
+/*
+ * Kept apart from the rest of the image code, as reading files is the only
+ * part which uses the OS.
+ */
+
+// getAddr only promises that the data up to the end of the sector follows
+// the address it returns
+const int SECTOR_SIZE = 512;
+
+static int NextRead(struct GFX_ImageSource *source) {
+	int ret = read(source->fd, source->buffer, sizeof(source->buffer));
+	if (ret < 0) {
+		return ret;
+	}
+
+	source->data = source->buffer;
+	source->length = ret;
+	return ret;
+}
+
+int GFX_InitFileSource(struct GFX_ImageSource *source, int fd) {
+	source->next = NextRead;
+	source->data = source->buffer;
+	source->length = 0;
+	source->fd = fd;
+	source->offset = 0;
+	source->size = 0;
+
+	return 0;
+}
+
+static int NextMapped(struct GFX_ImageSource *source) {
+	if (source->offset >= source->size) {
+		source->length = 0;
+		return 0;
+	}
+
+	const void *address;
+	int ret = getAddr(source->fd, source->offset, &address);
+	if (ret < 0) {
+		return ret;
+	}
+
+	int length = SECTOR_SIZE - (source->offset & (SECTOR_SIZE - 1));
+	if (length > source->size - source->offset) {
+		length = source->size - source->offset;
+	}
+
+	source->data = static_cast<const uint8_t *>(address);
+	source->length = length;
+	source->offset += length;
+	return length;
+}
+
+int GFX_InitMappedFileSource(struct GFX_ImageSource *source, int fd) {
+	struct stat fileStat;
+	int ret = fstat(fd, &fileStat);
+	if (ret < 0) {
+		return ret;
+	}
+
+	source->next = NextMapped;
+	source->data = source->buffer;
+	source->length = 0;
+	source->fd = fd;
+	source->offset = 0;
+	source->size = fileStat.fileSize;
+
+	return 0;
+}
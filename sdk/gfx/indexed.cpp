@@ -0,0 +1,327 @@
+#include <sdk/gfx/color.hpp>
+#include <sdk/gfx/indexed.hpp>
+
+// Two pixels, stored with one write. may_alias, as it's used to access arrays
+// of uint16_t.
+typedef uint32_t __attribute__((__may_alias__)) PixelPair;
+
+/**
+ * Packs two pixels so that @p left ends up first in memory when the pair is
+ * stored.
+ */
+static uint32_t MakePair(uint16_t left, uint16_t right) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	return (static_cast<uint32_t>(left) << 16) | right;
+#else
+	return (static_cast<uint32_t>(right) << 16) | left;
+#endif
+}
+
+void GFX_InitPalette(struct GFX_Palette *palette) {
+	for (int i = 0; i < 256; ++i) {
+		palette->colors[i] = i < 8 ? GFX_PALETTE_COLORS[i] : 0;
+	}
+
+	for (int i = 0; i < 256; ++i) {
+		palette->pairs[i] = MakePair(palette->colors[i >> 4], palette->colors[i & 0xF]);
+	}
+}
+
+void GFX_SetPaletteColor(struct GFX_Palette *palette, uint8_t index, uint16_t color) {
+	palette->colors[index] = color;
+
+	if (index >= 16) {
+		return;
+	}
+
+	// The bytes with this index as their left pixel, then as their right
+	for (int i = 0; i < 16; ++i) {
+		palette->pairs[(index << 4) | i] = MakePair(color, palette->colors[i]);
+	}
+
+	for (int i = 0; i < 16; ++i) {
+		palette->pairs[(i << 4) | index] = MakePair(palette->colors[i], color);
+	}
+}
+
+void GFX_RotatePalette(struct GFX_Palette *palette, int first, int count) {
+	if (first < 0 || count < 2 || first + count > 256) {
+		return;
+	}
+
+	int last = first + count - 1;
+	uint16_t lastColor = palette->colors[last];
+	for (int i = last; i > first; --i) {
+		GFX_SetPaletteColor(palette, i, palette->colors[i - 1]);
+	}
+
+	GFX_SetPaletteColor(palette, first, lastColor);
+}
+
+/**
+ * Returns how many bytes a row of @p width pixels takes up.
+ */
+static int GetRowSize(int width, int bitsPerPixel) {
+	return bitsPerPixel == 4 ? (width + 1) >> 1 : width;
+}
+
+int GFX_GetIndexedBufferSize(int width, int height, int bitsPerPixel) {
+	return GetRowSize(width, bitsPerPixel) * height;
+}
+
+void GFX_InitIndexedSurface(
+	struct GFX_IndexedSurface *surface, uint8_t *pixels, int width, int height,
+	int bitsPerPixel
+) {
+	surface->pixels = pixels;
+	surface->width = width;
+	surface->height = height;
+	surface->stride = GetRowSize(width, bitsPerPixel);
+	surface->bitsPerPixel = bitsPerPixel;
+}
+
+uint8_t GFX_GetIndexedPixel(const struct GFX_IndexedSurface *surface, int x, int y) {
+	const uint8_t *row = &surface->pixels[y * surface->stride];
+
+	if (surface->bitsPerPixel == 8) {
+		return row[x];
+	}
+
+	uint8_t pair = row[x >> 1];
+	return (x & 1) ? (pair & 0xF) : (pair >> 4);
+}
+
+void GFX_SetIndexedPixel(struct GFX_IndexedSurface *surface, int x, int y, uint8_t index) {
+	if (x < 0 || x >= surface->width || y < 0 || y >= surface->height) {
+		return;
+	}
+
+	uint8_t *row = &surface->pixels[y * surface->stride];
+
+	if (surface->bitsPerPixel == 8) {
+		row[x] = index;
+		return;
+	}
+
+	uint8_t *pair = &row[x >> 1];
+	if (x & 1) {
+		*pair = (*pair & 0xF0) | (index & 0xF);
+	} else {
+		*pair = (*pair & 0x0F) | (index << 4);
+	}
+}
+
+/**
+ * Sets @p count bytes to @p value.
+ */
+static void FillBytes(uint8_t *bytes, int count, uint8_t value) {
+	for (int i = 0; i < count; ++i) {
+		bytes[i] = value;
+	}
+}
+
+void GFX_FillIndexedRect(
+	struct GFX_IndexedSurface *surface, int x, int y, int width, int height,
+	uint8_t index
+) {
+	if (x < 0) {
+		width += x;
+		x = 0;
+	}
+
+	if (y < 0) {
+		height += y;
+		y = 0;
+	}
+
+	if (width > surface->width - x) {
+		width = surface->width - x;
+	}
+
+	if (height > surface->height - y) {
+		height = surface->height - y;
+	}
+
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	uint8_t *row = &surface->pixels[y * surface->stride];
+
+	if (surface->bitsPerPixel == 8) {
+		for (int i = 0; i < height; ++i) {
+			FillBytes(&row[x], width, index);
+			row += surface->stride;
+		}
+
+		return;
+	}
+
+	// At 4 bits per pixel, a pixel at either end may share its byte with one
+	// outside the rectangle
+	index &= 0xF;
+	int right = x + width;
+	bool leftHalf = (x & 1) != 0;
+	bool rightHalf = (right & 1) != 0;
+	int firstByte = (x + 1) >> 1;
+	int numBytes = (right >> 1) - firstByte;
+
+	for (int i = 0; i < height; ++i) {
+		if (leftHalf) {
+			uint8_t *pair = &row[x >> 1];
+			*pair = (*pair & 0xF0) | index;
+		}
+
+		FillBytes(&row[firstByte], numBytes, index * 0x11);
+
+		if (rightHalf) {
+			uint8_t *pair = &row[right >> 1];
+			*pair = (*pair & 0x0F) | (index << 4);
+		}
+
+		row += surface->stride;
+	}
+}
+
+void GFX_ClearIndexed(struct GFX_IndexedSurface *surface, uint8_t index) {
+	GFX_FillIndexedRect(surface, 0, 0, surface->width, surface->height, index);
+}
+
+/**
+ * Converts @p count pixels of a 4 bit per pixel row, starting at pixel @p x.
+ */
+static void ExpandRow4(
+	uint16_t *destination, const uint8_t *row, int x, int count,
+	const struct GFX_Palette *palette
+) {
+	const uint8_t *source = &row[x >> 1];
+	const uint16_t *colors = palette->colors;
+
+	if (x & 1) {
+		*destination++ = colors[*source++ & 0xF];
+		count--;
+	}
+
+	if ((reinterpret_cast<uintptr_t>(destination) & 2) != 0) {
+		// Can't store pairs
+		for (; count >= 2; count -= 2) {
+			uint8_t pair = *source++;
+			*destination++ = colors[pair >> 4];
+			*destination++ = colors[pair & 0xF];
+		}
+	} else {
+		// One lookup per pair of pixels, eight pixels per iteration
+		const uint32_t *pairs = palette->pairs;
+		PixelPair *destinationPairs = reinterpret_cast<PixelPair *>(destination);
+
+		for (; count >= 8; count -= 8) {
+			uint32_t a = pairs[source[0]];
+			uint32_t b = pairs[source[1]];
+			uint32_t c = pairs[source[2]];
+			uint32_t d = pairs[source[3]];
+			destinationPairs[0] = a;
+			destinationPairs[1] = b;
+			destinationPairs[2] = c;
+			destinationPairs[3] = d;
+			destinationPairs += 4;
+			source += 4;
+		}
+
+		for (; count >= 2; count -= 2) {
+			*destinationPairs++ = pairs[*source++];
+		}
+
+		destination = reinterpret_cast<uint16_t *>(destinationPairs);
+	}
+
+	if (count > 0) {
+		*destination = colors[*source >> 4];
+	}
+}
+
+/**
+ * Converts @p count pixels of an 8 bit per pixel row.
+ */
+static void ExpandRow8(
+	uint16_t *destination, const uint8_t *source, int count,
+	const struct GFX_Palette *palette
+) {
+	const uint16_t *colors = palette->colors;
+
+	if (count > 0 && (reinterpret_cast<uintptr_t>(destination) & 2) != 0) {
+		*destination++ = colors[*source++];
+		count--;
+	}
+
+	PixelPair *destinationPairs = reinterpret_cast<PixelPair *>(destination);
+
+	for (; count >= 8; count -= 8) {
+		uint32_t a = MakePair(colors[source[0]], colors[source[1]]);
+		uint32_t b = MakePair(colors[source[2]], colors[source[3]]);
+		uint32_t c = MakePair(colors[source[4]], colors[source[5]]);
+		uint32_t d = MakePair(colors[source[6]], colors[source[7]]);
+		destinationPairs[0] = a;
+		destinationPairs[1] = b;
+		destinationPairs[2] = c;
+		destinationPairs[3] = d;
+		destinationPairs += 4;
+		source += 8;
+	}
+
+	for (; count >= 2; count -= 2) {
+		*destinationPairs++ = MakePair(colors[source[0]], colors[source[1]]);
+		source += 2;
+	}
+
+	if (count > 0) {
+		*reinterpret_cast<uint16_t *>(destinationPairs) = colors[*source];
+	}
+}
+
+void GFX_ExpandIndexed(
+	struct GFX_Surface *destination, const struct GFX_IndexedSurface *source,
+	const struct GFX_Palette *palette, const struct GFX_Rect *rect
+) {
+	int x = rect->x;
+	int y = rect->y;
+	int width = rect->width;
+	int height = rect->height;
+
+	if (x < 0) {
+		width += x;
+		x = 0;
+	}
+
+	if (y < 0) {
+		height += y;
+		y = 0;
+	}
+
+	int maxWidth = destination->width < source->width ? destination->width : source->width;
+	if (width > maxWidth - x) {
+		width = maxWidth - x;
+	}
+
+	int maxHeight = destination->height < source->height ? destination->height : source->height;
+	if (height > maxHeight - y) {
+		height = maxHeight - y;
+	}
+
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	uint16_t *destinationRow = &destination->pixels[y * destination->stride + x];
+	const uint8_t *sourceRow = &source->pixels[y * source->stride];
+
+	for (int i = 0; i < height; ++i) {
+		if (source->bitsPerPixel == 8) {
+			ExpandRow8(destinationRow, &sourceRow[x], width, palette);
+		} else {
+			ExpandRow4(destinationRow, sourceRow, x, width, palette);
+		}
+
+		destinationRow += destination->stride;
+		sourceRow += source->stride;
+	}
+}
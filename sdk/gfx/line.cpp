@@ -0,0 +1,320 @@
+#include <sdk/gfx/blend.hpp>
+#include <sdk/gfx/fill.hpp>
+#include <sdk/gfx/line.hpp>
+
+// Cohen-Sutherland outcodes: which sides of the clip rectangle a point is
+// beyond
+enum OutCode {
+	OutCodeLeft = 1 << 0,
+	OutCodeRight = 1 << 1,
+	OutCodeAbove = 1 << 2,
+	OutCodeBelow = 1 << 3
+};
+
+static int GetOutCode(const struct GFX_Rect *clip, int x, int y) {
+	int code = 0;
+
+	if (x < clip->x) {
+		code |= OutCodeLeft;
+	} else if (x >= clip->x + clip->width) {
+		code |= OutCodeRight;
+	}
+
+	if (y < clip->y) {
+		code |= OutCodeAbove;
+	} else if (y >= clip->y + clip->height) {
+		code |= OutCodeBelow;
+	}
+
+	return code;
+}
+
+/**
+ * Divides two numbers, one bit at a time. Apps don't have the compiler's
+ * division routines, and this is only needed when clipping.
+ */
+static uint32_t Divide(uint32_t numerator, uint32_t denominator, uint32_t *remainder) {
+	uint32_t quotient = 0;
+	uint32_t rest = 0;
+
+	for (int i = 0; i < 32; ++i) {
+		rest = (rest << 1) | (numerator >> 31);
+		numerator <<= 1;
+		quotient <<= 1;
+
+		if (rest >= denominator) {
+			rest -= denominator;
+			quotient |= 1;
+		}
+	}
+
+	if (remainder != nullptr) {
+		*remainder = rest;
+	}
+
+	return quotient;
+}
+
+static int DivideRoundingUp(uint32_t numerator, uint32_t denominator) {
+	uint32_t remainder;
+	uint32_t quotient = Divide(numerator, denominator, &remainder);
+
+	return quotient + (remainder != 0 ? 1 : 0);
+}
+
+/**
+ * Draws a line from @p x0, @p y0 to @p x1, @p y1, leaving off the last pixel
+ * if @p includeEnd is false.
+ *
+ * The line steps one pixel at a time along its major axis (whichever it
+ * covers more of). At step k, it's
+ * <tt>floor((2 * k * minorLength + majorLength) / (2 * majorLength))</tt>
+ * pixels along the minor axis. The numerator of that is tracked as the error
+ * term, which is what makes it possible to start drawing partway along.
+ */
+static void DrawLine(
+	struct GFX_Surface *surface, int x0, int y0, int x1, int y1,
+	uint16_t color, bool includeEnd
+) {
+	const struct GFX_Rect *clip = &surface->clip;
+
+	int stepX = x1 >= x0 ? 1 : -1;
+	int stepY = y1 >= y0 ? 1 : -1;
+	int lengthX = (x1 - x0) * stepX;
+	int lengthY = (y1 - y0) * stepY;
+
+	bool xMajor = lengthX >= lengthY;
+	int majorLength = xMajor ? lengthX : lengthY;
+	int minorLength = xMajor ? lengthY : lengthX;
+
+	// The steps to draw
+	int first = 0;
+	int last = includeEnd ? majorLength : majorLength - 1;
+	if (last < 0) {
+		return;
+	}
+
+	// If both ends are beyond the same side, none of the line is visible
+	int code0 = GetOutCode(clip, x0, y0);
+	int code1 = GetOutCode(clip, x1, y1);
+	if ((code0 & code1) != 0) {
+		return;
+	}
+
+	if (lengthY == 0) {
+		int left = stepX > 0 ? x0 : x0 - last;
+		GFX_HLine(surface, left, y0, last + 1, color);
+		return;
+	}
+
+	if (lengthX == 0) {
+		int top = stepY > 0 ? y0 : y0 - last;
+		GFX_VLine(surface, x0, top, last + 1, color);
+		return;
+	}
+
+	int major0 = xMajor ? x0 : y0;
+	int minor0 = xMajor ? y0 : x0;
+	int majorSign = xMajor ? stepX : stepY;
+	int minorSign = xMajor ? stepY : stepX;
+
+	// Inclusive bounds of the clip rectangle, along each axis
+	int majorLow = xMajor ? clip->x : clip->y;
+	int majorHigh = majorLow + (xMajor ? clip->width : clip->height) - 1;
+	int minorLow = xMajor ? clip->y : clip->x;
+	int minorHigh = minorLow + (xMajor ? clip->height : clip->width) - 1;
+
+	if ((code0 | code1) != 0) {
+		// Partly outside - work out which steps are inside the clip
+		// rectangle. First along the major axis, which moves one pixel per
+		// step.
+		int low = (majorSign > 0 ? majorLow - major0 : major0 - majorHigh);
+		int high = (majorSign > 0 ? majorHigh - major0 : major0 - majorLow);
+		if (low > first) {
+			first = low;
+		}
+
+		if (high < last) {
+			last = high;
+		}
+
+		// Then along the minor axis, by finding the steps where the line
+		// moves into and out of the clip rectangle
+		low = (minorSign > 0 ? minorLow - minor0 : minor0 - minorHigh);
+		high = (minorSign > 0 ? minorHigh - minor0 : minor0 - minorLow);
+		if (high < 0 || low > minorLength) {
+			return;
+		}
+
+		if (low > 0) {
+			int step = DivideRoundingUp((2 * low - 1) * majorLength, 2 * minorLength);
+			if (step > first) {
+				first = step;
+			}
+		}
+
+		if (high < minorLength) {
+			int step = DivideRoundingUp((2 * high + 1) * majorLength, 2 * minorLength) - 1;
+			if (step < last) {
+				last = step;
+			}
+		}
+
+		if (first > last) {
+			return;
+		}
+	}
+
+	// Where the first step is, and the error term there
+	uint32_t error = majorLength;
+	int minor = 0;
+	if (first > 0) {
+		minor = Divide(2 * first * minorLength + majorLength, 2 * majorLength, &error);
+	}
+
+	int x = xMajor ? x0 + first * stepX : x0 + minor * stepX;
+	int y = xMajor ? y0 + minor * stepY : y0 + first * stepY;
+	uint16_t *pixel = &surface->pixels[y * surface->stride + x];
+
+	int majorStep = xMajor ? stepX : stepY * surface->stride;
+	int minorStep = xMajor ? stepY * surface->stride : stepX;
+	uint32_t errorStep = 2 * minorLength;
+	uint32_t errorLimit = 2 * majorLength;
+
+	for (int i = first; i <= last; ++i) {
+		*pixel = color;
+		pixel += majorStep;
+
+		error += errorStep;
+		if (error >= errorLimit) {
+			error -= errorLimit;
+			pixel += minorStep;
+		}
+	}
+}
+
+void GFX_DrawLine(
+	struct GFX_Surface *surface, int x0, int y0, int x1, int y1,
+	uint16_t color
+) {
+	DrawLine(surface, x0, y0, x1, y1, color, true);
+}
+
+void GFX_DrawPolyline(
+	struct GFX_Surface *surface, const struct GFX_Point *points, int numPoints,
+	uint16_t color
+) {
+	if (numPoints <= 0) {
+		return;
+	}
+
+	// Each line leaves off its last pixel, which is the first pixel of the
+	// next one
+	for (int i = 0; i < numPoints - 1; ++i) {
+		DrawLine(
+			surface, points[i].x, points[i].y, points[i + 1].x, points[i + 1].y,
+			color, false
+		);
+	}
+
+	// Unless that was the first point again, the last point is still to draw
+	const struct GFX_Point *end = &points[numPoints - 1];
+	if (numPoints < 3 || end->x != points[0].x || end->y != points[0].y) {
+		DrawLine(surface, end->x, end->y, end->x, end->y, color, true);
+	}
+}
+
+/**
+ * Blends @p color into the pixel at @p x, @p y, if it's inside the clip
+ * rectangle.
+ */
+static void BlendPixel(
+	struct GFX_Surface *surface, int x, int y, uint16_t color, int alpha
+) {
+	const struct GFX_Rect *clip = &surface->clip;
+	if (x < clip->x || x >= clip->x + clip->width || y < clip->y || y >= clip->y + clip->height) {
+		return;
+	}
+
+	uint16_t *pixel = &surface->pixels[y * surface->stride + x];
+	*pixel = GFX_BlendColor(*pixel, color, alpha);
+}
+
+void GFX_DrawLineAA(
+	struct GFX_Surface *surface, int x0, int y0, int x1, int y1,
+	uint16_t color
+) {
+	int lengthX = x1 >= x0 ? x1 - x0 : x0 - x1;
+	int lengthY = y1 >= y0 ? y1 - y0 : y0 - y1;
+
+	// Straight and diagonal lines go through the middle of every pixel, so
+	// there's nothing to smooth
+	if (lengthX == 0 || lengthY == 0 || lengthX == lengthY) {
+		DrawLine(surface, x0, y0, x1, y1, color, true);
+		return;
+	}
+
+	// If both ends are beyond the same side, none of the line is visible
+	const struct GFX_Rect *clip = &surface->clip;
+	if ((GetOutCode(clip, x0, y0) & GetOutCode(clip, x1, y1)) != 0) {
+		return;
+	}
+
+	bool xMajor = lengthX > lengthY;
+	int majorLength = xMajor ? lengthX : lengthY;
+	int minorLength = xMajor ? lengthY : lengthX;
+
+	// Always go forwards along the major axis
+	if ((xMajor && x1 < x0) || (!xMajor && y1 < y0)) {
+		int swap = x0;
+		x0 = x1;
+		x1 = swap;
+
+		swap = y0;
+		y0 = y1;
+		y1 = swap;
+	}
+
+	int major0 = xMajor ? x0 : y0;
+	int minor0 = xMajor ? y0 : x0;
+	int minorSign = (xMajor ? y1 >= y0 : x1 >= x0) ? 1 : -1;
+
+	// How far the line moves along the minor axis per step, in 65536ths of a
+	// pixel
+	int gradient = Divide(minorLength << 16, majorLength, nullptr) * minorSign;
+
+	// The ends are exactly on pixels
+	BlendPixel(surface, x0, y0, color, GFX_ALPHA_OPAQUE);
+	BlendPixel(surface, x1, y1, color, GFX_ALPHA_OPAQUE);
+
+	// Only the steps within the clip rectangle's extent along the major axis
+	int first = 1;
+	int last = majorLength - 1;
+	int majorLow = (xMajor ? clip->x : clip->y) - major0;
+	int majorHigh = majorLow + (xMajor ? clip->width : clip->height) - 1;
+	if (majorLow > first) {
+		first = majorLow;
+	}
+
+	if (majorHigh < last) {
+		last = majorHigh;
+	}
+
+	// Position along the minor axis, in 65536ths of a pixel from minor0
+	int position = first * gradient;
+	for (int i = first; i <= last; ++i) {
+		int minor = minor0 + (position >> 16);
+		int alpha = (position >> 11) & 0x1F;
+		int major = major0 + i;
+
+		if (xMajor) {
+			BlendPixel(surface, major, minor, color, GFX_ALPHA_OPAQUE - alpha);
+			BlendPixel(surface, major, minor + 1, color, alpha);
+		} else {
+			BlendPixel(surface, minor, major, color, GFX_ALPHA_OPAQUE - alpha);
+			BlendPixel(surface, minor + 1, major, color, alpha);
+		}
+
+		position += gradient;
+	}
+}
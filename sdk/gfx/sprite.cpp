@@ -0,0 +1,230 @@
+#include <sdk/gfx/copy.hpp>
+#include <sdk/gfx/sprite.hpp>
+
+// The longest run an RLE sprite's run header can hold, of either kind
+static const int MAX_RUN_LENGTH = 0xFF;
+
+/**
+ * The part of a sprite which is visible when it's drawn.
+ */
+struct SpriteClip {
+	/// The visible part, on the surface.
+	struct GFX_Rect rect;
+
+	/**
+	 * The sprite's column and row which end up at the top left of @ref rect,
+	 * and which way to step through the sprite to move right/down on the
+	 * surface (-1 if the sprite is flipped).
+	 */
+	int sourceX, sourceY;
+	int stepX, stepY;
+};
+
+/**
+ * Works out which part of a sprite of size @p width by @p height, drawn at
+ * @p x, @p y, is visible.
+ *
+ * @return False if none of it is.
+ */
+static bool ClipSprite(
+	const struct GFX_Surface *surface, int x, int y, int width, int height,
+	int flags, struct SpriteClip *clip
+) {
+	clip->rect.x = x;
+	clip->rect.y = y;
+	clip->rect.width = width;
+	clip->rect.height = height;
+	if (!GFX_ClipRect(surface, &clip->rect)) {
+		return false;
+	}
+
+	if ((flags & GFX_FlipHorizontal) != 0) {
+		clip->sourceX = x + width - 1 - clip->rect.x;
+		clip->stepX = -1;
+	} else {
+		clip->sourceX = clip->rect.x - x;
+		clip->stepX = 1;
+	}
+
+	if ((flags & GFX_FlipVertical) != 0) {
+		clip->sourceY = y + height - 1 - clip->rect.y;
+		clip->stepY = -1;
+	} else {
+		clip->sourceY = clip->rect.y - y;
+		clip->stepY = 1;
+	}
+
+	return true;
+}
+
+void GFX_DrawSprite(
+	struct GFX_Surface *surface, const struct GFX_Sprite *sprite,
+	int x, int y, int flags
+) {
+	struct SpriteClip clip;
+	if (!ClipSprite(surface, x, y, sprite->width, sprite->height, flags, &clip)) {
+		return;
+	}
+
+	uint16_t *destination = &surface->pixels[clip.rect.y * surface->stride + clip.rect.x];
+	const uint16_t *source = &sprite->pixels[clip.sourceY * sprite->width + clip.sourceX];
+	int sourceStride = clip.stepY * sprite->width;
+
+	for (int row = 0; row < clip.rect.height; ++row) {
+		if (clip.stepX > 0) {
+			GFX_CopySpan(destination, source, clip.rect.width);
+		} else {
+			for (int i = 0; i < clip.rect.width; ++i) {
+				destination[i] = source[-i];
+			}
+		}
+
+		destination += surface->stride;
+		source += sourceStride;
+	}
+}
+
+void GFX_DrawKeyedSprite(
+	struct GFX_Surface *surface, const struct GFX_Sprite *sprite,
+	int x, int y, uint16_t key, int flags
+) {
+	struct SpriteClip clip;
+	if (!ClipSprite(surface, x, y, sprite->width, sprite->height, flags, &clip)) {
+		return;
+	}
+
+	uint16_t *destination = &surface->pixels[clip.rect.y * surface->stride + clip.rect.x];
+	const uint16_t *source = &sprite->pixels[clip.sourceY * sprite->width + clip.sourceX];
+	int sourceStride = clip.stepY * sprite->width;
+
+	for (int row = 0; row < clip.rect.height; ++row) {
+		const uint16_t *pixel = source;
+		for (int i = 0; i < clip.rect.width; ++i) {
+			if (*pixel != key) {
+				destination[i] = *pixel;
+			}
+
+			pixel += clip.stepX;
+		}
+
+		destination += surface->stride;
+		source += sourceStride;
+	}
+}
+
+void GFX_DrawRLESprite(
+	struct GFX_Surface *surface, const struct GFX_RLESprite *sprite,
+	int x, int y, int flags
+) {
+	struct SpriteClip clip;
+	if (!ClipSprite(surface, x, y, sprite->width, sprite->height, flags, &clip)) {
+		return;
+	}
+
+	// The visible columns of the sprite, from first to last
+	int firstColumn = clip.sourceX;
+	if (clip.stepX < 0) {
+		firstColumn -= clip.rect.width - 1;
+	}
+	int endColumn = firstColumn + clip.rect.width;
+
+	uint16_t *destination = &surface->pixels[clip.rect.y * surface->stride];
+	int sourceY = clip.sourceY;
+
+	for (int row = 0; row < clip.rect.height; ++row) {
+		const uint16_t *run = &sprite->data[sprite->data[sourceY]];
+
+		int column = 0;
+		while (column < endColumn) {
+			int skip = *run >> 8;
+			int count = *run & 0xFF;
+			const uint16_t *pixels = run + 1;
+			run += 1 + count;
+
+			// The opaque part of the run, limited to what's visible
+			int start = column + skip;
+			int end = start + count;
+			column = end;
+
+			if (start < firstColumn) {
+				pixels += firstColumn - start;
+				start = firstColumn;
+			}
+
+			if (end > endColumn) {
+				end = endColumn;
+			}
+
+			if (start >= end) {
+				continue;
+			}
+
+			if (clip.stepX > 0) {
+				GFX_CopySpan(&destination[x + start], pixels, end - start);
+			} else {
+				uint16_t *pixel = &destination[x + sprite->width - 1 - start];
+				for (int i = 0; i < end - start; ++i) {
+					pixel[-i] = pixels[i];
+				}
+			}
+		}
+
+		destination += surface->stride;
+		sourceY += clip.stepY;
+	}
+}
+
+int GFX_EncodeRLESprite(
+	const struct GFX_Sprite *sprite, uint16_t key, uint16_t *data, int size
+) {
+	// First count how much space is needed, then (if there's enough) go
+	// through again, writing it out
+	int length = 0;
+	for (int pass = 0; pass < 2; ++pass) {
+		bool write = pass == 1;
+		int offset = sprite->height;
+
+		for (int y = 0; y < sprite->height; ++y) {
+			const uint16_t *row = &sprite->pixels[y * sprite->width];
+
+			if (write) {
+				data[y] = offset;
+			}
+
+			int x = 0;
+			while (x < sprite->width) {
+				int skip = 0;
+				while (x < sprite->width && row[x] == key && skip < MAX_RUN_LENGTH) {
+					skip++;
+					x++;
+				}
+
+				int count = 0;
+				while (x + count < sprite->width && row[x + count] != key && count < MAX_RUN_LENGTH) {
+					count++;
+				}
+
+				if (write) {
+					data[offset] = (skip << 8) | count;
+					for (int i = 0; i < count; ++i) {
+						data[offset + 1 + i] = row[x + i];
+					}
+				}
+
+				offset += 1 + count;
+				x += count;
+			}
+		}
+
+		length = offset;
+		if (length > 0xFFFF) {
+			return 0;
+		}
+
+		if (data == nullptr || length > size) {
+			break;
+		}
+	}
+
+	return length;
+}
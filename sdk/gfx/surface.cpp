@@ -0,0 +1,61 @@
+#include <sdk/gfx/surface.hpp>
+
+void GFX_InitSurface(struct GFX_Surface *surface, uint16_t *pixels, int width, int height) {
+	surface->pixels = pixels;
+	surface->width = width;
+	surface->height = height;
+	surface->stride = width;
+
+	GFX_SetClip(surface, nullptr);
+}
+
+/**
+ * Shrinks @p rect to the part of it which is inside the rectangle from
+ * @p left, @p top to (but not including) @p right, @p bottom.
+ */
+static bool Intersect(struct GFX_Rect *rect, int left, int top, int right, int bottom) {
+	if (rect->x < left) {
+		rect->width -= left - rect->x;
+		rect->x = left;
+	}
+
+	if (rect->y < top) {
+		rect->height -= top - rect->y;
+		rect->y = top;
+	}
+
+	if (rect->width > right - rect->x) {
+		rect->width = right - rect->x;
+	}
+
+	if (rect->height > bottom - rect->y) {
+		rect->height = bottom - rect->y;
+	}
+
+	return rect->width > 0 && rect->height > 0;
+}
+
+void GFX_SetClip(struct GFX_Surface *surface, const struct GFX_Rect *clip) {
+	struct GFX_Rect *rect = &surface->clip;
+
+	if (clip == nullptr) {
+		rect->x = 0;
+		rect->y = 0;
+		rect->width = surface->width;
+		rect->height = surface->height;
+		return;
+	}
+
+	*rect = *clip;
+	if (!Intersect(rect, 0, 0, surface->width, surface->height)) {
+		rect->width = 0;
+		rect->height = 0;
+	}
+}
+
+bool GFX_ClipRect(const struct GFX_Surface *surface, struct GFX_Rect *rect) {
+	const struct GFX_Rect *clip = &surface->clip;
+	return Intersect(
+		rect, clip->x, clip->y, clip->x + clip->width, clip->y + clip->height
+	);
+}
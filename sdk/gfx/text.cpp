@@ -0,0 +1,184 @@
+#include <sdk/gfx/text.hpp>
+
+/**
+ * For each possible group of four glyph bits, a mask of the pixels they set
+ * (leftmost pixel first). Combining colors with these rather than testing
+ * each bit keeps the inner loops free of branches.
+ */
+static const uint16_t NIBBLE_MASKS[16][4] = {
+	{0x0000, 0x0000, 0x0000, 0x0000},
+	{0x0000, 0x0000, 0x0000, 0xFFFF},
+	{0x0000, 0x0000, 0xFFFF, 0x0000},
+	{0x0000, 0x0000, 0xFFFF, 0xFFFF},
+	{0x0000, 0xFFFF, 0x0000, 0x0000},
+	{0x0000, 0xFFFF, 0x0000, 0xFFFF},
+	{0x0000, 0xFFFF, 0xFFFF, 0x0000},
+	{0x0000, 0xFFFF, 0xFFFF, 0xFFFF},
+	{0xFFFF, 0x0000, 0x0000, 0x0000},
+	{0xFFFF, 0x0000, 0x0000, 0xFFFF},
+	{0xFFFF, 0x0000, 0xFFFF, 0x0000},
+	{0xFFFF, 0x0000, 0xFFFF, 0xFFFF},
+	{0xFFFF, 0xFFFF, 0x0000, 0x0000},
+	{0xFFFF, 0xFFFF, 0x0000, 0xFFFF},
+	{0xFFFF, 0xFFFF, 0xFFFF, 0x0000},
+	{0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF}
+};
+
+/**
+ * Draws @p count pixels of a row of a glyph. @p bits holds the row, with the
+ * first pixel to draw in the most significant bit.
+ *
+ * If @p opaque is false, the background is left as it is and @p background
+ * is ignored.
+ */
+static void DrawGlyphRow(
+	uint16_t *pixels, uint32_t bits, int count,
+	uint16_t foreground, uint16_t background, bool opaque
+) {
+	if (opaque) {
+		for (; count >= 4; count -= 4) {
+			const uint16_t *masks = NIBBLE_MASKS[bits >> 28];
+			pixels[0] = (foreground & masks[0]) | (background & ~masks[0]);
+			pixels[1] = (foreground & masks[1]) | (background & ~masks[1]);
+			pixels[2] = (foreground & masks[2]) | (background & ~masks[2]);
+			pixels[3] = (foreground & masks[3]) | (background & ~masks[3]);
+			pixels += 4;
+			bits <<= 4;
+		}
+
+		const uint16_t *masks = NIBBLE_MASKS[bits >> 28];
+		for (int i = 0; i < count; ++i) {
+			pixels[i] = (foreground & masks[i]) | (background & ~masks[i]);
+		}
+	} else {
+		for (; count >= 4; count -= 4) {
+			const uint16_t *masks = NIBBLE_MASKS[bits >> 28];
+			pixels[0] = (foreground & masks[0]) | (pixels[0] & ~masks[0]);
+			pixels[1] = (foreground & masks[1]) | (pixels[1] & ~masks[1]);
+			pixels[2] = (foreground & masks[2]) | (pixels[2] & ~masks[2]);
+			pixels[3] = (foreground & masks[3]) | (pixels[3] & ~masks[3]);
+			pixels += 4;
+			bits <<= 4;
+		}
+
+		const uint16_t *masks = NIBBLE_MASKS[bits >> 28];
+		for (int i = 0; i < count; ++i) {
+			pixels[i] = (foreground & masks[i]) | (pixels[i] & ~masks[i]);
+		}
+	}
+}
+
+/**
+ * Draws one character, clipped to the surface's clip rectangle.
+ */
+static void DrawGlyph(
+	struct GFX_Surface *surface, const struct GFX_Font *font, int x, int y,
+	char c, uint16_t foreground, uint16_t background, bool opaque
+) {
+	struct GFX_Rect rect = {x, y, font->width, font->height};
+	if (!GFX_ClipRect(surface, &rect)) {
+		return;
+	}
+
+	int bytesPerRow = (font->width + 7) >> 3;
+	const uint8_t *glyph = nullptr;
+	if (c >= font->first && c <= font->last) {
+		glyph = &font->glyphs[(c - font->first) * font->height * bytesPerRow];
+		glyph += (rect.y - y) * bytesPerRow;
+	}
+
+	int skipColumns = rect.x - x;
+	uint16_t *row = &surface->pixels[rect.y * surface->stride + rect.x];
+
+	for (int i = 0; i < rect.height; ++i) {
+		uint32_t bits = 0;
+		if (glyph != nullptr) {
+			for (int j = 0; j < bytesPerRow; ++j) {
+				bits |= static_cast<uint32_t>(glyph[j]) << (24 - 8 * j);
+			}
+			glyph += bytesPerRow;
+		}
+
+		DrawGlyphRow(row, bits << skipColumns, rect.width, foreground, background, opaque);
+		row += surface->stride;
+	}
+}
+
+static void DrawText(
+	struct GFX_Surface *surface, const struct GFX_Font *font, int x, int y,
+	const char *text, uint16_t foreground, uint16_t background, bool opaque
+) {
+	int lineX = x;
+
+	for (; *text != '\0'; ++text) {
+		if (*text == '\n') {
+			x = lineX;
+			y += font->height;
+			continue;
+		}
+
+		DrawGlyph(surface, font, x, y, *text, foreground, background, opaque);
+		x += font->width;
+	}
+}
+
+void GFX_DrawText(
+	struct GFX_Surface *surface, const struct GFX_Font *font, int x, int y,
+	const char *text, uint16_t foreground, uint16_t background
+) {
+	DrawText(surface, font, x, y, text, foreground, background, true);
+}
+
+void GFX_DrawTextTransparent(
+	struct GFX_Surface *surface, const struct GFX_Font *font, int x, int y,
+	const char *text, uint16_t foreground
+) {
+	DrawText(surface, font, x, y, text, foreground, 0, false);
+}
+
+int GFX_MeasureText(const struct GFX_Font *font, const char *text) {
+	int widest = 0;
+	int width = 0;
+
+	for (; *text != '\0'; ++text) {
+		if (*text == '\n') {
+			width = 0;
+			continue;
+		}
+
+		width += font->width;
+		if (width > widest) {
+			widest = width;
+		}
+	}
+
+	return widest;
+}
+
+int GFX_FormatNumber(char *buffer, int value, int minDigits) {
+	// Worked out as unsigned, so the most negative int doesn't overflow
+	uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) : value;
+
+	char digits[10];
+	int numDigits = 0;
+	do {
+		digits[numDigits++] = '0' + magnitude % 10;
+		magnitude /= 10;
+	} while (magnitude != 0);
+
+	int length = 0;
+	if (value < 0) {
+		buffer[length++] = '-';
+	}
+
+	for (int i = numDigits; i < minDigits; ++i) {
+		buffer[length++] = '0';
+	}
+
+	while (numDigits > 0) {
+		buffer[length++] = digits[--numDigits];
+	}
+
+	buffer[length] = '\0';
+	return length;
+}
@@ -0,0 +1,39 @@
+#include <sdk/gfx/dirty.hpp>
+#include <sdk/gfx/indexed.hpp>
+#include <sdk/gfx/surface.hpp>
+#include <sdk/os/lcd.hpp>
+
+/*
+ * Kept apart from the rest of sdk/gfx, as these are the only parts which use
+ * the OS - the others can be built on a PC on their own.
+ */
+
+void GFX_GetVRAMSurface(struct GFX_Surface *surface) {
+	int width, height;
+	LCD_GetSize(&width, &height);
+
+	GFX_InitSurface(surface, LCD_GetVRAMAddress(), width, height);
+}
+
+void GFX_RefreshIfDirty(struct GFX_DirtyRegion *region) {
+	if (region->numRects == 0) {
+		return;
+	}
+
+	LCD_Refresh();
+	GFX_ClearDirty(region);
+}
+
+void GFX_PresentIndexed(
+	const struct GFX_IndexedSurface *surface, const struct GFX_Palette *palette,
+	struct GFX_DirtyRegion *dirty
+) {
+	struct GFX_Surface vram;
+	GFX_GetVRAMSurface(&vram);
+
+	for (int i = 0; i < dirty->numRects; ++i) {
+		GFX_ExpandIndexed(&vram, surface, palette, &dirty->rects[i]);
+	}
+
+	GFX_RefreshIfDirty(dirty);
+}
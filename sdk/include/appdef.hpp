@@ -1,4 +1,12 @@
 #pragma once
+#include <stdint.h>
+
+/**
+ * The version of the SDK. Apps built with @ref APP_INFO record the version they
+ * were built against, and the launcher refuses to run apps built against a
+ * newer SDK than itself.
+ */
+#define HOLLYHOCK_SDK_VERSION 1
 
 // volatile so the compiler doesn't optimise the section out
 #define HOLLYHOCK_SECTION_STRING(name, str) \
@@ -13,3 +21,182 @@
     HOLLYHOCK_SECTION_STRING(author, app_author)
 #define APP_VERSION(app_version) \
     HOLLYHOCK_SECTION_STRING(version, app_version)
+
+/// "HHKM"
+const uint32_t HOLLYHOCK_META_MAGIC = 0x48484B4D;
+const uint16_t HOLLYHOCK_META_VERSION = 2;
+
+/**
+ * Set in @ref HollyhockMetaHeader::flags if @ref HollyhockMetaHeader::crc32
+ * holds a checksum of the app, which the launcher verifies before running it.
+ * Set by @c tools/hhk_checksum.py after the app is linked.
+ */
+const uint16_t HOLLYHOCK_META_FLAG_CRC32 = 1 << 0;
+
+/**
+ * Indexes into @ref HollyhockMetaHeader::fields.
+ */
+enum HollyhockMetaField {
+    HollyhockMetaName = 0,
+    HollyhockMetaDescription = 1,
+    HollyhockMetaAuthor = 2,
+    HollyhockMetaVersion = 3,
+    HollyhockMetaNumFields = 4
+};
+
+/**
+ * Header of the @c .hollyhock_meta section, generated by @ref APP_INFO. The
+ * strings it refers to follow it in the section.
+ */
+struct HollyhockMetaHeader {
+    /// Always @ref HOLLYHOCK_META_MAGIC.
+    uint32_t magic;
+    /// The version of this header's layout, @ref HOLLYHOCK_META_VERSION.
+    uint16_t version;
+    /// A combination of the @c HOLLYHOCK_META_FLAG_* values.
+    uint16_t flags;
+    /// The @ref HOLLYHOCK_SDK_VERSION the app was built against.
+    uint16_t minSDKVersion;
+    uint16_t reserved;
+    /// Reserved, always 0. Icons are set with @ref APP_ICON instead.
+    uint32_t iconOffset;
+
+    /**
+     * The location of each string, indexed by @ref HollyhockMetaField.
+     * Offsets are from the start of the section, and lengths don't include the
+     * null terminator.
+     */
+    struct {
+        uint16_t offset;
+        uint16_t length;
+    } fields[HollyhockMetaNumFields];
+
+    /**
+     * CRC-32 of the file contents of the app's loadable segments, if
+     * @ref HOLLYHOCK_META_FLAG_CRC32 is set. Added in version 2.
+     */
+    uint32_t crc32;
+};
+
+/// @cond INTERNAL
+#define HOLLYHOCK_META_FIELD(offset, str) \
+    { static_cast<uint16_t>(offset), static_cast<uint16_t>(sizeof(str) - 1) }
+/// @endcond
+
+/**
+ * Sets all of the app's information at once, in a single @c .hollyhock_meta
+ * section. The launcher can find and read this much faster than the separate
+ * sections generated by @ref APP_NAME and friends.
+ *
+ * Pass an empty string for any field you don't wish to provide.
+ */
+#define APP_INFO(app_name, app_description, app_author, app_version) \
+    __attribute__ ((section(".hollyhock_meta"), used)) \
+    const struct { \
+        struct HollyhockMetaHeader header; \
+        char name[sizeof(app_name)]; \
+        char description[sizeof(app_description)]; \
+        char author[sizeof(app_author)]; \
+        char version[sizeof(app_version)]; \
+    } hollyhock_meta = { \
+        { \
+            HOLLYHOCK_META_MAGIC, HOLLYHOCK_META_VERSION, 0, \
+            HOLLYHOCK_SDK_VERSION, 0, 0, \
+            { \
+                HOLLYHOCK_META_FIELD( \
+                    sizeof(struct HollyhockMetaHeader), \
+                    app_name \
+                ), \
+                HOLLYHOCK_META_FIELD( \
+                    sizeof(struct HollyhockMetaHeader) + sizeof(app_name), \
+                    app_description \
+                ), \
+                HOLLYHOCK_META_FIELD( \
+                    sizeof(struct HollyhockMetaHeader) + sizeof(app_name) + \
+                        sizeof(app_description), \
+                    app_author \
+                ), \
+                HOLLYHOCK_META_FIELD( \
+                    sizeof(struct HollyhockMetaHeader) + sizeof(app_name) + \
+                        sizeof(app_description) + sizeof(app_author), \
+                    app_version \
+                ) \
+            }, \
+            0 \
+        }, \
+        app_name, app_description, app_author, app_version \
+    };
+
+/// "HHIC"
+const uint32_t HOLLYHOCK_ICON_MAGIC = 0x48484943;
+
+/**
+ * The largest icon the launcher will show, in either dimension.
+ */
+const uint16_t HOLLYHOCK_ICON_MAX_SIZE = 32;
+
+/**
+ * The ways an icon's pixels can be stored, set in
+ * @ref HollyhockIconHeader::format.
+ */
+enum HollyhockIconFormat {
+    /// One RGB565 value per pixel, row by row.
+    HollyhockIconRGB565 = 0,
+
+    /**
+     * A palette of 16 RGB565 colors, followed by a 4-bit palette index per
+     * pixel. Indexes are packed four to a @c uint16_t, with the leftmost
+     * pixel in the top bits, and each row starts on a new @c uint16_t.
+     */
+    HollyhockIconPalette16 = 1
+};
+
+/**
+ * Header of the @c .hollyhock_icon section, generated by @ref APP_ICON. The
+ * icon's pixel data follows it in the section.
+ */
+struct HollyhockIconHeader {
+    /// Always @ref HOLLYHOCK_ICON_MAGIC.
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+    /// A @ref HollyhockIconFormat.
+    uint16_t format;
+    uint16_t reserved;
+};
+
+/**
+ * The number of @c uint16_t values of pixel data in an icon.
+ */
+#define HOLLYHOCK_ICON_DATA_SIZE(width, height, format) ( \
+    (format) == HollyhockIconPalette16 ? \
+        16 + (((width) + 3) / 4) * (height) : \
+        (width) * (height) \
+)
+
+/**
+ * Sets the icon the launcher shows for the app, in a @c .hollyhock_icon
+ * section. Icons can be up to @ref HOLLYHOCK_ICON_MAX_SIZE pixels square.
+ *
+ * The pixel data is given as a list of @c uint16_t values, laid out as
+ * described by @p format (see @ref HollyhockIconFormat).
+ *
+ * Example: a 4x2 icon, with the top row red and the bottom row blue
+ * @code{cpp}
+ * APP_ICON(4, 2, HollyhockIconPalette16,
+ *     RGB_TO_RGB565(0x1F, 0, 0), RGB_TO_RGB565(0, 0, 0x1F),
+ *     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+ *     0x0000,
+ *     0x1111
+ * );
+ * @endcode
+ */
+#define APP_ICON(width, height, format, ...) \
+    __attribute__ ((section(".hollyhock_icon"), used)) \
+    const struct { \
+        struct HollyhockIconHeader header; \
+        uint16_t data[HOLLYHOCK_ICON_DATA_SIZE(width, height, format)]; \
+    } hollyhock_icon = { \
+        { HOLLYHOCK_ICON_MAGIC, width, height, format, 0 }, \
+        { __VA_ARGS__ } \
+    };
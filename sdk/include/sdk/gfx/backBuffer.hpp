@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @brief Drawing off-screen, then putting the finished frame in VRAM.
+ *
+ * Drawing straight into VRAM means a half-drawn frame can end up on the
+ * display. Instead, draw into a back buffer's @ref GFX_BackBuffer::surface,
+ * mark what changed in its @ref GFX_BackBuffer::dirty region, and call
+ * @ref GFX_Present once the frame is done. Only the rectangles marked dirty
+ * are copied into VRAM.
+ *
+ * Only VRAM is ever written to, never the OS's backup of it, so an app should
+ * still call @ref LCD_VRAMBackup before it starts and @ref LCD_VRAMRestore
+ * before it exits.
+ *
+ * Example: a game loop
+ * @code{cpp}
+ * LCD_VRAMBackup();
+ *
+ * struct GFX_BackBuffer buffer;
+ * if (!GFX_CreateBackBuffer(&buffer)) {
+ *     LCD_VRAMRestore();
+ *     return;
+ * }
+ *
+ * while (running) {
+ *     GFX_FillRect(&buffer.surface, x, y, 20, 20, color);
+ *     GFX_MarkDirty(&buffer.dirty, x, y, 20, 20);
+ *
+ *     GFX_Present(&buffer);
+ * }
+ *
+ * GFX_DestroyBackBuffer(&buffer);
+ * LCD_VRAMRestore();
+ * LCD_Refresh();
+ * @endcode
+ */
+
+#pragma once
+#include "dirty.hpp"
+#include "surface.hpp"
+
+/**
+ * An off-screen buffer the size of the display.
+ */
+struct GFX_BackBuffer {
+	/// The surface to draw the next frame on.
+	struct GFX_Surface surface;
+
+	/// The parts of @ref surface which have changed since the last present.
+	struct GFX_DirtyRegion dirty;
+
+	/// VRAM, which is copied to when presenting.
+	struct GFX_Surface vram;
+};
+
+/**
+ * Allocates a back buffer. It starts off with a copy of what's in VRAM, so
+ * only what's drawn over it needs to be marked dirty.
+ *
+ * @param[out] buffer The back buffer to set up.
+ * @return True on success, or false if there wasn't enough memory.
+ */
+bool GFX_CreateBackBuffer(struct GFX_BackBuffer *buffer);
+
+/**
+ * Frees a back buffer. VRAM is left as it was when last presented.
+ *
+ * @param buffer The back buffer to free.
+ */
+void GFX_DestroyBackBuffer(struct GFX_BackBuffer *buffer);
+
+/**
+ * Copies the parts of the back buffer which are marked dirty into VRAM, and
+ * puts them on the display (see @ref GFX_RefreshIfDirty). If nothing is marked
+ * dirty, nothing happens - use @ref GFX_MarkAllDirty after redrawing the
+ * whole frame.
+ *
+ * @param buffer The back buffer to present.
+ */
+void GFX_Present(struct GFX_BackBuffer *buffer);
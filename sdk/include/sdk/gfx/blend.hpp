@@ -0,0 +1,130 @@
+/**
+ * @file
+ * @brief Blending and recoloring RGB565 pixels.
+ *
+ * Each function works on a span of pixels, two at a time: the red, green and
+ * blue fields of a pair of pixels are spread out over two 32-bit values with
+ * room between them, so one multiply works on three fields at once. The
+ * results are exactly the same as working on each channel on its own.
+ *
+ * Blending takes an alpha between 0 (none of the new color) and
+ * @ref GFX_ALPHA_OPAQUE (all of it). Each channel ends up as
+ * <tt>(color * alpha + old * (32 - alpha)) >> 5</tt>.
+ *
+ * Example: dimming the screen behind a dialog
+ * @code{cpp}
+ * struct GFX_Surface screen;
+ * GFX_GetVRAMSurface(&screen);
+ *
+ * GFX_BlendRect(&screen, 0, 0, screen.width, screen.height, 0, GFX_ALPHA_OPAQUE / 2);
+ * GFX_FillRect(&screen, 40, 200, 240, 100, 0xFFFF);
+ * LCD_Refresh();
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "surface.hpp"
+
+/**
+ * The alpha which replaces a pixel with the new color completely.
+ */
+const int GFX_ALPHA_OPAQUE = 32;
+
+/**
+ * Blends one pixel.
+ *
+ * @param background The existing color, in RGB565 format.
+ * @param color The color to blend in, in RGB565 format.
+ * @param alpha How much of @p color to use, between 0 and
+ * @ref GFX_ALPHA_OPAQUE.
+ * @return The blended color.
+ */
+uint16_t GFX_BlendColor(uint16_t background, uint16_t color, int alpha);
+
+/**
+ * Blends a row of pixels over another, such as for fading between two
+ * frames. This and the other span functions aren't clipped, so are only
+ * needed when working with pixel pointers directly.
+ *
+ * @param destination The first pixel to blend into.
+ * @param source The first pixel to blend in.
+ * @param count The number of pixels.
+ * @param alpha How much of @p source to use, between 0 and
+ * @ref GFX_ALPHA_OPAQUE.
+ */
+void GFX_BlendSpan(uint16_t *destination, const uint16_t *source, int count, int alpha);
+
+/**
+ * Blends one color into a row of pixels, such as for a translucent overlay.
+ *
+ * @param pixels The first pixel.
+ * @param count The number of pixels.
+ * @param color The color to blend in, in RGB565 format.
+ * @param alpha How much of @p color to use, between 0 and
+ * @ref GFX_ALPHA_OPAQUE.
+ */
+void GFX_BlendColorSpan(uint16_t *pixels, int count, uint16_t color, int alpha);
+
+/**
+ * Darkens a row of pixels - the same as blending in black.
+ *
+ * @param pixels The first pixel.
+ * @param count The number of pixels.
+ * @param alpha How much darker, between 0 (no change) and
+ * @ref GFX_ALPHA_OPAQUE (black).
+ */
+void GFX_DarkenSpan(uint16_t *pixels, int count, int alpha);
+
+/**
+ * Lightens a row of pixels - the same as blending in white.
+ *
+ * @param pixels The first pixel.
+ * @param count The number of pixels.
+ * @param alpha How much lighter, between 0 (no change) and
+ * @ref GFX_ALPHA_OPAQUE (white).
+ */
+void GFX_LightenSpan(uint16_t *pixels, int count, int alpha);
+
+/**
+ * Inverts the colors of a row of pixels.
+ *
+ * @param pixels The first pixel.
+ * @param count The number of pixels.
+ */
+void GFX_InvertSpan(uint16_t *pixels, int count);
+
+/**
+ * Turns a row of pixels gray, keeping their brightness.
+ *
+ * @param pixels The first pixel.
+ * @param count The number of pixels.
+ */
+void GFX_GrayscaleSpan(uint16_t *pixels, int count);
+
+/**
+ * Tints a row of pixels, as if seen through colored glass: each channel is
+ * scaled by the same channel of @p color. White leaves the pixels as they
+ * are.
+ *
+ * @param pixels The first pixel.
+ * @param count The number of pixels.
+ * @param color The tint, in RGB565 format.
+ */
+void GFX_TintSpan(uint16_t *pixels, int count, uint16_t color);
+
+/**
+ * Blends one color into a rectangle. Anything outside the surface's clip
+ * rectangle is left alone.
+ *
+ * @param surface The surface to draw on.
+ * @param x,y The top left pixel of the rectangle.
+ * @param width,height The size of the rectangle, in pixels.
+ * @param color The color to blend in, in RGB565 format.
+ * @param alpha How much of @p color to use, between 0 and
+ * @ref GFX_ALPHA_OPAQUE.
+ */
+void GFX_BlendRect(
+	struct GFX_Surface *surface, int x, int y, int width, int height,
+	uint16_t color, int alpha
+);
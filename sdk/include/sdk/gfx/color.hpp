@@ -0,0 +1,23 @@
+/**
+ * @file
+ * @brief RGB565 versions of the OS's palette colors.
+ *
+ * The OS's @ref palette_colors are indices, for @ref LCD_SetPixelFromPalette.
+ * @ref GFX_PALETTE_COLORS gives the same colors in RGB565, so they can be
+ * drawn onto any surface.
+ *
+ * Example: a red square
+ * @code{cpp}
+ * GFX_FillRect(&screen, 10, 10, 20, 20, GFX_PALETTE_COLORS[PALETTE_RED]);
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "../os/lcd.hpp"
+
+/**
+ * RGB565 versions of the @ref palette_colors, indexed by @c PALETTE_BLACK
+ * to @c PALETTE_WHITE.
+ */
+extern const uint16_t GFX_PALETTE_COLORS[8];
@@ -0,0 +1,37 @@
+/**
+ * @file
+ * @brief Copying pixels from one surface to another.
+ *
+ * Where the source and destination pixels line up the same way in memory
+ * (which they always do when both surfaces are the size of the screen),
+ * pixels are copied two at a time.
+ */
+
+#pragma once
+#include <stdint.h>
+#include "surface.hpp"
+
+/**
+ * Copies @p count pixels in a row. This isn't clipped, so is only needed when
+ * working with pixel pointers directly. The two rows must not overlap.
+ *
+ * @param destination The first pixel to copy to.
+ * @param source The first pixel to copy from.
+ * @param count The number of pixels to copy. Nothing is copied if it's 0 or
+ * negative.
+ */
+void GFX_CopySpan(uint16_t *destination, const uint16_t *source, int count);
+
+/**
+ * Copies a rectangle of pixels to the same place on another surface, such as
+ * from an off-screen buffer to VRAM. The rectangle is clipped to both
+ * surfaces.
+ *
+ * @param destination The surface to copy to.
+ * @param source The surface to copy from.
+ * @param rect The rectangle to copy.
+ */
+void GFX_CopyRect(
+	struct GFX_Surface *destination, const struct GFX_Surface *source,
+	const struct GFX_Rect *rect
+);
@@ -0,0 +1,102 @@
+/**
+ * @file
+ * @brief Keeping track of which parts of the screen have changed.
+ *
+ * Drawing code marks the rectangles it has drawn over with
+ * @ref GFX_MarkDirty. Rectangles which overlap or touch are merged as
+ * they're marked, so only a handful are ever kept, and no part of the screen
+ * is counted twice. @ref GFX_RefreshIfDirty then refreshes the display, but
+ * only if anything was marked.
+ *
+ * Example: moving a 20x20 block without redrawing the screen
+ * @code{cpp}
+ * struct GFX_Surface screen;
+ * GFX_GetVRAMSurface(&screen);
+ *
+ * struct GFX_DirtyRegion dirty;
+ * GFX_InitDirtyRegion(&dirty, screen.width, screen.height);
+ *
+ * GFX_FillRect(&screen, oldX, oldY, 20, 20, background);
+ * GFX_MarkDirty(&dirty, oldX, oldY, 20, 20);
+ *
+ * GFX_FillRect(&screen, newX, newY, 20, 20, foreground);
+ * GFX_MarkDirty(&dirty, newX, newY, 20, 20);
+ *
+ * GFX_RefreshIfDirty(&dirty);
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "surface.hpp"
+
+/**
+ * The most rectangles a @ref GFX_DirtyRegion keeps. Past this, a new
+ * rectangle is merged with whichever existing one grows the least by taking
+ * it in.
+ */
+const int GFX_DIRTY_MAX_RECTS = 8;
+
+/**
+ * The parts of a surface which have changed. None of the rectangles overlap
+ * or touch.
+ */
+struct GFX_DirtyRegion {
+	struct GFX_Rect rects[GFX_DIRTY_MAX_RECTS];
+	int numRects;
+
+	/// The size of the surface being tracked - marks are clipped to it.
+	int width, height;
+};
+
+/**
+ * Sets up a dirty region with nothing marked.
+ *
+ * @param[out] region The dirty region to set up.
+ * @param width,height The size of the surface being tracked, in pixels.
+ */
+void GFX_InitDirtyRegion(struct GFX_DirtyRegion *region, int width, int height);
+
+/**
+ * Marks a rectangle as changed.
+ *
+ * @param region The dirty region to add the rectangle to.
+ * @param x,y The top left corner of the rectangle.
+ * @param width,height The size of the rectangle, in pixels.
+ */
+void GFX_MarkDirty(struct GFX_DirtyRegion *region, int x, int y, int width, int height);
+
+/**
+ * Marks the whole surface as changed.
+ *
+ * @param region The dirty region.
+ */
+void GFX_MarkAllDirty(struct GFX_DirtyRegion *region);
+
+/**
+ * Forgets everything which has been marked, once it's been dealt with.
+ *
+ * @param region The dirty region.
+ */
+void GFX_ClearDirty(struct GFX_DirtyRegion *region);
+
+/**
+ * Returns how many pixels have been marked as changed.
+ *
+ * @param region The dirty region.
+ * @return The total area of the dirty rectangles, in pixels.
+ */
+int GFX_GetDirtyArea(const struct GFX_DirtyRegion *region);
+
+/**
+ * Refreshes the display if anything in VRAM has changed, then clears the
+ * region.
+ *
+ * This isn't a partial refresh: the OS only has a way to refresh the whole
+ * display (@ref LCD_Refresh), so that's what happens if anything has changed.
+ * What the region saves is the refresh of frames where nothing has, and the
+ * copying of the parts which haven't (see @ref GFX_Present).
+ *
+ * @param region The dirty region, tracking VRAM.
+ */
+void GFX_RefreshIfDirty(struct GFX_DirtyRegion *region);
@@ -0,0 +1,79 @@
+/**
+ * @file
+ * @brief Drawing circles and ellipses.
+ *
+ * Outlines are worked out with the midpoint (Bresenham) method, stepping
+ * around the edge with additions only. Filled shapes are drawn a row at a
+ * time, as one horizontal line per row, so the cost is in proportion to the
+ * perimeter plus the (fast) filling of each row. Everything is clipped to the
+ * surface's clip rectangle. Radii must be less than 32768.
+ *
+ * Example: a red dot with a black ring around it
+ * @code{cpp}
+ * GFX_FillCircle(&screen, 100, 100, 10, RGB_TO_RGB565(0x1F, 0, 0));
+ * GFX_DrawCircle(&screen, 100, 100, 12, RGB_TO_RGB565(0, 0, 0));
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "surface.hpp"
+
+/**
+ * Draws the outline of a circle, one pixel thick.
+ *
+ * @param surface The surface to draw on.
+ * @param centerX,centerY The center of the circle.
+ * @param radius The radius of the circle, in pixels. A radius of 0 draws one
+ * pixel. Nothing is drawn if it's negative.
+ * @param color The color of the outline, in RGB565 format.
+ */
+void GFX_DrawCircle(
+	struct GFX_Surface *surface, int centerX, int centerY, int radius,
+	uint16_t color
+);
+
+/**
+ * Fills a circle. It covers exactly the pixels inside (and on) the outline
+ * @ref GFX_DrawCircle draws.
+ *
+ * @param surface The surface to draw on.
+ * @param centerX,centerY The center of the circle.
+ * @param radius The radius of the circle, in pixels. A radius of 0 draws one
+ * pixel. Nothing is drawn if it's negative.
+ * @param color The color to fill it with, in RGB565 format.
+ */
+void GFX_FillCircle(
+	struct GFX_Surface *surface, int centerX, int centerY, int radius,
+	uint16_t color
+);
+
+/**
+ * Draws the outline of an ellipse, one pixel thick. Its axes are horizontal
+ * and vertical.
+ *
+ * @param surface The surface to draw on.
+ * @param centerX,centerY The center of the ellipse.
+ * @param radiusX,radiusY Half the width and height of the ellipse, in pixels.
+ * Nothing is drawn if either is negative.
+ * @param color The color of the outline, in RGB565 format.
+ */
+void GFX_DrawEllipse(
+	struct GFX_Surface *surface, int centerX, int centerY,
+	int radiusX, int radiusY, uint16_t color
+);
+
+/**
+ * Fills an ellipse. It covers exactly the pixels inside (and on) the outline
+ * @ref GFX_DrawEllipse draws.
+ *
+ * @param surface The surface to draw on.
+ * @param centerX,centerY The center of the ellipse.
+ * @param radiusX,radiusY Half the width and height of the ellipse, in pixels.
+ * Nothing is drawn if either is negative.
+ * @param color The color to fill it with, in RGB565 format.
+ */
+void GFX_FillEllipse(
+	struct GFX_Surface *surface, int centerX, int centerY,
+	int radiusX, int radiusY, uint16_t color
+);
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @brief Filling lines and rectangles with a solid color.
+ *
+ * These write straight into a surface's pixels, two at a time where they can,
+ * rather than making an OS call per pixel like @ref LCD_SetPixel. Anything
+ * outside the surface's clip rectangle (see @ref GFX_SetClip) is clipped off,
+ * so shapes may hang off its edges.
+ *
+ * Example: a 30x50 purple rectangle at 10, 20, with a black line under it
+ * @code{cpp}
+ * struct GFX_Surface screen;
+ * GFX_GetVRAMSurface(&screen);
+ *
+ * GFX_FillRect(&screen, 10, 20, 30, 50, RGB_TO_RGB565(0x1F, 0x3B, 0x08));
+ * GFX_HLine(&screen, 10, 70, 30, 0);
+ * LCD_Refresh();
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "surface.hpp"
+
+/**
+ * Sets @p count pixels in a row to @p color. This is what the other functions
+ * are built on - it isn't clipped, so is only needed when working with pixel
+ * pointers directly.
+ *
+ * @param pixels The first pixel to set.
+ * @param count The number of pixels to set. Nothing is drawn if it's 0 or
+ * negative.
+ * @param color The color to set them to, in RGB565 format.
+ */
+void GFX_FillSpan(uint16_t *pixels, int count, uint16_t color);
+
+/**
+ * Draws a horizontal line, from @p x, @p y to the right.
+ *
+ * @param surface The surface to draw on.
+ * @param x,y The leftmost pixel of the line.
+ * @param length The length of the line, in pixels.
+ * @param color The color of the line, in RGB565 format.
+ */
+void GFX_HLine(struct GFX_Surface *surface, int x, int y, int length, uint16_t color);
+
+/**
+ * Draws a vertical line, from @p x, @p y downwards.
+ *
+ * @param surface The surface to draw on.
+ * @param x,y The top pixel of the line.
+ * @param length The length of the line, in pixels.
+ * @param color The color of the line, in RGB565 format.
+ */
+void GFX_VLine(struct GFX_Surface *surface, int x, int y, int length, uint16_t color);
+
+/**
+ * Fills a rectangle.
+ *
+ * @param surface The surface to draw on.
+ * @param x,y The top left corner of the rectangle.
+ * @param width,height The size of the rectangle, in pixels.
+ * @param color The color to fill it with, in RGB565 format.
+ */
+void GFX_FillRect(
+	struct GFX_Surface *surface, int x, int y, int width, int height,
+	uint16_t color
+);
+
+/**
+ * Fills a whole surface with one color (or as much of it as is inside its
+ * clip rectangle).
+ *
+ * @param surface The surface to clear.
+ * @param color The color to fill it with, in RGB565 format.
+ */
+void GFX_Clear(struct GFX_Surface *surface, uint16_t color);
@@ -0,0 +1,192 @@
+/**
+ * @file
+ * @brief Drawing QOI and PNG image files.
+ *
+ * Images are decoded a row at a time, straight into a surface (such as
+ * VRAM), so a full-screen image never needs a decoded copy of itself in RAM.
+ * The file is read through a @ref GFX_ImageSource, which can read the file a
+ * piece at a time with @ref read, point into it where it sits on flash with
+ * @ref getAddr, or read from data already in memory.
+ *
+ * QOI images are decoded with no extra memory at all. PNG images need about
+ * 40KB while they're being drawn - mostly the 32KB that decompressing
+ * refers back to - plus two rows of the image. Interlaced PNGs aren't
+ * supported.
+ *
+ * Pixels are clipped to the surface's clip rectangle (see
+ * @ref GFX_SetClip), and decoding stops after the last row which is
+ * visible. Partly transparent pixels are blended into what's already on the
+ * surface, and fully transparent ones are left alone.
+ *
+ * Example: showing a picture in the middle of the screen
+ * @code{cpp}
+ * struct GFX_Surface screen;
+ * GFX_GetVRAMSurface(&screen);
+ *
+ * int fd = open("\\fls0\\picture.qoi", OPEN_READ);
+ * if (fd >= 0) {
+ *     struct GFX_ImageSource source;
+ *     struct GFX_Image image;
+ *
+ *     if (GFX_InitMappedFileSource(&source, fd) == 0 && GFX_OpenImage(&image, &source) == 0) {
+ *         int x = (screen.width - image.width) / 2;
+ *         int y = (screen.height - image.height) / 2;
+ *         GFX_DrawImage(&image, &screen, x, y);
+ *     }
+ *
+ *     close(fd);
+ * }
+ *
+ * LCD_Refresh();
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "surface.hpp"
+
+/**
+ * @defgroup image_errors Image Errors
+ * Returned by the image functions, as well as the errors of @ref read and
+ * @ref getAddr.
+ * @{
+ */
+/// There wasn't enough memory to decode the image.
+const int GFX_IMAGE_ENOMEM = -100;
+/// The file isn't a QOI or PNG image, or uses a PNG feature which isn't
+/// supported.
+const int GFX_IMAGE_EUNSUPPORTED = -101;
+/// The image is damaged, or ends too early.
+const int GFX_IMAGE_ECORRUPT = -102;
+/// @}
+
+/**
+ * The number of bytes a @ref GFX_ImageSource reads from a file at a time,
+ * when it's set up with @ref GFX_InitFileSource.
+ */
+const int GFX_IMAGE_BUFFER_SIZE = 512;
+
+/**
+ * Where an image's data comes from. Set one up with one of the
+ * @c GFX_Init*Source functions.
+ */
+struct GFX_ImageSource {
+	/**
+	 * Makes the next piece of the data available in @ref data.
+	 *
+	 * @return The number of bytes available, 0 at the end of the data, or a
+	 * negative error code.
+	 */
+	int (*next)(struct GFX_ImageSource *source);
+
+	/// The data which hasn't been used yet.
+	const uint8_t *data;
+
+	/// The number of bytes at @ref data.
+	int length;
+
+	/// The file being read, if any.
+	int fd;
+
+	/// How far through the file or memory the next piece starts.
+	int offset;
+
+	/// The size of the file or memory.
+	int size;
+
+	/// Holds what was last read from the file.
+	uint8_t buffer[GFX_IMAGE_BUFFER_SIZE];
+};
+
+/**
+ * An image, once its header has been read by @ref GFX_OpenImage.
+ */
+struct GFX_Image {
+	/// The size of the image, in pixels.
+	int width, height;
+
+	/// Where the image is being read from.
+	struct GFX_ImageSource *source;
+
+	/// Whether the image is a PNG, rather than a QOI image.
+	bool png;
+
+	/// The number of bits in each sample of a PNG.
+	uint8_t bitDepth;
+
+	/// The PNG color type: 0 (gray), 2 (RGB), 3 (palette), 4 (gray and alpha)
+	/// or 6 (RGBA).
+	uint8_t colorType;
+
+	/// Whether @ref colorKey holds a PNG color which is transparent.
+	bool hasColorKey;
+
+	/// The transparent gray level, or red, green and blue levels.
+	uint16_t colorKey[3];
+
+	/// The number of bytes left in the current PNG data chunk.
+	uint32_t chunkLeft;
+
+	/// The colors of a PNG with a palette, in RGB565 format.
+	uint16_t palette[256];
+
+	/// The alpha of each palette color.
+	uint8_t paletteAlpha[256];
+};
+
+/**
+ * Sets up a source which reads from data already in memory, such as an image
+ * built into an app.
+ *
+ * @param[out] source The source to set up.
+ * @param data The image file's data.
+ * @param size The size of @p data, in bytes.
+ */
+void GFX_InitMemorySource(struct GFX_ImageSource *source, const void *data, int size);
+
+/**
+ * Sets up a source which reads a file with @ref read, from its current
+ * position.
+ *
+ * @param[out] source The source to set up.
+ * @param fd The file, which must stay open until the image has been drawn.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int GFX_InitFileSource(struct GFX_ImageSource *source, int fd);
+
+/**
+ * Sets up a source which reads a file from the start, where it sits on flash
+ * (using @ref getAddr), rather than copying it. This is faster than
+ * @ref GFX_InitFileSource, and works even if the file is fragmented.
+ *
+ * @param[out] source The source to set up.
+ * @param fd The file, which must stay open until the image has been drawn.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int GFX_InitMappedFileSource(struct GFX_ImageSource *source, int fd);
+
+/**
+ * Reads an image's header, to find its size. The pixels aren't read until
+ * @ref GFX_DrawImage.
+ *
+ * @param[out] image The image.
+ * @param source Where to read the image from.
+ * @return 0 on success, or a negative error code on failure. See
+ * @ref image_errors.
+ */
+int GFX_OpenImage(struct GFX_Image *image, struct GFX_ImageSource *source);
+
+/**
+ * Decodes an image onto a surface. This reads the rest of the image from its
+ * source, so can only be done once for each @ref GFX_OpenImage.
+ *
+ * If an error is found partway through, the rows before it have already been
+ * drawn.
+ *
+ * @param image The image, opened with @ref GFX_OpenImage.
+ * @param surface The surface to draw on.
+ * @param x,y Where to put the top left pixel of the image.
+ * @return 0 on success, or a negative error code on failure. See
+ * @ref image_errors.
+ */
+int GFX_DrawImage(struct GFX_Image *image, struct GFX_Surface *surface, int x, int y);
@@ -0,0 +1,205 @@
+/**
+ * @file
+ * @brief Off-screen surfaces with 4 or 8 bits per pixel, and palettes.
+ *
+ * A full-screen RGB565 buffer takes up 330KB. An indexed surface stores a
+ * palette index per pixel instead - a quarter of that at 4 bits per pixel,
+ * or half at 8 - and is turned into RGB565 when it's put in VRAM with
+ * @ref GFX_PresentIndexed.
+ *
+ * The colors come from a @ref GFX_Palette, which is kept apart from the
+ * surface. Changing a palette entry and presenting again changes every pixel
+ * of that color without redrawing anything, which makes color cycling free.
+ * @ref GFX_InitPalette starts the palette off with the @ref palette_colors,
+ * so @c PALETTE_RED and friends can be drawn with straight away.
+ *
+ * Example: a 4 bit per pixel frame, with a flashing rectangle
+ * @code{cpp}
+ * int width, height;
+ * LCD_GetSize(&width, &height);
+ *
+ * struct GFX_IndexedSurface frame;
+ * uint8_t *pixels = static_cast<uint8_t *>(malloc(GFX_GetIndexedBufferSize(width, height, 4)));
+ * GFX_InitIndexedSurface(&frame, pixels, width, height, 4);
+ *
+ * struct GFX_Palette palette;
+ * GFX_InitPalette(&palette);
+ *
+ * struct GFX_DirtyRegion dirty;
+ * GFX_InitDirtyRegion(&dirty, width, height);
+ *
+ * GFX_ClearIndexed(&frame, PALETTE_WHITE);
+ * GFX_FillIndexedRect(&frame, 10, 20, 30, 50, 8);
+ * GFX_MarkAllDirty(&dirty);
+ *
+ * for (int i = 0; running; ++i) {
+ *     GFX_SetPaletteColor(&palette, 8, (i & 1) ? 0xF800 : 0x001F);
+ *     GFX_MarkDirty(&dirty, 10, 20, 30, 50);
+ *     GFX_PresentIndexed(&frame, &palette, &dirty);
+ * }
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "dirty.hpp"
+#include "surface.hpp"
+
+/**
+ * The colors of an indexed surface's pixels. Change them with
+ * @ref GFX_SetPaletteColor or @ref GFX_RotatePalette, so that @ref pairs
+ * stays up to date.
+ */
+struct GFX_Palette {
+	/// The color of each index, in RGB565 format.
+	uint16_t colors[256];
+
+	/**
+	 * The two colors each byte of a 4 bit per pixel surface stands for, ready
+	 * to store as one 32-bit value. Only uses the first 16 colors.
+	 */
+	uint32_t pairs[256];
+};
+
+/**
+ * A rectangular buffer of palette indexes, in row-major order.
+ *
+ * At 4 bits per pixel, each byte holds two pixels, with the left one in the
+ * upper 4 bits. Each row starts on a new byte.
+ */
+struct GFX_IndexedSurface {
+	/// The top left pixel.
+	uint8_t *pixels;
+
+	/// The size of the surface, in pixels.
+	int width, height;
+
+	/// The number of bytes from the start of one row to the start of the next.
+	int stride;
+
+	/// Either 4 or 8.
+	int bitsPerPixel;
+};
+
+/**
+ * Sets the first 8 colors of a palette to the @ref palette_colors, and the
+ * rest to black.
+ *
+ * @param[out] palette The palette to fill in.
+ */
+void GFX_InitPalette(struct GFX_Palette *palette);
+
+/**
+ * Changes one color of a palette.
+ *
+ * @param palette The palette.
+ * @param index The index to change.
+ * @param color The new color, in RGB565 format.
+ */
+void GFX_SetPaletteColor(struct GFX_Palette *palette, uint8_t index, uint16_t color);
+
+/**
+ * Moves a range of palette colors along by one - each index in the range
+ * takes the color of the one before it, and the first takes the color of the
+ * last. Calling this every frame cycles colors, for effects like flowing
+ * water.
+ *
+ * @param palette The palette.
+ * @param first The first index of the range.
+ * @param count The number of indexes in the range.
+ */
+void GFX_RotatePalette(struct GFX_Palette *palette, int first, int count);
+
+/**
+ * Returns how many bytes a buffer for an indexed surface needs.
+ *
+ * @param width,height The size of the surface, in pixels.
+ * @param bitsPerPixel Either 4 or 8.
+ * @return The size of the buffer, in bytes.
+ */
+int GFX_GetIndexedBufferSize(int width, int height, int bitsPerPixel);
+
+/**
+ * Fills in an indexed surface for a buffer, with no gap between rows.
+ *
+ * @param[out] surface The surface to fill in.
+ * @param pixels The buffer, which must be at least
+ * @ref GFX_GetIndexedBufferSize bytes.
+ * @param width,height The size of the buffer, in pixels.
+ * @param bitsPerPixel Either 4 or 8.
+ */
+void GFX_InitIndexedSurface(
+	struct GFX_IndexedSurface *surface, uint8_t *pixels, int width, int height,
+	int bitsPerPixel
+);
+
+/**
+ * Returns the palette index of a pixel.
+ *
+ * @param surface The surface.
+ * @param x,y The pixel, which must be inside the surface.
+ * @return The pixel's palette index.
+ */
+uint8_t GFX_GetIndexedPixel(const struct GFX_IndexedSurface *surface, int x, int y);
+
+/**
+ * Sets the palette index of a pixel. Nothing happens if it's outside the
+ * surface.
+ *
+ * @param surface The surface.
+ * @param x,y The pixel.
+ * @param index The palette index. Only the lower 4 bits are used at 4 bits
+ * per pixel.
+ */
+void GFX_SetIndexedPixel(struct GFX_IndexedSurface *surface, int x, int y, uint8_t index);
+
+/**
+ * Fills a rectangle with one palette index. It's clipped to the surface.
+ *
+ * @param surface The surface.
+ * @param x,y The top left pixel of the rectangle.
+ * @param width,height The size of the rectangle, in pixels.
+ * @param index The palette index.
+ */
+void GFX_FillIndexedRect(
+	struct GFX_IndexedSurface *surface, int x, int y, int width, int height,
+	uint8_t index
+);
+
+/**
+ * Fills a whole surface with one palette index.
+ *
+ * @param surface The surface.
+ * @param index The palette index.
+ */
+void GFX_ClearIndexed(struct GFX_IndexedSurface *surface, uint8_t index);
+
+/**
+ * Converts a rectangle of an indexed surface to RGB565, and stores it at the
+ * same place on another surface. The rectangle is clipped to both surfaces.
+ *
+ * @param destination The surface to write to.
+ * @param source The indexed surface.
+ * @param palette The colors of @p source's pixels.
+ * @param rect The rectangle to convert.
+ */
+void GFX_ExpandIndexed(
+	struct GFX_Surface *destination, const struct GFX_IndexedSurface *source,
+	const struct GFX_Palette *palette, const struct GFX_Rect *rect
+);
+
+/**
+ * Converts the parts of an indexed surface which are marked dirty into VRAM,
+ * and puts them on the display (see @ref GFX_RefreshIfDirty). After changing
+ * the palette, mark everything drawn with the changed colors dirty - or use
+ * @ref GFX_MarkAllDirty.
+ *
+ * @param surface The indexed surface, which should be the size of the
+ * display.
+ * @param palette The colors of @p surface's pixels.
+ * @param dirty The parts of @p surface which have changed.
+ */
+void GFX_PresentIndexed(
+	const struct GFX_IndexedSurface *surface, const struct GFX_Palette *palette,
+	struct GFX_DirtyRegion *dirty
+);
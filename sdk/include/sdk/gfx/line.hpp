@@ -0,0 +1,81 @@
+/**
+ * @file
+ * @brief Drawing straight lines.
+ *
+ * Lines are drawn with Bresenham's algorithm, using integers only. Lines
+ * which are partly outside the surface's clip rectangle (see
+ * @ref GFX_SetClip) are clipped before they're drawn, so each pixel is only
+ * stepped over if it's visible, and the pixels which are drawn are exactly
+ * the ones the unclipped line would have. Horizontal and vertical lines are
+ * filled like rectangles.
+ *
+ * @ref GFX_DrawLineAA draws smooth (anti-aliased) lines with Wu's algorithm,
+ * blending the line into what's already on the surface.
+ *
+ * Coordinates must be between -16384 and 16383.
+ *
+ * Example: plotting a function
+ * @code{cpp}
+ * struct GFX_Point points[64];
+ * for (int i = 0; i < 64; ++i) {
+ *     points[i].x = i * 5;
+ *     points[i].y = 264 - f(i);
+ * }
+ *
+ * GFX_DrawPolyline(&screen, points, 64, RGB_TO_RGB565(0, 0, 0x1F));
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "surface.hpp"
+
+/**
+ * A point on a surface.
+ */
+struct GFX_Point {
+	int x, y;
+};
+
+/**
+ * Draws a line, one pixel thick. Both ends are drawn.
+ *
+ * @param surface The surface to draw on.
+ * @param x0,y0 One end of the line.
+ * @param x1,y1 The other end of the line.
+ * @param color The color of the line, in RGB565 format.
+ */
+void GFX_DrawLine(
+	struct GFX_Surface *surface, int x0, int y0, int x1, int y1,
+	uint16_t color
+);
+
+/**
+ * Draws lines joining a list of points. Each point is drawn once, even where
+ * two lines meet - so nothing is drawn twice if the color is blended later.
+ * To draw a closed shape, repeat the first point at the end.
+ *
+ * @param surface The surface to draw on.
+ * @param points The points to join, in order.
+ * @param numPoints The number of points. One point draws a single pixel.
+ * @param color The color of the lines, in RGB565 format.
+ */
+void GFX_DrawPolyline(
+	struct GFX_Surface *surface, const struct GFX_Point *points, int numPoints,
+	uint16_t color
+);
+
+/**
+ * Draws an anti-aliased line. Where the line passes between two pixels, both
+ * are blended towards @p color, in proportion to how close the line is to
+ * each.
+ *
+ * @param surface The surface to draw on.
+ * @param x0,y0 One end of the line.
+ * @param x1,y1 The other end of the line.
+ * @param color The color of the line, in RGB565 format.
+ */
+void GFX_DrawLineAA(
+	struct GFX_Surface *surface, int x0, int y0, int x1, int y1,
+	uint16_t color
+);
@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @brief Drawing images (sprites) onto a surface.
+ *
+ * There are three ways to draw a sprite, from fastest to slowest:
+ * - @ref GFX_DrawSprite draws every pixel, copying whole rows at once.
+ * - @ref GFX_DrawRLESprite draws a sprite with transparent parts, which has
+ *   been run-length encoded with @ref GFX_EncodeRLESprite. Transparent parts
+ *   are skipped over a run at a time, and the rest is copied like an opaque
+ *   sprite.
+ * - @ref GFX_DrawKeyedSprite skips pixels which are a particular "key"
+ *   color, checking each pixel as it goes. It needs no preparation, so it's
+ *   handy for sprites which change.
+ *
+ * Sprites are clipped to the surface's clip rectangle (see @ref GFX_SetClip),
+ * and can be flipped horizontally and/or vertically as they're drawn.
+ *
+ * Example: drawing a 16x16 sprite, facing left
+ * @code{cpp}
+ * const uint16_t playerPixels[16 * 16] = { ... };
+ * const struct GFX_Sprite player = {playerPixels, 16, 16};
+ *
+ * GFX_DrawSprite(&screen, &player, x, y, GFX_FlipHorizontal);
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "surface.hpp"
+
+/**
+ * An image of RGB565 pixels, in row-major order with no gap between rows.
+ */
+struct GFX_Sprite {
+	const uint16_t *pixels;
+	int width, height;
+};
+
+/**
+ * A sprite with transparent parts, encoded by @ref GFX_EncodeRLESprite.
+ *
+ * The data starts with the offset of each row's runs (counted in
+ * @c uint16_t from the start of the data). Each run is a @c uint16_t with the
+ * number of transparent pixels in its high byte and the number of opaque
+ * pixels in its low byte, followed by the opaque pixels themselves. A row's
+ * runs end once they add up to the sprite's width.
+ */
+struct GFX_RLESprite {
+	const uint16_t *data;
+	int width, height;
+};
+
+/**
+ * Flags for drawing sprites.
+ */
+enum GFX_SpriteFlag {
+	/// Mirrors the sprite left to right.
+	GFX_FlipHorizontal = 1 << 0,
+
+	/// Mirrors the sprite top to bottom.
+	GFX_FlipVertical = 1 << 1
+};
+
+/**
+ * Draws every pixel of a sprite.
+ *
+ * @param surface The surface to draw on.
+ * @param sprite The sprite to draw.
+ * @param x,y Where to draw the top left corner of the sprite.
+ * @param flags Any of @ref GFX_SpriteFlag, ORed together.
+ */
+void GFX_DrawSprite(
+	struct GFX_Surface *surface, const struct GFX_Sprite *sprite,
+	int x, int y, int flags
+);
+
+/**
+ * Draws a sprite, leaving out pixels which are the color @p key.
+ *
+ * @param surface The surface to draw on.
+ * @param sprite The sprite to draw.
+ * @param x,y Where to draw the top left corner of the sprite.
+ * @param key The color which is transparent, in RGB565 format.
+ * @param flags Any of @ref GFX_SpriteFlag, ORed together.
+ */
+void GFX_DrawKeyedSprite(
+	struct GFX_Surface *surface, const struct GFX_Sprite *sprite,
+	int x, int y, uint16_t key, int flags
+);
+
+/**
+ * Draws a run-length encoded sprite.
+ *
+ * @param surface The surface to draw on.
+ * @param sprite The sprite to draw.
+ * @param x,y Where to draw the top left corner of the sprite.
+ * @param flags Any of @ref GFX_SpriteFlag, ORed together.
+ */
+void GFX_DrawRLESprite(
+	struct GFX_Surface *surface, const struct GFX_RLESprite *sprite,
+	int x, int y, int flags
+);
+
+/**
+ * Run-length encodes a sprite, treating pixels which are the color @p key as
+ * transparent. Call it with @p data set to @c nullptr first to find out how
+ * much space is needed.
+ *
+ * @param sprite The sprite to encode.
+ * @param key The color which is transparent, in RGB565 format.
+ * @param[out] data Where to put the encoded sprite, or @c nullptr.
+ * @param size How many @c uint16_t @p data can hold.
+ * @return The number of @c uint16_t the encoded sprite takes up, or 0 if it's
+ * too large to encode (over 65535). Nothing is written if this is more than
+ * @p size.
+ */
+int GFX_EncodeRLESprite(
+	const struct GFX_Sprite *sprite, uint16_t key, uint16_t *data, int size
+);
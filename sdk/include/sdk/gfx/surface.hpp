@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @brief Surfaces: the pixel buffers the @c sdk/gfx functions draw into.
+ *
+ * A surface is usually VRAM (see @ref GFX_GetVRAMSurface), but can be any
+ * buffer of RGB565 pixels - for example an off-screen buffer, or an array on
+ * a PC when testing drawing code. Nothing in @c sdk/gfx calls the OS, other
+ * than @ref GFX_GetVRAMSurface.
+ *
+ * Example: filling the screen with blue
+ * @code{cpp}
+ * struct GFX_Surface screen;
+ * GFX_GetVRAMSurface(&screen);
+ *
+ * GFX_Clear(&screen, RGB_TO_RGB565(0, 0, 0x1F));
+ * LCD_Refresh();
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+
+/**
+ * A rectangle of pixels.
+ */
+struct GFX_Rect {
+	/// The top left pixel.
+	int x, y;
+
+	/// The size of the rectangle, in pixels.
+	int width, height;
+};
+
+/**
+ * A rectangular buffer of RGB565 pixels, in row-major order.
+ */
+struct GFX_Surface {
+	/// The top left pixel.
+	uint16_t *pixels;
+
+	/// The size of the surface, in pixels.
+	int width, height;
+
+	/**
+	 * The number of pixels from the start of one row to the start of the
+	 * next. At least @ref width - more if the surface is part of a larger
+	 * buffer.
+	 */
+	int stride;
+
+	/**
+	 * Drawing is limited to this rectangle, which is always inside the
+	 * surface. Set it with @ref GFX_SetClip.
+	 */
+	struct GFX_Rect clip;
+};
+
+/**
+ * Fills in a surface for a buffer which is @p width pixels wide, with no gap
+ * between rows. Drawing isn't limited to any part of it.
+ *
+ * @param[out] surface The surface to fill in.
+ * @param pixels The buffer, which must hold <tt>width * height</tt> pixels.
+ * @param width,height The size of the buffer, in pixels.
+ */
+void GFX_InitSurface(struct GFX_Surface *surface, uint16_t *pixels, int width, int height);
+
+/**
+ * Limits drawing on a surface to a rectangle. Parts of the rectangle outside
+ * the surface are ignored.
+ *
+ * @param surface The surface.
+ * @param clip The rectangle to draw inside, or @c nullptr to allow drawing
+ * anywhere on the surface.
+ */
+void GFX_SetClip(struct GFX_Surface *surface, const struct GFX_Rect *clip);
+
+/**
+ * Shrinks a rectangle to the part of it which is inside a surface's clip
+ * rectangle.
+ *
+ * @param surface The surface.
+ * @param[in,out] rect The rectangle to shrink.
+ * @return False if none of the rectangle is inside the clip rectangle.
+ */
+bool GFX_ClipRect(const struct GFX_Surface *surface, struct GFX_Rect *rect);
+
+/**
+ * Fills in a surface for VRAM. Drawing to it isn't visible until
+ * @ref LCD_Refresh is called.
+ *
+ * @param[out] surface The surface to fill in.
+ */
+void GFX_GetVRAMSurface(struct GFX_Surface *surface);
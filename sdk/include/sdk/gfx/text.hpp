@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @brief Drawing text with bitmap fonts.
+ *
+ * Unlike @ref Debug_PrintString, text can be drawn at any position, in any
+ * color, onto any surface. Glyphs are drawn straight from the font's packed
+ * bitmaps, four pixels at a time.
+ *
+ * Example: a score counter in the top right corner of the screen
+ * @code{cpp}
+ * char text[32] = "Score: ";
+ * GFX_FormatNumber(&text[7], score, 4);
+ *
+ * int x = screen.width - GFX_MeasureText(&GFX_FONT_8X8, text) - 4;
+ * GFX_DrawText(&screen, &GFX_FONT_8X8, x, 4, text, RGB_TO_RGB565(0x1F, 0x3F, 0x1F), 0);
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include "surface.hpp"
+
+/**
+ * A monospaced bitmap font.
+ */
+struct GFX_Font {
+	/**
+	 * The glyphs, one after another, from @ref first to @ref last. Each row of
+	 * a glyph takes up <tt>(width + 7) / 8</tt> bytes, with the leftmost
+	 * pixel in the most significant bit of the first byte. Set bits are drawn
+	 * in the text color.
+	 */
+	const uint8_t *glyphs;
+
+	/// The size of each glyph, in pixels. At most 32 pixels wide.
+	int width, height;
+
+	/// The first and last characters the font has glyphs for.
+	char first, last;
+};
+
+/**
+ * An 8x8 pixel font, covering the printable ASCII characters.
+ */
+extern const struct GFX_Font GFX_FONT_8X8;
+
+/**
+ * Draws text, filling in the rest of each character's box with a background
+ * color. Characters the font doesn't have are left blank, and @c \\n starts a
+ * new line below the first.
+ *
+ * @param surface The surface to draw on.
+ * @param font The font to use.
+ * @param x,y The top left corner of the first character.
+ * @param text The text to draw.
+ * @param foreground The color of the text, in RGB565 format.
+ * @param background The color behind the text, in RGB565 format.
+ */
+void GFX_DrawText(
+	struct GFX_Surface *surface, const struct GFX_Font *font, int x, int y,
+	const char *text, uint16_t foreground, uint16_t background
+);
+
+/**
+ * Draws text, leaving whatever was behind it showing through. Otherwise the
+ * same as @ref GFX_DrawText.
+ *
+ * @param surface The surface to draw on.
+ * @param font The font to use.
+ * @param x,y The top left corner of the first character.
+ * @param text The text to draw.
+ * @param foreground The color of the text, in RGB565 format.
+ */
+void GFX_DrawTextTransparent(
+	struct GFX_Surface *surface, const struct GFX_Font *font, int x, int y,
+	const char *text, uint16_t foreground
+);
+
+/**
+ * Works out how wide text will be when it's drawn.
+ *
+ * @param font The font the text will be drawn in.
+ * @param text The text.
+ * @return The width of the widest line of the text, in pixels.
+ */
+int GFX_MeasureText(const struct GFX_Font *font, const char *text);
+
+/**
+ * Writes a number out in decimal, for drawing as text.
+ *
+ * @param[out] buffer Where to write the number. Needs room for 12
+ * characters, or @p minDigits + 2 if that's more.
+ * @param value The number.
+ * @param minDigits The least number of digits to write, padding with zeroes
+ * at the front.
+ * @return The number of characters written, not counting the null
+ * terminator.
+ */
+int GFX_FormatNumber(char *buffer, int value, int minDigits);
@@ -0,0 +1,61 @@
+/**
+ * @file
+ * @brief The interface between the Hollyhock launcher and the apps it runs.
+ *
+ * Before running an app, the launcher fills in a @ref HollyhockLaunchInfo
+ * block at the fixed address @ref HOLLYHOCK_LAUNCH_INFO. The launcher stays
+ * in memory while the app runs, so the functions in the block can be called
+ * by the app. Apps shouldn't need to use this directly - SDK functions (such
+ * as @ref Overlay_Load) use it on their behalf.
+ */
+
+#pragma once
+#include <stdint.h>
+
+/// "HHLI"
+const uint32_t HOLLYHOCK_LAUNCH_INFO_MAGIC = 0x48484C49;
+const uint32_t HOLLYHOCK_LAUNCH_INFO_VERSION = 1;
+
+/**
+ * Information passed from the launcher to the app it's running.
+ */
+struct HollyhockLaunchInfo {
+	/// Always @ref HOLLYHOCK_LAUNCH_INFO_MAGIC if the block is valid.
+	uint32_t magic;
+
+	/// Always @ref HOLLYHOCK_LAUNCH_INFO_VERSION if the block is valid.
+	uint32_t version;
+
+	/**
+	 * Loads an overlay of the running app. See @ref Overlay_Load.
+	 *
+	 * @param name The name of the overlay.
+	 * @return 0 on success, or a negative error code on failure.
+	 */
+	int (*loadOverlay)(const char *name);
+};
+
+/**
+ * Where the launcher puts the @ref HollyhockLaunchInfo block: the last 256
+ * bytes of the launcher's own region of RAM, just below where apps are
+ * loaded.
+ */
+struct HollyhockLaunchInfo * const HOLLYHOCK_LAUNCH_INFO =
+	reinterpret_cast<struct HollyhockLaunchInfo *>(0x8CFEFF00);
+
+/**
+ * Returns the launch info block, if the app was run by a launcher which
+ * provides one.
+ *
+ * @return The launch info block, or @c nullptr if it's not available.
+ */
+inline const struct HollyhockLaunchInfo *GetLaunchInfo() {
+	if (
+		HOLLYHOCK_LAUNCH_INFO->magic != HOLLYHOCK_LAUNCH_INFO_MAGIC ||
+		HOLLYHOCK_LAUNCH_INFO->version != HOLLYHOCK_LAUNCH_INFO_VERSION
+	) {
+		return nullptr;
+	}
+
+	return HOLLYHOCK_LAUNCH_INFO;
+}
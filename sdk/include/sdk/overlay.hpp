@@ -0,0 +1,56 @@
+/**
+ * @file
+ * @brief Overlays: parts of an app which are only loaded into RAM on demand.
+ *
+ * Code and data marked with @ref HOLLYHOCK_OVERLAY are left on flash when the
+ * app is launched. Each overlay is loaded with @ref Overlay_Load before it's
+ * used. All overlays share the same region of RAM, so loading one overlay
+ * replaces whichever was loaded before it.
+ *
+ * This lets apps which are too big to fit in RAM run, and means the launcher
+ * only has to load the (smaller) core of the app before it starts.
+ *
+ * Each overlay must also be listed in the app's @c linker.ld, inside the
+ * @c OVERLAY block (see the app template's @c linker.ld). Apps using overlays
+ * must not be stripped of their section headers, and can't be
+ * position-independent (built with <tt>make PIE=1</tt>).
+ *
+ * Example: a level data overlay
+ * @code{cpp}
+ * HOLLYHOCK_OVERLAY("levels")
+ * const uint8_t levelData[64][4096] = { ... };
+ *
+ * HOLLYHOCK_OVERLAY("levels")
+ * void LoadLevel(int level) { ... levelData[level] ... }
+ *
+ * void main() {
+ *     if (Overlay_Load("levels") < 0) {
+ *         return;
+ *     }
+ *
+ *     LoadLevel(0);
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+/**
+ * Places a function or variable in the overlay named @p name.
+ *
+ * Overlay variables must be initialized - uninitialized ones would need to be
+ * zeroed each time the overlay is loaded, which is up to the app.
+ */
+#define HOLLYHOCK_OVERLAY(name) \
+	__attribute__ ((section(".overlay." name)))
+
+/**
+ * Loads an overlay into RAM, replacing the overlay which was previously
+ * loaded. Loading the overlay which is already loaded reloads it, discarding
+ * any changes made to its variables.
+ *
+ * @param name The name of the overlay, as passed to @ref HOLLYHOCK_OVERLAY.
+ * @return 0 on success, or a negative error code on failure (including if the
+ * app wasn't run by the launcher, or is position-independent).
+ */
+int Overlay_Load(const char *name);
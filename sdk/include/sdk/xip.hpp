@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @brief Execute-in-place data: read-only data which is left on flash.
+ *
+ * Constants marked with @ref HOLLYHOCK_XIP (such as fonts, level data or
+ * lookup tables) aren't copied into RAM when the app is launched. Instead,
+ * the launcher points the app's code at the data where it sits in the
+ * calculator's flash, which makes launching faster and leaves more RAM free.
+ *
+ * This only happens for fixed-address apps which are linked with
+ * @c --emit-relocs (build with <tt>make XIP=1</tt>), as the launcher needs to
+ * find every reference to the data. If it can't (or the app's file is
+ * fragmented on flash), the data is copied into RAM like anything else, so
+ * apps work the same either way.
+ *
+ * The data must never be written to, and pointers to it must not be stored
+ * in other @ref HOLLYHOCK_XIP data. Apps using it must not be stripped of
+ * their section headers.
+ *
+ * Example: a font
+ * @code{cpp}
+ * HOLLYHOCK_XIP
+ * const uint8_t font[256][8] = { ... };
+ * @endcode
+ */
+
+#pragma once
+
+/**
+ * Places a constant in the app's execute-in-place data.
+ */
+#define HOLLYHOCK_XIP \
+	__attribute__ ((section(".xip_rodata")))
@@ -0,0 +1,15 @@
+#include <sdk/launcher.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/overlay.hpp>
+
+/**
+ * Loads an overlay, using the launcher which ran this app.
+ */
+int Overlay_Load(const char *name) {
+	const struct HollyhockLaunchInfo *launchInfo = GetLaunchInfo();
+	if (launchInfo == nullptr) {
+		return ENOENT;
+	}
+
+	return launchInfo->loadOverlay(name);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * Helpers for the benchmarks, built with optimization and run with
+ * `make -C tests bench`.
+ *
+ * They run on the host, so the numbers they print only compare one way of
+ * doing something with another. How long anything takes on the calculator
+ * has to be measured there, with the launcher's timing probes.
+ */
+
+/**
+ * Anything the code being timed works out, added in here so the compiler
+ * can't leave the work out.
+ */
+inline volatile uint32_t g_benchSink;
+
+/**
+ * The time since some fixed point, in microseconds.
+ */
+inline double BenchMicroseconds() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+/**
+ * Calls @p function over and over, for at least a fifth of a second, after
+ * one call to warm up.
+ *
+ * @return The average time each call took, in microseconds.
+ */
+template <typename Function>
+double TimeCalls(Function function) {
+	function();
+
+	double start = BenchMicroseconds();
+	double elapsed;
+	int calls = 0;
+	do {
+		function();
+		++calls;
+		elapsed = BenchMicroseconds() - start;
+	} while (elapsed < 200000);
+
+	return elapsed / calls;
+}
@@ -0,0 +1,185 @@
+#include <vector>
+#include <sdk/gfx/blend.hpp>
+#include "canvas.hpp"
+#include "test.hpp"
+
+namespace {
+	uint32_t g_seed = 5;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	int Red(uint16_t pixel) {
+		return pixel >> 11;
+	}
+
+	int Green(uint16_t pixel) {
+		return (pixel >> 5) & 0x3F;
+	}
+
+	int Blue(uint16_t pixel) {
+		return pixel & 0x1F;
+	}
+
+	uint16_t Pixel(int red, int green, int blue) {
+		return red << 11 | green << 5 | blue;
+	}
+
+	// The formulas in blend.hpp, one channel at a time
+
+	uint16_t Blend(uint16_t background, uint16_t color, int alpha) {
+		return Pixel(
+			(Red(color) * alpha + Red(background) * (32 - alpha)) >> 5,
+			(Green(color) * alpha + Green(background) * (32 - alpha)) >> 5,
+			(Blue(color) * alpha + Blue(background) * (32 - alpha)) >> 5
+		);
+	}
+
+	// Brightness out of 63, with the usual luma weights - scaled up for red
+	// and blue, which only go up to 31
+	uint16_t Gray(uint16_t pixel) {
+		int y = (Red(pixel) * 155 + Green(pixel) * 151 + Blue(pixel) * 59) >> 8;
+		return Pixel(y >> 1, y, y >> 1);
+	}
+
+	uint16_t Tint(uint16_t pixel, uint16_t tint) {
+		return Pixel(
+			Red(pixel) * (Red(tint) + 1) >> 5,
+			Green(pixel) * (Green(tint) + 1) >> 6,
+			Blue(pixel) * (Blue(tint) + 1) >> 5
+		);
+	}
+
+	void TestBlendColor() {
+		for (int alpha = 0; alpha <= GFX_ALPHA_OPAQUE; ++alpha) {
+			for (int i = 0; i < 5000; ++i) {
+				uint16_t background = Random(0x10000);
+				uint16_t color = Random(0x10000);
+				CHECK_EQUAL(GFX_BlendColor(background, color, alpha), Blend(background, color, alpha));
+			}
+		}
+
+		CHECK_EQUAL(GFX_BlendColor(0x1234, 0xFFFF, GFX_ALPHA_OPAQUE), 0xFFFF);
+		CHECK_EQUAL(GFX_BlendColor(0x1234, 0xFFFF, 0), 0x1234);
+		CHECK_EQUAL(Gray(0xFFFF), 0xFFFF);
+	}
+
+	/**
+	 * Runs each span function at every alignment, over counts either side of
+	 * the pairs the kernels work on - including none, and negative ones.
+	 */
+	void TestSpans() {
+		const int SIZE = 72;
+
+		for (int i = 0; i < 50000; ++i) {
+			int offset = Random(3);
+			int count = Random(SIZE) - 2;
+			int alpha = Random(GFX_ALPHA_OPAQUE + 1);
+			uint16_t color = Random(0x10000);
+
+			Canvas canvas(SIZE, 1, SIZE, offset);
+			uint16_t *pixels = canvas.surface.pixels;
+
+			std::vector<uint16_t> source(SIZE + 2);
+			for (uint16_t &pixel : source) {
+				pixel = Random(0x10000);
+			}
+			int sourceOffset = Random(3);
+
+			int function = i % 7;
+			switch (function) {
+			case 0:
+				GFX_BlendSpan(pixels, &source[sourceOffset], count, alpha);
+				break;
+			case 1:
+				GFX_BlendColorSpan(pixels, count, color, alpha);
+				break;
+			case 2:
+				GFX_DarkenSpan(pixels, count, alpha);
+				break;
+			case 3:
+				GFX_LightenSpan(pixels, count, alpha);
+				break;
+			case 4:
+				GFX_InvertSpan(pixels, count);
+				break;
+			case 5:
+				GFX_GrayscaleSpan(pixels, count);
+				break;
+			default:
+				GFX_TintSpan(pixels, count, color);
+				break;
+			}
+
+			for (int x = 0; x < count; ++x) {
+				uint16_t pixel = canvas.Expected(x, 0);
+				switch (function) {
+				case 0:
+					pixel = Blend(pixel, source[sourceOffset + x], alpha);
+					break;
+				case 1:
+					pixel = Blend(pixel, color, alpha);
+					break;
+				case 2:
+					pixel = Blend(pixel, 0, alpha);
+					break;
+				case 3:
+					pixel = Blend(pixel, 0xFFFF, alpha);
+					break;
+				case 4:
+					pixel = ~pixel;
+					break;
+				case 5:
+					pixel = Gray(pixel);
+					break;
+				default:
+					pixel = Tint(pixel, color);
+					break;
+				}
+
+				canvas.Set(x, 0, pixel);
+			}
+
+			CHECK(canvas.Matches());
+		}
+	}
+
+	void TestBlendRect() {
+		for (int i = 0; i < 5000; ++i) {
+			int width = 1 + Random(40);
+			int height = 1 + Random(25);
+			Canvas canvas(width, height, width + Random(3), Random(2));
+			if (Random(2) == 0) {
+				struct GFX_Rect clip = {Random(50) - 10, Random(35) - 10, Random(50), Random(35)};
+				GFX_SetClip(&canvas.surface, &clip);
+			}
+
+			int x = Random(60) - 15;
+			int y = Random(40) - 10;
+			int w = Random(60) - 5;
+			int h = Random(40) - 5;
+			uint16_t color = Random(0x10000);
+			int alpha = Random(GFX_ALPHA_OPAQUE + 1);
+			GFX_BlendRect(&canvas.surface, x, y, w, h, color, alpha);
+
+			for (int py = y; py < y + h; ++py) {
+				for (int px = x; px < x + w; ++px) {
+					if (px >= 0 && py >= 0 && px < width && py < height) {
+						canvas.Set(px, py, Blend(canvas.Expected(px, py), color, alpha));
+					}
+				}
+			}
+
+			CHECK(canvas.Matches());
+		}
+	}
+}
+
+int main() {
+	TestBlendColor();
+	TestSpans();
+	TestBlendRect();
+	return TestResult("blend_test");
+}
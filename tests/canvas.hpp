@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <sdk/gfx/surface.hpp>
+
+/**
+ * A surface to draw on, along with the pixels it's expected to end up with.
+ *
+ * The surface sits in the middle of a larger buffer, so pixels around it -
+ * and in the gap between rows, if its stride is wider than it is - show up
+ * any drawing which goes outside it. Tests set the expected pixels one at a
+ * time with @ref Set, which ignores pixels outside the clip rectangle, then
+ * compare the whole buffer with @ref Matches.
+ */
+class Canvas {
+public:
+	/// The number of pixels before and after the surface.
+	static const int MARGIN = 64;
+
+	struct GFX_Surface surface;
+
+	/**
+	 * @param width,height The size of the surface.
+	 * @param stride The surface's stride - at least @p width.
+	 * @param offset The number of pixels to move the surface along by, to
+	 * change its alignment.
+	 */
+	Canvas(int width, int height, int stride, int offset = 0)
+		: m_pixels(MARGIN * 2 + stride * height + offset) {
+		uint32_t seed = width * 31 + height * 7 + offset;
+		for (uint16_t &pixel : m_pixels) {
+			seed = seed * 1103515245 + 12345;
+			pixel = seed >> 16;
+		}
+		m_expected = m_pixels;
+
+		GFX_InitSurface(&surface, &m_pixels[MARGIN + offset], width, height);
+		surface.stride = stride;
+		m_offset = MARGIN + offset;
+	}
+
+	bool InClip(int x, int y) const {
+		const struct GFX_Rect &clip = surface.clip;
+		return x >= clip.x && y >= clip.y && x < clip.x + clip.width && y < clip.y + clip.height;
+	}
+
+	/// Returns the pixel at @p x, @p y as it is now.
+	uint16_t Get(int x, int y) const {
+		return m_pixels[m_offset + y * surface.stride + x];
+	}
+
+	/// Returns the pixel at @p x, @p y as it's expected to be.
+	uint16_t Expected(int x, int y) const {
+		return m_expected[m_offset + y * surface.stride + x];
+	}
+
+	/// Expects @p x, @p y to be @p color, if it's inside the clip rectangle.
+	void Set(int x, int y, uint16_t color) {
+		if (InClip(x, y)) {
+			m_expected[m_offset + y * surface.stride + x] = color;
+		}
+	}
+
+	/// Checks every pixel in the buffer is as expected.
+	bool Matches() const {
+		return m_pixels == m_expected;
+	}
+
+	/// Expects the pixels to stay as they are now.
+	void Accept() {
+		m_expected = m_pixels;
+	}
+
+private:
+	std::vector<uint16_t> m_pixels;
+	std::vector<uint16_t> m_expected;
+	int m_offset;
+};
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <zlib.h>
+#include <memory>
+#include "bench.hpp"
+#include "crc32.hpp"
+
+namespace {
+	uint32_t g_table[256];
+
+	/**
+	 * The classic CRC-32, a byte at a time from a single table - what the
+	 * slicing-by-8 kernel is meant to beat.
+	 */
+	uint32_t UpdateByByte(uint32_t crc, const uint8_t *data, uint32_t size) {
+		crc = ~crc;
+		for (uint32_t i = 0; i < size; ++i) {
+			crc = g_table[(crc ^ data[i]) & 0xFF] ^ crc >> 8;
+		}
+
+		return ~crc;
+	}
+
+	void BuildTable() {
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; ++bit) {
+				crc = crc & 1 ? 0xEDB88320 ^ crc >> 1 : crc >> 1;
+			}
+			g_table[i] = crc;
+		}
+	}
+
+	template <typename Function>
+	void Report(const char *name, uint32_t size, uint32_t alignment, Function function) {
+		double time = TimeCalls(function);
+		printf("%-10s %6uK %9u %10.1f\n", name, size / 1024, alignment, size / time);
+	}
+}
+
+/**
+ * Times the launcher's CRC-32 kernel over app-sized images, against a byte at
+ * a time table lookup and zlib.
+ */
+int main() {
+	if (!CRC32::Init()) {
+		fprintf(stderr, "crc32_bench: CRC32::Init failed\n");
+		return 1;
+	}
+	BuildTable();
+
+	const uint32_t SIZES[] = {64 * 1024, 256 * 1024, 512 * 1024};
+	const uint32_t MAX_SIZE = 512 * 1024;
+
+	// Word aligned, and not
+	const uint32_t ALIGNMENTS[] = {0, 3};
+
+	std::unique_ptr<uint8_t[]> data(new uint8_t[MAX_SIZE + 8]);
+	uint32_t seed = 1;
+	for (uint32_t i = 0; i < MAX_SIZE + 8; ++i) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = seed >> 16;
+	}
+
+	printf("%-10s %7s %9s %10s\n", "kernel", "size", "alignment", "MB/s");
+	for (uint32_t size : SIZES) {
+		for (uint32_t alignment : ALIGNMENTS) {
+			const uint8_t *start = data.get() + alignment;
+
+			Report("launcher", size, alignment, [=]() {
+				g_benchSink += CRC32::Update(0, start, size);
+			});
+			Report("by byte", size, alignment, [=]() {
+				g_benchSink += UpdateByByte(0, start, size);
+			});
+			Report("zlib", size, alignment, [=]() {
+				g_benchSink += crc32(0, start, size);
+			});
+		}
+	}
+
+	CRC32::Shutdown();
+	return 0;
+}
@@ -0,0 +1,63 @@
+#include <string.h>
+#include <zlib.h>
+#include <memory>
+#include "crc32.hpp"
+#include "test.hpp"
+
+namespace {
+	uint32_t Update(uint32_t crc, const char *str) {
+		return CRC32::Update(crc, reinterpret_cast<const uint8_t *>(str), strlen(str));
+	}
+
+	void TestKnownValues() {
+		CHECK_EQUAL(Update(0, ""), 0x00000000);
+		CHECK_EQUAL(Update(0, "a"), 0xE8B7BE43);
+		CHECK_EQUAL(Update(0, "abc"), 0x352441C2);
+		CHECK_EQUAL(Update(0, "123456789"), 0xCBF43926);
+		CHECK_EQUAL(Update(0, "The quick brown fox jumps over the lazy dog"), 0x414FA339);
+
+		// Running CRCs carry on where they left off
+		CHECK_EQUAL(Update(Update(0, "12345"), "6789"), 0xCBF43926);
+	}
+
+	/**
+	 * Compares against zlib for every alignment and a range of sizes, so each
+	 * of the byte-at-a-time head, the 8 byte loop and the tail is covered.
+	 */
+	void TestAgainstZlib() {
+		const uint32_t SIZE = 300 * 1024;
+		std::unique_ptr<uint8_t[]> data(new uint8_t[SIZE + 8]);
+
+		uint32_t seed = 1;
+		for (uint32_t i = 0; i < SIZE + 8; ++i) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+
+		for (uint32_t alignment = 0; alignment < 8; ++alignment) {
+			const uint8_t *start = data.get() + alignment;
+
+			for (uint32_t size = 0; size < 100; ++size) {
+				CHECK_EQUAL(CRC32::Update(0, start, size), crc32(0, start, size));
+			}
+
+			CHECK_EQUAL(CRC32::Update(0, start, SIZE), crc32(0, start, SIZE));
+
+			// Split at an odd point, so the second half starts unaligned
+			uint32_t crc = CRC32::Update(0, start, 12345);
+			CHECK_EQUAL(CRC32::Update(crc, start + 12345, SIZE - 12345), crc32(0, start, SIZE));
+		}
+	}
+}
+
+int main() {
+	if (!CRC32::Init()) {
+		fprintf(stderr, "crc32_test: CRC32::Init failed\n");
+		return 1;
+	}
+
+	TestKnownValues();
+	TestAgainstZlib();
+	CRC32::Shutdown();
+	return TestResult("crc32_test");
+}
@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <string.h>
+#include <sdk/gfx/dirty.hpp>
+#include "bench.hpp"
+
+namespace {
+	// The fx-CP400's display
+	const int WIDTH = 320;
+	const int HEIGHT = 528;
+
+	uint32_t g_seed = 4;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	/**
+	 * Counts what a demo's frames would send to the display: the pixels
+	 * actually drawn over, and the pixels in the dirty region's rectangles -
+	 * which can take in a few more, where rectangles are merged.
+	 */
+	class Frames {
+	public:
+		Frames() : m_frames(0), m_idle(0), m_rects(0), m_drawn(0), m_dirty(0) {
+			GFX_InitDirtyRegion(&m_region, WIDTH, HEIGHT);
+			memset(m_marked, 0, sizeof(m_marked));
+		}
+
+		void Mark(int x, int y, int width, int height) {
+			GFX_MarkDirty(&m_region, x, y, width, height);
+
+			for (int py = y; py < y + height; ++py) {
+				for (int px = x; px < x + width; ++px) {
+					if (px >= 0 && py >= 0 && px < WIDTH && py < HEIGHT) {
+						m_marked[py][px] = true;
+					}
+				}
+			}
+		}
+
+		void EndFrame() {
+			++m_frames;
+			m_rects += m_region.numRects;
+			m_dirty += GFX_GetDirtyArea(&m_region);
+			if (m_region.numRects == 0) {
+				++m_idle;
+			}
+
+			for (int y = 0; y < HEIGHT; ++y) {
+				for (int x = 0; x < WIDTH; ++x) {
+					m_drawn += m_marked[y][x];
+				}
+			}
+
+			memset(m_marked, 0, sizeof(m_marked));
+			GFX_ClearDirty(&m_region);
+		}
+
+		/**
+		 * Prints the averages for each frame, and the dirty pixels as a
+		 * share of refreshing the whole display every frame.
+		 */
+		void Report(const char *name) const {
+			printf(
+				"%-15s %6d %5d %6.2f %9.0f %9.0f %6.2f%%\n",
+				name, m_frames, m_idle,
+				static_cast<double>(m_rects) / m_frames,
+				static_cast<double>(m_drawn) / m_frames,
+				static_cast<double>(m_dirty) / m_frames,
+				100.0 * m_dirty / (static_cast<double>(m_frames) * WIDTH * HEIGHT)
+			);
+		}
+
+	private:
+		struct GFX_DirtyRegion m_region;
+		bool m_marked[HEIGHT][WIDTH];
+
+		int m_frames;
+		int m_idle;
+		long long m_rects;
+		long long m_drawn;
+		long long m_dirty;
+	};
+
+	/**
+	 * demos/snake: each frame redraws the score and the fruit, draws the new
+	 * head, and rubs out the end of the tail.
+	 */
+	void Snake(Frames *frames) {
+		const int BLOCK = 20;
+		const int COLUMNS = WIDTH / BLOCK;
+		const int ROWS = (HEIGHT - 24) / BLOCK;
+
+		int x = COLUMNS / 2;
+		int y = ROWS / 2;
+		int directionX = 1;
+		int directionY = 0;
+		const int LENGTH = 12;
+		int tailX[LENGTH];
+		int tailY[LENGTH];
+		for (int i = 0; i < LENGTH; ++i) {
+			tailX[i] = x;
+			tailY[i] = y;
+		}
+		int fruitX = Random(COLUMNS);
+		int fruitY = Random(ROWS);
+
+		for (int frame = 0; frame < 2000; ++frame) {
+			// "Score: 0012" in the 8x8 font
+			frames->Mark(4, 8, 88, 8);
+			frames->Mark(x * BLOCK, y * BLOCK + 24, BLOCK, BLOCK);
+			frames->Mark(fruitX * BLOCK, fruitY * BLOCK + 24, BLOCK, BLOCK);
+
+			// Turn now and then, and away from the walls
+			if (Random(5) == 0 || x + directionX < 0 || x + directionX >= COLUMNS ||
+				y + directionY < 0 || y + directionY >= ROWS) {
+				int turn = Random(2) == 0 ? 1 : -1;
+				int newX = directionY * turn;
+				directionY = directionX * turn;
+				directionX = newX;
+				if (x + directionX < 0 || x + directionX >= COLUMNS || y + directionY < 0 || y + directionY >= ROWS) {
+					directionX = -directionX;
+					directionY = -directionY;
+				}
+			}
+
+			frames->Mark(tailX[LENGTH - 1] * BLOCK, tailY[LENGTH - 1] * BLOCK + 24, BLOCK, BLOCK);
+			for (int i = LENGTH - 1; i > 0; --i) {
+				tailX[i] = tailX[i - 1];
+				tailY[i] = tailY[i - 1];
+			}
+			tailX[0] = x;
+			tailY[0] = y;
+			x += directionX;
+			y += directionY;
+
+			if (x == fruitX && y == fruitY) {
+				fruitX = Random(COLUMNS);
+				fruitY = Random(ROWS);
+			}
+
+			frames->EndFrame();
+		}
+	}
+
+	/**
+	 * demos/tetris: a piece of four 18x18 squares falls a row each frame,
+	 * rubbing out where it was. When it lands, any full rows are cleared by
+	 * redrawing the board above them.
+	 */
+	void Tetris(Frames *frames) {
+		const int COLUMNS = 12;
+		const int ROWS = 22;
+
+		auto square = [frames](int x, int y) {
+			frames->Mark(x * 20 + 41, y * 20 + 41, 18, 18);
+		};
+
+		int stack = 0;
+		for (int frame = 0; frame < 2000;) {
+			int x = Random(COLUMNS - 3);
+			int shape = Random(3);
+
+			for (int y = 0; y < ROWS - 1 - stack && frame < 2000; ++y, ++frame) {
+				// The piece is idle some frames, waiting to fall
+				if (Random(3) != 0) {
+					for (int i = 0; i < 4; ++i) {
+						int squareX = x + (shape == 0 ? i : (shape == 1 ? i / 2 : i % 2));
+						int squareY = y + (shape == 0 ? 0 : (shape == 1 ? i % 2 : i / 2));
+						square(squareX, squareY);
+						square(squareX, squareY + 1);
+					}
+				}
+
+				frames->EndFrame();
+			}
+
+			stack = (stack + 1) % (ROWS / 2);
+			if (stack == 0) {
+				frames->Mark(41, 41, COLUMNS * 20, ROWS * 20);
+				frames->EndFrame();
+				++frame;
+			}
+		}
+	}
+
+	/**
+	 * demos/random_circles: a filled circle at each tap, with frames in
+	 * between where nothing is tapped.
+	 */
+	void RandomCircles(Frames *frames) {
+		for (int frame = 0; frame < 2000; ++frame) {
+			if (Random(4) == 0) {
+				int radius = 10 + Random(16);
+				frames->Mark(Random(WIDTH) - radius, Random(HEIGHT) - radius, 2 * radius + 1, 2 * radius + 1);
+			}
+
+			frames->EndFrame();
+		}
+	}
+}
+
+/**
+ * Counts the pixels each demo's frames change, against the whole display the
+ * demos used to refresh every frame.
+ */
+int main() {
+	static Frames snake;
+	static Frames tetris;
+	static Frames circles;
+
+	Snake(&snake);
+	Tetris(&tetris);
+	RandomCircles(&circles);
+
+	printf(
+		"%-15s %6s %5s %6s %9s %9s %7s\n",
+		"demo", "frames", "idle", "rects", "drawn px", "dirty px", "display"
+	);
+	snake.Report("snake");
+	tetris.Report("tetris");
+	circles.Report("random_circles");
+
+	// What merging costs, with more rectangles than the region keeps
+	struct GFX_DirtyRegion region;
+	GFX_InitDirtyRegion(&region, WIDTH, HEIGHT);
+	double time = TimeCalls([&region]() {
+		GFX_ClearDirty(&region);
+		for (int i = 0; i < 16; ++i) {
+			GFX_MarkDirty(&region, Random(WIDTH), Random(HEIGHT), 20, 20);
+		}
+		g_benchSink += region.numRects;
+	});
+	printf("\nGFX_MarkDirty, 16 random 20x20 rectangles: %.2f us\n", time);
+
+	return 0;
+}
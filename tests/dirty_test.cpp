@@ -0,0 +1,130 @@
+#include <string.h>
+#include <sdk/gfx/dirty.hpp>
+#include "test.hpp"
+
+namespace {
+	const int WIDTH = 64;
+	const int HEIGHT = 48;
+
+	uint32_t g_seed = 2;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	bool Covers(const struct GFX_Rect &rect, int x, int y) {
+		return x >= rect.x && y >= rect.y && x < rect.x + rect.width && y < rect.y + rect.height;
+	}
+
+	/**
+	 * Checks the region's rectangles are inside the surface, don't touch
+	 * each other, and cover every pixel in @p marked.
+	 */
+	void CheckRegion(const struct GFX_DirtyRegion &region, const bool marked[HEIGHT][WIDTH]) {
+		CHECK(region.numRects >= 0 && region.numRects <= GFX_DIRTY_MAX_RECTS);
+
+		int area = 0;
+		for (int i = 0; i < region.numRects; ++i) {
+			const struct GFX_Rect &a = region.rects[i];
+			CHECK(a.width > 0 && a.height > 0);
+			CHECK(a.x >= 0 && a.y >= 0 && a.x + a.width <= WIDTH && a.y + a.height <= HEIGHT);
+			area += a.width * a.height;
+
+			for (int j = i + 1; j < region.numRects; ++j) {
+				const struct GFX_Rect &b = region.rects[j];
+				bool touches = a.x <= b.x + b.width && b.x <= a.x + a.width &&
+					a.y <= b.y + b.height && b.y <= a.y + a.height;
+				CHECK(!touches);
+			}
+		}
+
+		CHECK_EQUAL(GFX_GetDirtyArea(&region), area);
+
+		for (int y = 0; y < HEIGHT; ++y) {
+			for (int x = 0; x < WIDTH; ++x) {
+				if (!marked[y][x]) {
+					continue;
+				}
+
+				bool covered = false;
+				for (int i = 0; i < region.numRects; ++i) {
+					covered = covered || Covers(region.rects[i], x, y);
+				}
+				CHECK(covered);
+			}
+		}
+	}
+
+	void TestMerging() {
+		struct GFX_DirtyRegion region;
+		GFX_InitDirtyRegion(&region, WIDTH, HEIGHT);
+		CHECK_EQUAL(region.numRects, 0);
+
+		// Apart, so kept separate
+		GFX_MarkDirty(&region, 0, 0, 10, 10);
+		GFX_MarkDirty(&region, 20, 0, 10, 10);
+		CHECK_EQUAL(region.numRects, 2);
+
+		// Touching the edge of the first is enough to be merged with it
+		GFX_MarkDirty(&region, 10, 0, 5, 10);
+		CHECK_EQUAL(region.numRects, 2);
+		CHECK_EQUAL(GFX_GetDirtyArea(&region), 250);
+
+		// Bridging the gap merges all three
+		GFX_MarkDirty(&region, 14, 5, 7, 1);
+		CHECK_EQUAL(region.numRects, 1);
+		CHECK_EQUAL(GFX_GetDirtyArea(&region), 300);
+
+		// Clipped to the surface, and nothing left of it isn't marked
+		GFX_MarkDirty(&region, -5, 40, 10, 100);
+		CHECK_EQUAL(region.numRects, 2);
+		CHECK_EQUAL(GFX_GetDirtyArea(&region), 300 + 5 * 8);
+		GFX_MarkDirty(&region, WIDTH, 0, 10, 10);
+		GFX_MarkDirty(&region, 0, 0, 0, 10);
+		CHECK_EQUAL(region.numRects, 2);
+
+		GFX_MarkAllDirty(&region);
+		CHECK_EQUAL(region.numRects, 1);
+		CHECK_EQUAL(GFX_GetDirtyArea(&region), WIDTH * HEIGHT);
+
+		GFX_ClearDirty(&region);
+		CHECK_EQUAL(region.numRects, 0);
+		CHECK_EQUAL(GFX_GetDirtyArea(&region), 0);
+	}
+
+	void TestRandomMarks() {
+		static bool marked[HEIGHT][WIDTH];
+
+		for (int i = 0; i < 3000; ++i) {
+			struct GFX_DirtyRegion region;
+			GFX_InitDirtyRegion(&region, WIDTH, HEIGHT);
+			memset(marked, 0, sizeof(marked));
+
+			int numMarks = Random(30);
+			for (int j = 0; j < numMarks; ++j) {
+				int x = Random(WIDTH + 20) - 10;
+				int y = Random(HEIGHT + 20) - 10;
+				int width = Random(20) - 2;
+				int height = Random(20) - 2;
+				GFX_MarkDirty(&region, x, y, width, height);
+
+				for (int py = y; py < y + height; ++py) {
+					for (int px = x; px < x + width; ++px) {
+						if (px >= 0 && py >= 0 && px < WIDTH && py < HEIGHT) {
+							marked[py][px] = true;
+						}
+					}
+				}
+			}
+
+			CheckRegion(region, marked);
+		}
+	}
+}
+
+int main() {
+	TestMerging();
+	TestRandomMarks();
+	return TestResult("dirty_test");
+}
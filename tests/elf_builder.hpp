@@ -0,0 +1,259 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <appdef.hpp>
+#include "elf.h"
+
+/**
+ * Builds app files for the launcher to load.
+ *
+ * The header says the file is big-endian, like a real app, but every field is
+ * written in the host's byte order - the launcher reads them natively, and in
+ * the tests it's running on the host.
+ */
+class ElfBuilder {
+public:
+	explicit ElfBuilder(uint16_t type = ET_EXEC) : m_type(type), m_entry(0), m_stripped(false) {
+
+	}
+
+	void SetEntry(uint32_t entry) {
+		m_entry = entry;
+	}
+
+	/**
+	 * Adds a program header, with @p data as its file contents.
+	 *
+	 * @param memSize The size of the segment in memory, or 0 for the size of
+	 * @p data.
+	 * @param loadAddress The segment's p_paddr, or 0 to use @p address.
+	 */
+	void AddSegment(
+		uint32_t type, uint32_t address, const std::vector<uint8_t> &data,
+		uint32_t memSize = 0, uint32_t flags = PF_R | PF_X, uint32_t loadAddress = 0
+	) {
+		struct Segment segment;
+		segment.type = type;
+		segment.address = address;
+		segment.loadAddress = loadAddress != 0 ? loadAddress : address;
+		segment.memSize = memSize != 0 ? memSize : data.size();
+		segment.flags = flags;
+		segment.data = data;
+		m_segments.push_back(segment);
+	}
+
+	/**
+	 * Adds a section which isn't part of any segment. For a @c SHT_NOBITS
+	 * section, only the size of @p data is used.
+	 *
+	 * @return The section's index in the section header table.
+	 */
+	uint32_t AddSection(
+		const std::string &name, const std::vector<uint8_t> &data,
+		uint32_t type = SHT_PROGBITS, uint32_t flags = 0, uint32_t address = 0,
+		uint32_t link = 0, uint32_t info = 0
+	) {
+		struct Section section;
+		section.name = name;
+		section.type = type;
+		section.flags = flags;
+		section.address = address;
+		section.link = link;
+		section.info = info;
+		section.segment = -1;
+		section.data = data;
+		m_sections.push_back(section);
+		return m_sections.size();
+	}
+
+	/**
+	 * Adds a section covering part of a segment, as the linker would - from
+	 * @p offset bytes into the segment, for @p size bytes.
+	 *
+	 * @return The section's index in the section header table.
+	 */
+	uint32_t AddSegmentSection(
+		const std::string &name, int segment, uint32_t offset, uint32_t size,
+		uint32_t type = SHT_PROGBITS, uint32_t flags = SHF_ALLOC | SHF_EXECINSTR
+	) {
+		uint32_t index = AddSection(name, std::vector<uint8_t>(size), type, flags);
+		m_sections.back().segment = segment;
+		m_sections.back().segmentOffset = offset;
+		return index;
+	}
+
+	/**
+	 * Leaves the section header table out of the file. Apps don't need one to
+	 * be loaded.
+	 */
+	void Strip() {
+		m_stripped = true;
+	}
+
+	/**
+	 * Adds a @c .hollyhock_meta section, as generated by @c APP_INFO (and
+	 * given a checksum by @c tools/hhk_checksum.py, if @p flags says so).
+	 */
+	void AddMeta(
+		const char *name, const char *description, const char *author, const char *version,
+		uint16_t flags = 0, uint32_t crc32 = 0
+	) {
+		const char *strings[HollyhockMetaNumFields] = {name, description, author, version};
+
+		struct HollyhockMetaHeader header = {};
+		header.magic = HOLLYHOCK_META_MAGIC;
+		header.version = HOLLYHOCK_META_VERSION;
+		header.flags = flags;
+		header.minSDKVersion = HOLLYHOCK_SDK_VERSION;
+		header.crc32 = crc32;
+
+		std::vector<uint8_t> data(sizeof(header));
+		for (int i = 0; i < HollyhockMetaNumFields; ++i) {
+			header.fields[i].offset = data.size();
+			header.fields[i].length = strlen(strings[i]);
+			data.insert(data.end(), strings[i], strings[i] + strlen(strings[i]) + 1);
+		}
+
+		memcpy(data.data(), &header, sizeof(header));
+		AddSection(".hollyhock_meta", data);
+	}
+
+	std::vector<uint8_t> Build() const {
+		std::vector<uint8_t> file(sizeof(Elf32_Ehdr));
+
+		uint32_t programHeadersOffset = file.size();
+		file.resize(file.size() + m_segments.size() * sizeof(Elf32_Phdr));
+
+		std::vector<Elf32_Phdr> programHeaders;
+		for (const struct Segment &segment : m_segments) {
+			Elf32_Phdr programHeader = {};
+			programHeader.p_type = segment.type;
+			programHeader.p_offset = Append(&file, segment.data);
+			programHeader.p_vaddr = segment.address;
+			programHeader.p_paddr = segment.loadAddress;
+			programHeader.p_filesz = segment.data.size();
+			programHeader.p_memsz = segment.memSize;
+			programHeader.p_flags = segment.flags;
+			programHeader.p_align = 4;
+			programHeaders.push_back(programHeader);
+		}
+
+		if (!programHeaders.empty()) {
+			memcpy(&file[programHeadersOffset], programHeaders.data(), programHeaders.size() * sizeof(Elf32_Phdr));
+		}
+
+		// The first section is always the null section, and the last is the
+		// section name string table
+		std::vector<Elf32_Shdr> sectionHeaders(1);
+		std::vector<uint8_t> names(1);
+		for (const struct Section &section : m_sections) {
+			Elf32_Shdr sectionHeader = {};
+			sectionHeader.sh_name = AppendName(&names, section.name);
+			sectionHeader.sh_type = section.type;
+			sectionHeader.sh_flags = section.flags;
+			sectionHeader.sh_addr = section.address;
+			sectionHeader.sh_size = section.data.size();
+			sectionHeader.sh_link = section.link;
+			sectionHeader.sh_info = section.info;
+			sectionHeader.sh_addralign = 4;
+
+			if (section.segment >= 0) {
+				const Elf32_Phdr &programHeader = programHeaders[section.segment];
+				sectionHeader.sh_addr = programHeader.p_vaddr + section.segmentOffset;
+				sectionHeader.sh_offset = programHeader.p_offset + section.segmentOffset;
+			} else {
+				sectionHeader.sh_offset = section.type == SHT_NOBITS ? file.size() : Append(&file, section.data);
+			}
+
+			sectionHeaders.push_back(sectionHeader);
+		}
+
+		Elf32_Shdr namesHeader = {};
+		namesHeader.sh_name = AppendName(&names, ".shstrtab");
+		namesHeader.sh_type = SHT_STRTAB;
+		namesHeader.sh_offset = Append(&file, names);
+		namesHeader.sh_size = names.size();
+		namesHeader.sh_addralign = 1;
+		sectionHeaders.push_back(namesHeader);
+
+		uint32_t sectionHeadersOffset = (file.size() + 3) & ~3;
+		if (m_stripped) {
+			sectionHeaders.clear();
+		}
+
+		file.resize(sectionHeadersOffset + sectionHeaders.size() * sizeof(Elf32_Shdr));
+		memcpy(&file[sectionHeadersOffset], sectionHeaders.data(), sectionHeaders.size() * sizeof(Elf32_Shdr));
+
+		Elf32_Ehdr header = {};
+		memcpy(header.e_ident, ELFMAG, SELFMAG);
+		header.e_ident[EI_CLASS] = ELFCLASS32;
+		header.e_ident[EI_DATA] = ELFDATA2MSB;
+		header.e_ident[EI_VERSION] = EV_CURRENT;
+		header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+		header.e_type = m_type;
+		header.e_machine = EM_SH;
+		header.e_version = EV_CURRENT;
+		header.e_entry = m_entry;
+		header.e_phoff = m_segments.empty() ? 0 : programHeadersOffset;
+		header.e_shoff = m_stripped ? 0 : sectionHeadersOffset;
+		header.e_ehsize = sizeof(Elf32_Ehdr);
+		header.e_phentsize = sizeof(Elf32_Phdr);
+		header.e_phnum = m_segments.size();
+		header.e_shentsize = sizeof(Elf32_Shdr);
+		header.e_shnum = sectionHeaders.size();
+		header.e_shstrndx = m_stripped ? 0 : sectionHeaders.size() - 1;
+		memcpy(file.data(), &header, sizeof(header));
+
+		return file;
+	}
+
+private:
+	struct Segment {
+		uint32_t type;
+		uint32_t address;
+		uint32_t loadAddress;
+		uint32_t memSize;
+		uint32_t flags;
+		std::vector<uint8_t> data;
+	};
+
+	struct Section {
+		std::string name;
+		uint32_t type;
+		uint32_t flags;
+		uint32_t address;
+		uint32_t link;
+		uint32_t info;
+		// The segment the section is part of, or -1 if it has its own data
+		int segment;
+		uint32_t segmentOffset;
+		std::vector<uint8_t> data;
+	};
+
+	/**
+	 * Appends @p data to @p file, 4-byte aligned.
+	 *
+	 * @return The offset @p data was written at.
+	 */
+	static uint32_t Append(std::vector<uint8_t> *file, const std::vector<uint8_t> &data) {
+		file->resize((file->size() + 3) & ~3);
+		uint32_t offset = file->size();
+		file->insert(file->end(), data.begin(), data.end());
+		return offset;
+	}
+
+	static uint32_t AppendName(std::vector<uint8_t> *names, const std::string &name) {
+		uint32_t offset = names->size();
+		names->insert(names->end(), name.begin(), name.end());
+		names->push_back('\0');
+		return offset;
+	}
+
+	uint16_t m_type;
+	uint32_t m_entry;
+	bool m_stripped;
+	std::vector<struct Segment> m_segments;
+	std::vector<struct Section> m_sections;
+};
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <vector>
+#include <sdk/gfx/ellipse.hpp>
+#include "bench.hpp"
+
+namespace {
+	const int WIDTH = 320;
+	const int HEIGHT = 528;
+
+	// Circles drawn per timed call, at different places
+	const int DRAWS = 64;
+
+	uint32_t g_seed = 9;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	/**
+	 * drawCircle from demos/random_circles, before it used GFX_FillCircle: a
+	 * distance test for every pixel of the bounding square. Its bounds check
+	 * is fixed, so it doesn't write past the end of the surface.
+	 */
+	void DrawCircleByPixel(struct GFX_Surface *surface, int32_t x0, int32_t y0, int radius, uint16_t color) {
+		for (int32_t dx = -radius; dx < radius; ++dx) {
+			for (int32_t dy = -radius; dy < radius; ++dy) {
+				if (dx * dx + dy * dy < radius * radius) {
+					int32_t x = x0 + dx;
+					int32_t y = y0 + dy;
+
+					if (x < 0 || x >= surface->width || y < 0 || y >= surface->height) {
+						continue;
+					}
+
+					surface->pixels[x + y * surface->stride] = color;
+				}
+			}
+		}
+	}
+
+	template <typename Function>
+	void Report(const char *name, int radius, Function function) {
+		double time = TimeCalls(function) / DRAWS;
+		printf("%-14s %6d %12.0f\n", name, radius, time * 1000);
+	}
+}
+
+/**
+ * Times filling circles with GFX_FillCircle, against the random_circles
+ * demo's old per-pixel code. Also times the outline and ellipses, for
+ * comparison.
+ */
+int main() {
+	std::vector<uint16_t> screen(WIDTH * HEIGHT);
+	struct GFX_Surface surface;
+	GFX_InitSurface(&surface, screen.data(), WIDTH, HEIGHT);
+
+	// The demo draws radii from 10 to 25
+	const int RADII[] = {10, 25, 60, 150};
+
+	printf("%-14s %6s %12s\n", "shape", "radius", "ns/shape");
+	for (int radius : RADII) {
+		int xs[DRAWS];
+		int ys[DRAWS];
+		for (int i = 0; i < DRAWS; ++i) {
+			xs[i] = Random(WIDTH);
+			ys[i] = Random(HEIGHT);
+		}
+
+		Report("demo circle", radius, [&]() {
+			for (int i = 0; i < DRAWS; ++i) {
+				DrawCircleByPixel(&surface, xs[i], ys[i], radius, i);
+			}
+		});
+		Report("FillCircle", radius, [&]() {
+			for (int i = 0; i < DRAWS; ++i) {
+				GFX_FillCircle(&surface, xs[i], ys[i], radius, i);
+			}
+		});
+		Report("DrawCircle", radius, [&]() {
+			for (int i = 0; i < DRAWS; ++i) {
+				GFX_DrawCircle(&surface, xs[i], ys[i], radius, i);
+			}
+		});
+		Report("FillEllipse", radius, [&]() {
+			for (int i = 0; i < DRAWS; ++i) {
+				GFX_FillEllipse(&surface, xs[i], ys[i], radius, radius / 2, i);
+			}
+		});
+
+		g_benchSink += screen[WIDTH * HEIGHT / 2];
+	}
+
+	return 0;
+}
@@ -0,0 +1,199 @@
+#include <math.h>
+#include <vector>
+#include <sdk/gfx/ellipse.hpp>
+#include "canvas.hpp"
+#include "test.hpp"
+
+namespace {
+	// Big enough to hold any shape drawn at its center, unclipped
+	const int WIDTH = 140;
+	const int HEIGHT = 120;
+	const int CENTER_X = WIDTH / 2;
+	const int CENTER_Y = HEIGHT / 2;
+
+	uint32_t g_seed = 6;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	/**
+	 * A shape drawn at the center of a blank surface, as 1s on 0s.
+	 */
+	struct Shape {
+		std::vector<uint16_t> pixels;
+
+		Shape(bool fill, int radiusX, int radiusY) : pixels(WIDTH * HEIGHT) {
+			struct GFX_Surface surface;
+			GFX_InitSurface(&surface, pixels.data(), WIDTH, HEIGHT);
+
+			if (radiusX == radiusY) {
+				if (fill) {
+					GFX_FillCircle(&surface, CENTER_X, CENTER_Y, radiusX, 1);
+				} else {
+					GFX_DrawCircle(&surface, CENTER_X, CENTER_Y, radiusX, 1);
+				}
+			} else {
+				if (fill) {
+					GFX_FillEllipse(&surface, CENTER_X, CENTER_Y, radiusX, radiusY, 1);
+				} else {
+					GFX_DrawEllipse(&surface, CENTER_X, CENTER_Y, radiusX, radiusY, 1);
+				}
+			}
+		}
+
+		bool At(int x, int y) const {
+			return pixels[y * WIDTH + x] != 0;
+		}
+	};
+
+	int RandomRadius(int limit) {
+		// Small radii are where the special cases are
+		return Random(4) == 0 ? Random(4) : Random(limit);
+	}
+
+	/**
+	 * Checks outlines against their fills, and that they're symmetric and
+	 * reach the ends of both axes.
+	 */
+	void TestShapes() {
+		for (int i = 0; i < 4000; ++i) {
+			int radiusY = RandomRadius(CENTER_Y);
+			int radiusX = i % 2 == 0 ? radiusY : RandomRadius(CENTER_X);
+
+			Shape outline(false, radiusX, radiusY);
+			Shape fill(true, radiusX, radiusY);
+
+			CHECK(outline.At(CENTER_X - radiusX, CENTER_Y));
+			CHECK(outline.At(CENTER_X + radiusX, CENTER_Y));
+			CHECK(outline.At(CENTER_X, CENTER_Y - radiusY));
+			CHECK(outline.At(CENTER_X, CENTER_Y + radiusY));
+
+			for (int y = 0; y < HEIGHT; ++y) {
+				int left = WIDTH;
+				int right = -1;
+				for (int x = 0; x < WIDTH; ++x) {
+					if (outline.At(x, y)) {
+						left = x < left ? x : left;
+						right = x;
+					}
+
+					int mirrorX = 2 * CENTER_X - x;
+					int mirrorY = 2 * CENTER_Y - y;
+					if (mirrorX < WIDTH && mirrorY < HEIGHT) {
+						CHECK_EQUAL(outline.At(x, y), outline.At(mirrorX, y));
+						CHECK_EQUAL(outline.At(x, y), outline.At(x, mirrorY));
+					}
+				}
+
+				// Only the rows the ellipse spans are drawn on
+				bool inside = y >= CENTER_Y - radiusY && y <= CENTER_Y + radiusY;
+				CHECK_EQUAL(right >= 0, inside);
+
+				// Each row of the fill runs from one side of the outline to
+				// the other
+				for (int x = 0; x < WIDTH; ++x) {
+					CHECK_EQUAL(fill.At(x, y), x >= left && x <= right);
+				}
+			}
+
+			// Circles stay within half a pixel or so of the true radius
+			if (radiusX == radiusY) {
+				for (int y = 0; y < HEIGHT; ++y) {
+					for (int x = 0; x < WIDTH; ++x) {
+						if (outline.At(x, y)) {
+							double distance = hypot(x - CENTER_X, y - CENTER_Y);
+							CHECK(fabs(distance - radiusX) < 0.75);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	 * Draws shapes hanging off the edges of a smaller, clipped surface, and
+	 * checks they match the unclipped shapes with the parts outside the clip
+	 * rectangle taken away.
+	 */
+	void TestClipping() {
+		for (int i = 0; i < 4000; ++i) {
+			int radiusY = RandomRadius(CENTER_Y);
+			int radiusX = i % 2 == 0 ? radiusY : RandomRadius(CENTER_X);
+			bool fill = Random(2) == 0;
+			Shape shape(fill, radiusX, radiusY);
+
+			int width = 1 + Random(60);
+			int height = 1 + Random(60);
+			Canvas canvas(width, height, width + Random(3), Random(2));
+			if (Random(2) == 0) {
+				struct GFX_Rect clip = {Random(width) - 5, Random(height) - 5, Random(width), Random(height)};
+				GFX_SetClip(&canvas.surface, &clip);
+			}
+
+			int centerX = Random(width + 2 * radiusX + 2) - radiusX - 1;
+			int centerY = Random(height + 2 * radiusY + 2) - radiusY - 1;
+			uint16_t color = 0x1234;
+
+			if (radiusX == radiusY) {
+				if (fill) {
+					GFX_FillCircle(&canvas.surface, centerX, centerY, radiusX, color);
+				} else {
+					GFX_DrawCircle(&canvas.surface, centerX, centerY, radiusX, color);
+				}
+			} else {
+				if (fill) {
+					GFX_FillEllipse(&canvas.surface, centerX, centerY, radiusX, radiusY, color);
+				} else {
+					GFX_DrawEllipse(&canvas.surface, centerX, centerY, radiusX, radiusY, color);
+				}
+			}
+
+			for (int y = 0; y < height; ++y) {
+				for (int x = 0; x < width; ++x) {
+					int shapeX = x - centerX + CENTER_X;
+					int shapeY = y - centerY + CENTER_Y;
+					if (shapeX >= 0 && shapeY >= 0 && shapeX < WIDTH && shapeY < HEIGHT && shape.At(shapeX, shapeY)) {
+						canvas.Set(x, y, color);
+					}
+				}
+			}
+
+			CHECK(canvas.Matches());
+		}
+	}
+
+	void TestLimits() {
+		Canvas canvas(40, 30, 40);
+
+		// Negative radii draw nothing
+		GFX_DrawCircle(&canvas.surface, 20, 15, -1, 0);
+		GFX_FillCircle(&canvas.surface, 20, 15, -1, 0);
+		GFX_DrawEllipse(&canvas.surface, 20, 15, 5, -1, 0);
+		GFX_FillEllipse(&canvas.surface, 20, 15, -1, 5, 0);
+		CHECK(canvas.Matches());
+
+		// The biggest radius, with the edge of the circle passing through
+		// the surface - anything drawn has to be in the top left corner
+		GFX_DrawCircle(&canvas.surface, 32767 + 10, 15, 32767, 0);
+		GFX_FillEllipse(&canvas.surface, 20, -32767 + 5, 32767, 32767, 0);
+		for (int y = 0; y < 30; ++y) {
+			for (int x = 0; x < 40; ++x) {
+				if (x <= 11 || y <= 5) {
+					canvas.Set(x, y, canvas.Get(x, y));
+				}
+			}
+		}
+		CHECK(canvas.Matches());
+		CHECK_EQUAL(canvas.Get(10, 15), 0);
+		CHECK_EQUAL(canvas.Get(20, 5), 0);
+	}
+}
+
+int main() {
+	TestShapes();
+	TestClipping();
+	TestLimits();
+	return TestResult("ellipse_test");
+}
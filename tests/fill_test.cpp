@@ -0,0 +1,96 @@
+#include <sdk/gfx/fill.hpp>
+#include "canvas.hpp"
+#include "test.hpp"
+
+namespace {
+	uint32_t g_seed = 1;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	void ExpectRect(Canvas *canvas, int x, int y, int width, int height, uint16_t color) {
+		for (int j = y; j < y + height; ++j) {
+			for (int i = x; i < x + width; ++i) {
+				if (i >= 0 && j >= 0 && i < canvas->surface.width && j < canvas->surface.height) {
+					canvas->Set(i, j, color);
+				}
+			}
+		}
+	}
+
+	void TestFillSpan() {
+		// Every alignment, and counts either side of the 8 pixel loop
+		for (int offset = 0; offset < 2; ++offset) {
+			for (int count = -1; count < 40; ++count) {
+				Canvas canvas(40, 1, 40, offset);
+				GFX_FillSpan(canvas.surface.pixels, count, 0x1234);
+				ExpectRect(&canvas, 0, 0, count, 1, 0x1234);
+				CHECK(canvas.Matches());
+			}
+		}
+	}
+
+	/**
+	 * Draws random shapes hanging off the edges of surfaces of various
+	 * alignments and strides, some with a clip rectangle.
+	 */
+	void TestShapes() {
+		for (int i = 0; i < 20000; ++i) {
+			int width = 1 + Random(40);
+			int height = 1 + Random(25);
+			int stride = width + (Random(2) == 0 ? 0 : Random(5));
+			Canvas canvas(width, height, stride, Random(2));
+
+			if (Random(2) == 0) {
+				struct GFX_Rect clip = {Random(60) - 10, Random(40) - 10, Random(50), Random(35)};
+				GFX_SetClip(&canvas.surface, &clip);
+			}
+
+			int x = Random(60) - 15;
+			int y = Random(40) - 10;
+			int w = Random(60) - 5;
+			int h = Random(40) - 5;
+			uint16_t color = Random(0x10000);
+
+			switch (Random(4)) {
+			case 0:
+				GFX_FillRect(&canvas.surface, x, y, w, h, color);
+				ExpectRect(&canvas, x, y, w, h, color);
+				break;
+			case 1:
+				GFX_HLine(&canvas.surface, x, y, w, color);
+				ExpectRect(&canvas, x, y, w, 1, color);
+				break;
+			case 2:
+				GFX_VLine(&canvas.surface, x, y, h, color);
+				ExpectRect(&canvas, x, y, 1, h, color);
+				break;
+			default:
+				GFX_Clear(&canvas.surface, color);
+				ExpectRect(&canvas, 0, 0, width, height, color);
+				break;
+			}
+
+			CHECK(canvas.Matches());
+		}
+	}
+
+	void TestEmptyClip() {
+		Canvas canvas(20, 20, 20);
+		struct GFX_Rect clip = {25, 5, 10, 10};
+		GFX_SetClip(&canvas.surface, &clip);
+
+		GFX_Clear(&canvas.surface, 0xFFFF);
+		GFX_FillRect(&canvas.surface, -100, -100, 200, 200, 0xFFFF);
+		CHECK(canvas.Matches());
+	}
+}
+
+int main() {
+	TestFillSpan();
+	TestShapes();
+	TestEmptyClip();
+	return TestResult("fill_test");
+}
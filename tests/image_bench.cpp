@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include <vector>
+#include <sdk/gfx/image.hpp>
+#include "bench.hpp"
+#include "qoi_encode.hpp"
+
+namespace {
+	// The screenshots in the user documentation, run from the tests folder
+	const char *const IMAGES[] = {
+		"../doc/user/using_launcher.png",
+		"../doc/user/patching_rc_replace1.png",
+		"../doc/user/patching_rc_replace2.png",
+		"../doc/user/patching_dlls.png"
+	};
+
+	bool ReadFile(const char *path, std::vector<uint8_t> *data) {
+		FILE *file = fopen(path, "rb");
+		if (file == nullptr) {
+			return false;
+		}
+
+		uint8_t buffer[4096];
+		size_t size;
+		while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+			data->insert(data->end(), buffer, buffer + size);
+		}
+
+		fclose(file);
+		return true;
+	}
+
+	uint32_t Get32(const uint8_t *data) {
+		return data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
+	}
+
+	int Paeth(int a, int b, int c) {
+		int p = a + b - c;
+		int pa = abs(p - a);
+		int pb = abs(p - b);
+		int pc = abs(p - c);
+		return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+	}
+
+	/**
+	 * Decodes an 8-bit RGB or RGBA PNG the usual way, with zlib decompressing
+	 * the whole image into memory at once. This gets the pixels to re-encode
+	 * as QOI, and is timed as a yardstick for the streaming decoder.
+	 *
+	 * @return False if the PNG isn't one it can decode.
+	 */
+	bool DecodePNG(const std::vector<uint8_t> &png, std::vector<struct RGBA> *pixels, int *width, int *height, bool *alpha) {
+		std::vector<uint8_t> compressed;
+		int colorType = -1;
+
+		for (size_t offset = 8; offset + 12 <= png.size();) {
+			uint32_t length = Get32(&png[offset]);
+			const uint8_t *type = &png[offset + 4];
+			const uint8_t *data = &png[offset + 8];
+
+			if (memcmp(type, "IHDR", 4) == 0) {
+				*width = Get32(data);
+				*height = Get32(data + 4);
+				if (data[8] != 8 || data[12] != 0) {
+					return false;
+				}
+				colorType = data[9];
+			} else if (memcmp(type, "IDAT", 4) == 0) {
+				compressed.insert(compressed.end(), data, data + length);
+			}
+
+			offset += length + 12;
+		}
+
+		if (colorType != 2 && colorType != 6) {
+			return false;
+		}
+
+		int channels = colorType == 6 ? 4 : 3;
+		size_t rowSize = *width * channels;
+		std::vector<uint8_t> filtered((rowSize + 1) * *height);
+		uLongf size = filtered.size();
+		if (uncompress(filtered.data(), &size, compressed.data(), compressed.size()) != Z_OK) {
+			return false;
+		}
+
+		std::vector<uint8_t> previous(rowSize);
+		std::vector<uint8_t> row(rowSize);
+		pixels->clear();
+		for (int y = 0; y < *height; ++y) {
+			const uint8_t *line = &filtered[y * (rowSize + 1)];
+			for (size_t i = 0; i < rowSize; ++i) {
+				int a = i >= static_cast<size_t>(channels) ? row[i - channels] : 0;
+				int b = previous[i];
+				int c = i >= static_cast<size_t>(channels) ? previous[i - channels] : 0;
+				const int predictions[] = {0, a, b, (a + b) >> 1, Paeth(a, b, c)};
+				row[i] = line[1 + i] + predictions[line[0] % 5];
+			}
+
+			for (int x = 0; x < *width; ++x) {
+				const uint8_t *pixel = &row[x * channels];
+				pixels->push_back({pixel[0], pixel[1], pixel[2], channels == 4 ? pixel[3] : static_cast<uint8_t>(255)});
+			}
+
+			previous = row;
+		}
+
+		*alpha = channels == 4;
+		return true;
+	}
+
+	/**
+	 * Draws an image from memory onto a surface its size.
+	 */
+	void Draw(const std::vector<uint8_t> &file, struct GFX_Surface *surface) {
+		struct GFX_ImageSource source;
+		GFX_InitMemorySource(&source, file.data(), file.size());
+
+		struct GFX_Image image;
+		if (GFX_OpenImage(&image, &source) != 0 || GFX_DrawImage(&image, surface, 0, 0) != 0) {
+			fprintf(stderr, "image_bench: can't decode an image\n");
+			exit(1);
+		}
+	}
+}
+
+/**
+ * Times decoding the sample images, as PNGs and re-encoded as QOI, against
+ * decoding the PNGs into memory with zlib.
+ */
+int main() {
+	printf(
+		"%-26s %9s %-6s %10s %10s %9s\n",
+		"image", "size", "format", "file bytes", "decode us", "Mpixel/s"
+	);
+
+	for (const char *path : IMAGES) {
+		std::vector<uint8_t> png;
+		std::vector<struct RGBA> pixels;
+		int width, height;
+		bool alpha;
+		if (!ReadFile(path, &png) || !DecodePNG(png, &pixels, &width, &height, &alpha)) {
+			fprintf(stderr, "image_bench: can't read %s\n", path);
+			return 1;
+		}
+
+		std::vector<uint8_t> qoi = EncodeQOI(pixels, width, height, alpha);
+		std::vector<uint16_t> screen(width * height);
+		struct GFX_Surface surface;
+		GFX_InitSurface(&surface, screen.data(), width, height);
+
+		const char *name = strrchr(path, '/') + 1;
+		char size[16];
+		snprintf(size, sizeof(size), "%dx%d", width, height);
+		auto report = [&](const char *format, size_t fileSize, double time) {
+			printf("%-26s %9s %-6s %10zu %10.0f %9.1f\n", name, size, format, fileSize, time, width * height / time);
+		};
+
+		report("png", png.size(), TimeCalls([&]() {
+			Draw(png, &surface);
+		}));
+		report("qoi", qoi.size(), TimeCalls([&]() {
+			Draw(qoi, &surface);
+		}));
+		report("zlib", png.size(), TimeCalls([&]() {
+			DecodePNG(png, &pixels, &width, &height, &alpha);
+			g_benchSink += pixels[0].r;
+		}));
+
+		g_benchSink += screen[0];
+	}
+
+	return 0;
+}
@@ -0,0 +1,564 @@
+#include <stdlib.h>
+#include <zlib.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <sdk/gfx/image.hpp>
+#include "canvas.hpp"
+#include "os_stubs.hpp"
+#include "qoi_encode.hpp"
+#include "test.hpp"
+
+namespace {
+	const char IMAGE_PATH[] = "\\fls0\\image";
+
+	const int SURFACE_WIDTH = 64;
+	const int SURFACE_HEIGHT = 48;
+
+	// PNG color types
+	const int PNG_GRAY = 0;
+	const int PNG_RGB = 2;
+	const int PNG_PALETTE = 3;
+	const int PNG_GRAY_ALPHA = 4;
+	const int PNG_RGBA = 6;
+
+	// How the PNG's image data is compressed
+	enum Deflate {
+		STORED,
+		FIXED,
+		DYNAMIC
+	};
+
+	// The ways an image can be read
+	enum Source {
+		MEMORY,
+		PIECES,
+		FILE_READ,
+		FILE_MAPPED,
+		NUM_SOURCES
+	};
+
+	uint32_t g_seed = 7;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	/**
+	 * A pixel an image should decode to: its color in RGB565 format, and how
+	 * opaque it is, out of 255.
+	 */
+	struct Pixel {
+		uint16_t color;
+		uint8_t alpha;
+	};
+
+	/**
+	 * An image file, along with what it should decode to.
+	 */
+	struct TestImage {
+		std::vector<uint8_t> file;
+		int width, height;
+		std::vector<struct Pixel> pixels;
+	};
+
+	uint16_t ToRGB565(int red, int green, int blue) {
+		return (red & 0xF8) << 8 | (green & 0xFC) << 3 | blue >> 3;
+	}
+
+	/**
+	 * Draws a pixel over @p background, with the alpha rounded to the 33
+	 * levels GFX_BlendColor has.
+	 */
+	uint16_t Composite(uint16_t background, struct Pixel pixel) {
+		if (pixel.alpha == 255) {
+			return pixel.color;
+		}
+
+		if (pixel.alpha == 0) {
+			return background;
+		}
+
+		int alpha = (pixel.alpha + 4) >> 3;
+		auto channel = [=](int shift, int mask) {
+			int color = (pixel.color >> shift) & mask;
+			int old = (background >> shift) & mask;
+			return ((color * alpha + old * (32 - alpha)) >> 5) << shift;
+		};
+
+		return channel(11, 0x1F) | channel(5, 0x3F) | channel(0, 0x1F);
+	}
+
+	/*
+	 * QOI
+	 */
+
+	/**
+	 * Makes a QOI image with runs, repeats, small and large changes, so
+	 * every kind of chunk comes up.
+	 */
+	struct TestImage MakeQOI(int width, int height, bool alpha) {
+		std::vector<struct RGBA> pixels;
+		for (int i = 0; i < width * height; ++i) {
+			int kind = Random(10);
+			if (kind < 3 && !pixels.empty()) {
+				pixels.push_back(pixels.back());
+			} else if (kind < 5 && pixels.size() > 5) {
+				pixels.push_back(pixels[pixels.size() - 1 - Random(4)]);
+			} else {
+				struct RGBA base = pixels.empty() ? RGBA{0, 0, 0, 255} : pixels.back();
+				int spread = kind < 7 ? 2 : 20;
+				if (kind < 9) {
+					base.r += Random(2 * spread) - spread;
+					base.g += Random(2 * spread) - spread;
+					base.b += Random(2 * spread) - spread;
+				} else {
+					base.r = Random(256);
+					base.g = Random(256);
+					base.b = Random(256);
+					if (alpha) {
+						int choice = Random(3);
+						base.a = choice == 0 ? 255 : (choice == 1 ? 0 : Random(256));
+					}
+				}
+				pixels.push_back(base);
+			}
+		}
+
+		struct TestImage image;
+		image.file = EncodeQOI(pixels, width, height, alpha);
+		image.width = width;
+		image.height = height;
+		for (const struct RGBA &pixel : pixels) {
+			image.pixels.push_back({ToRGB565(pixel.r, pixel.g, pixel.b), pixel.a});
+		}
+
+		return image;
+	}
+
+	/*
+	 * PNG
+	 */
+
+	void AddChunk(std::vector<uint8_t> *png, const char *type, const std::vector<uint8_t> &data) {
+		Put32(png, data.size());
+		size_t start = png->size();
+		png->insert(png->end(), type, type + 4);
+		png->insert(png->end(), data.begin(), data.end());
+		Put32(png, crc32(0, &(*png)[start], png->size() - start));
+	}
+
+	int Paeth(int a, int b, int c) {
+		int p = a + b - c;
+		int pa = abs(p - a);
+		int pb = abs(p - b);
+		int pc = abs(p - c);
+		return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+	}
+
+	/**
+	 * Filters each row with a randomly chosen filter, so all five are
+	 * decoded.
+	 */
+	std::vector<uint8_t> Filter(const std::vector<std::vector<uint8_t>> &rows, int bytesPerPixel) {
+		std::vector<uint8_t> out;
+		std::vector<uint8_t> previous(rows[0].size());
+
+		for (const std::vector<uint8_t> &row : rows) {
+			int filter = Random(5);
+			out.push_back(filter);
+
+			for (size_t i = 0; i < row.size(); ++i) {
+				int a = i >= static_cast<size_t>(bytesPerPixel) ? row[i - bytesPerPixel] : 0;
+				int b = previous[i];
+				int c = i >= static_cast<size_t>(bytesPerPixel) ? previous[i - bytesPerPixel] : 0;
+				const int predictions[] = {0, a, b, (a + b) >> 1, Paeth(a, b, c)};
+				out.push_back(row[i] - predictions[filter]);
+			}
+
+			previous = row;
+		}
+
+		return out;
+	}
+
+	std::vector<uint8_t> Compress(const std::vector<uint8_t> &data, enum Deflate method) {
+		z_stream stream = {};
+		deflateInit2(
+			&stream, method == STORED ? 0 : 9, Z_DEFLATED, 15, 9,
+			method == FIXED ? Z_FIXED : Z_DEFAULT_STRATEGY
+		);
+
+		std::vector<uint8_t> out(deflateBound(&stream, data.size()));
+		stream.next_in = const_cast<uint8_t *>(data.data());
+		stream.avail_in = data.size();
+		stream.next_out = out.data();
+		stream.avail_out = out.size();
+		deflate(&stream, Z_FINISH);
+
+		out.resize(stream.total_out);
+		deflateEnd(&stream);
+		return out;
+	}
+
+	/**
+	 * Makes a PNG of the given type and depth, with mostly smooth samples
+	 * (so there's something to compress) and some noise. Gray and RGB images
+	 * may have a transparent color, and palette images partly transparent
+	 * colors.
+	 */
+	struct TestImage MakePNG(int width, int height, int colorType, int depth, enum Deflate method) {
+		const int channelsPerType[] = {1, 0, 3, 1, 2, 0, 4};
+		int channels = channelsPerType[colorType];
+		int maxSample = (1 << depth) - 1;
+
+		std::vector<uint8_t> palette;
+		std::vector<uint8_t> paletteAlpha;
+		if (colorType == PNG_PALETTE) {
+			for (int i = 0; i < (1 << depth) * 3; ++i) {
+				palette.push_back(Random(256));
+			}
+
+			// Possibly fewer alphas than colors - the rest are opaque
+			if (Random(5) < 3) {
+				int numAlphas = 1 + Random(1 << depth);
+				for (int i = 0; i < numAlphas; ++i) {
+					int choice = Random(3);
+					paletteAlpha.push_back(choice == 0 ? 255 : (choice == 1 ? 0 : Random(256)));
+				}
+			}
+		}
+
+		std::vector<uint16_t> samples;
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				for (int c = 0; c < channels; ++c) {
+					bool smooth = Random(10) != 0;
+					samples.push_back(smooth ? (x * 7 + y * 3 + c * 50 + Random(3)) % (maxSample + 1) : Random(maxSample + 1));
+				}
+			}
+		}
+
+		std::vector<uint16_t> key;
+		if ((colorType == PNG_GRAY || colorType == PNG_RGB) && Random(2) == 0) {
+			int pixel = Random(width * height);
+			key.assign(&samples[pixel * channels], &samples[pixel * channels + channels]);
+		}
+
+		std::vector<std::vector<uint8_t>> rows;
+		for (int y = 0; y < height; ++y) {
+			std::vector<uint8_t> row;
+			const uint16_t *sample = &samples[y * width * channels];
+
+			if (depth < 8) {
+				row.resize((width * depth + 7) / 8);
+				for (int x = 0; x < width; ++x) {
+					int bit = x * depth;
+					row[bit / 8] |= sample[x] << (8 - depth - bit % 8);
+				}
+			} else {
+				for (int i = 0; i < width * channels; ++i) {
+					if (depth == 16) {
+						row.push_back(sample[i] >> 8);
+					}
+					row.push_back(sample[i]);
+				}
+			}
+
+			rows.push_back(row);
+		}
+
+		int bytesPerPixel = std::max(1, channels * depth / 8);
+		std::vector<uint8_t> data = Compress(Filter(rows, bytesPerPixel), method);
+
+		std::vector<uint8_t> header;
+		Put32(&header, width);
+		Put32(&header, height);
+		header.insert(header.end(), {static_cast<uint8_t>(depth), static_cast<uint8_t>(colorType), 0, 0, 0});
+
+		struct TestImage image;
+		image.file = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+		AddChunk(&image.file, "IHDR", header);
+
+		const char comment[] = "Comment\0hello";
+		AddChunk(&image.file, "tEXt", std::vector<uint8_t>(comment, comment + sizeof(comment) - 1));
+
+		if (colorType == PNG_PALETTE) {
+			AddChunk(&image.file, "PLTE", palette);
+			if (!paletteAlpha.empty()) {
+				AddChunk(&image.file, "tRNS", paletteAlpha);
+			}
+		}
+
+		if (!key.empty()) {
+			std::vector<uint8_t> transparent;
+			for (uint16_t value : key) {
+				transparent.push_back(value >> 8);
+				transparent.push_back(value);
+			}
+			AddChunk(&image.file, "tRNS", transparent);
+		}
+
+		// The image data is split over several chunks, at random
+		for (size_t i = 0; i < data.size();) {
+			size_t length = std::min<size_t>(1 + Random(data.size() / 3 + 1), data.size() - i);
+			AddChunk(&image.file, "IDAT", std::vector<uint8_t>(data.begin() + i, data.begin() + i + length));
+			i += length;
+		}
+
+		AddChunk(&image.file, "IEND", {});
+
+		image.width = width;
+		image.height = height;
+		for (int i = 0; i < width * height; ++i) {
+			const uint16_t *sample = &samples[i * channels];
+			auto top = [depth](int value) {
+				return depth == 16 ? value >> 8 : value;
+			};
+
+			int red, green, blue;
+			int alpha = 255;
+			if (colorType == PNG_PALETTE) {
+				red = palette[sample[0] * 3];
+				green = palette[sample[0] * 3 + 1];
+				blue = palette[sample[0] * 3 + 2];
+				if (sample[0] < paletteAlpha.size()) {
+					alpha = paletteAlpha[sample[0]];
+				}
+			} else if (colorType == PNG_GRAY || colorType == PNG_GRAY_ALPHA) {
+				red = green = blue = depth < 8 ? sample[0] * (255 / maxSample) : top(sample[0]);
+				if (colorType == PNG_GRAY_ALPHA) {
+					alpha = top(sample[1]);
+				}
+			} else {
+				red = top(sample[0]);
+				green = top(sample[1]);
+				blue = top(sample[2]);
+				if (colorType == PNG_RGBA) {
+					alpha = top(sample[3]);
+				}
+			}
+
+			if (!key.empty() && std::equal(key.begin(), key.end(), sample)) {
+				alpha = 0;
+			}
+
+			image.pixels.push_back({ToRGB565(red, green, blue), static_cast<uint8_t>(alpha)});
+		}
+
+		return image;
+	}
+
+	std::vector<struct TestImage> MakeImages() {
+		std::vector<struct TestImage> images;
+
+		const int types[][2] = {
+			{PNG_GRAY, 1}, {PNG_GRAY, 2}, {PNG_GRAY, 4}, {PNG_GRAY, 8}, {PNG_GRAY, 16},
+			{PNG_RGB, 8}, {PNG_RGB, 16},
+			{PNG_PALETTE, 1}, {PNG_PALETTE, 2}, {PNG_PALETTE, 4}, {PNG_PALETTE, 8},
+			{PNG_GRAY_ALPHA, 8}, {PNG_GRAY_ALPHA, 16},
+			{PNG_RGBA, 8}, {PNG_RGBA, 16}
+		};
+
+		for (const int *type : types) {
+			for (enum Deflate method : {STORED, FIXED, DYNAMIC}) {
+				images.push_back(MakePNG(1 + Random(70), 1 + Random(40), type[0], type[1], method));
+			}
+		}
+
+		for (int i = 0; i < 12; ++i) {
+			images.push_back(MakeQOI(1 + Random(90), 1 + Random(50), i % 2 == 1));
+		}
+
+		return images;
+	}
+
+	/*
+	 * Drawing
+	 */
+
+	const uint8_t *g_piecesData;
+
+	/**
+	 * Hands out the data a few bytes at a time, so chunks, headers and
+	 * pixels are split between pieces.
+	 */
+	int NextPiece(struct GFX_ImageSource *source) {
+		int length = std::min(1 + Random(7), source->size - source->offset);
+		std::copy(g_piecesData + source->offset, g_piecesData + source->offset + length, source->buffer);
+
+		source->data = source->buffer;
+		source->length = length;
+		source->offset += length;
+		return length;
+	}
+
+	/**
+	 * Opens and draws an image file from one of the sources. The data is
+	 * copied to a buffer of exactly its size, so the address sanitizer
+	 * catches reading past the end.
+	 *
+	 * @param[out] image The image, as opened.
+	 * @return The error from opening or drawing the image, if any.
+	 */
+	int Draw(
+		const std::vector<uint8_t> &file, enum Source sourceType, struct GFX_Surface *surface,
+		int x, int y, struct GFX_Image *image
+	) {
+		std::unique_ptr<uint8_t[]> data(new uint8_t[file.size()]);
+		std::copy(file.begin(), file.end(), data.get());
+
+		struct GFX_ImageSource source;
+		int fd = -1;
+
+		if (sourceType == MEMORY) {
+			GFX_InitMemorySource(&source, data.get(), file.size());
+		} else if (sourceType == PIECES) {
+			g_piecesData = data.get();
+			source.next = NextPiece;
+			source.data = source.buffer;
+			source.length = 0;
+			source.fd = -1;
+			source.offset = 0;
+			source.size = file.size();
+		} else {
+			Stubs::AddFile(IMAGE_PATH, file);
+			Stubs::SetMapSectors(sourceType == FILE_MAPPED);
+			fd = Stubs::OpenFile(IMAGE_PATH);
+			CHECK(fd >= 0);
+
+			int ret = sourceType == FILE_MAPPED ? GFX_InitMappedFileSource(&source, fd) : GFX_InitFileSource(&source, fd);
+			CHECK_EQUAL(ret, 0);
+		}
+
+		int ret = GFX_OpenImage(image, &source);
+		if (ret == 0) {
+			ret = GFX_DrawImage(image, surface, x, y);
+		}
+
+		if (fd >= 0) {
+			Stubs::CloseFile(fd);
+		}
+
+		Stubs::SetMapSectors(false);
+		return ret;
+	}
+
+	/**
+	 * Draws each image from each source, at the top left of an unclipped
+	 * surface and at random places on clipped ones, and compares every pixel
+	 * with the image blended onto what was there.
+	 */
+	void TestDecode(const std::vector<struct TestImage> &images) {
+		for (const struct TestImage &image : images) {
+			for (int i = 0; i < 3; ++i) {
+				int x = 0;
+				int y = 0;
+				struct GFX_Rect clip = {Random(20), Random(20), 10 + Random(SURFACE_WIDTH - 10), 10 + Random(SURFACE_HEIGHT - 10)};
+				if (i > 0) {
+					x = Random(image.width + SURFACE_WIDTH) - image.width;
+					y = Random(image.height + SURFACE_HEIGHT) - image.height;
+				}
+
+				int stride = SURFACE_WIDTH + Random(3);
+				int offset = Random(2);
+
+				for (int source = 0; source < NUM_SOURCES; ++source) {
+					Canvas canvas(SURFACE_WIDTH, SURFACE_HEIGHT, stride, offset);
+					if (i > 0) {
+						GFX_SetClip(&canvas.surface, &clip);
+					}
+
+					struct GFX_Image opened;
+					CHECK_EQUAL(Draw(image.file, static_cast<enum Source>(source), &canvas.surface, x, y, &opened), 0);
+					CHECK_EQUAL(opened.width, image.width);
+					CHECK_EQUAL(opened.height, image.height);
+
+					for (int j = 0; j < image.height; ++j) {
+						for (int k = 0; k < image.width; ++k) {
+							int surfaceX = x + k;
+							int surfaceY = y + j;
+							if (surfaceX >= 0 && surfaceY >= 0 && surfaceX < SURFACE_WIDTH && surfaceY < SURFACE_HEIGHT) {
+								uint16_t background = canvas.Expected(surfaceX, surfaceY);
+								canvas.Set(surfaceX, surfaceY, Composite(background, image.pixels[j * image.width + k]));
+							}
+						}
+					}
+
+					CHECK(canvas.Matches());
+				}
+			}
+		}
+	}
+
+	/**
+	 * Truncates images and flips bits in them. Whatever happens, nothing may
+	 * be drawn outside the image or the clip rectangle, nothing read outside
+	 * the data, and any error must be one of the image errors.
+	 */
+	void TestCorrupt(const std::vector<struct TestImage> &images) {
+		for (int i = 0; i < 3000; ++i) {
+			std::vector<uint8_t> file = images[Random(images.size())].file;
+			if (Random(3) == 0) {
+				file.resize(Random(file.size()));
+			} else {
+				int numFlips = 1 + Random(4);
+				for (int j = 0; j < numFlips; ++j) {
+					file[Random(file.size())] ^= 1 << Random(8);
+				}
+			}
+
+			Canvas canvas(SURFACE_WIDTH, SURFACE_HEIGHT, SURFACE_WIDTH, Random(2));
+			struct GFX_Rect clip = {Random(20), Random(20), 10 + Random(SURFACE_WIDTH - 10), 10 + Random(SURFACE_HEIGHT - 10)};
+			GFX_SetClip(&canvas.surface, &clip);
+
+			int x = Random(60) - 20;
+			int y = Random(40) - 20;
+			struct GFX_Image image = {};
+			int ret = Draw(file, static_cast<enum Source>(Random(NUM_SOURCES)), &canvas.surface, x, y, &image);
+			CHECK(ret == 0 || ret == GFX_IMAGE_ECORRUPT || ret == GFX_IMAGE_EUNSUPPORTED);
+
+			// Anything may have been drawn where the image is
+			for (int py = 0; py < SURFACE_HEIGHT; ++py) {
+				for (int px = 0; px < SURFACE_WIDTH; ++px) {
+					if (px >= x && py >= y && px - x < image.width && py - y < image.height) {
+						canvas.Set(px, py, canvas.Get(px, py));
+					}
+				}
+			}
+
+			CHECK(canvas.Matches());
+		}
+	}
+
+	void TestUnsupported(const std::vector<struct TestImage> &images) {
+		Canvas canvas(SURFACE_WIDTH, SURFACE_HEIGHT, SURFACE_WIDTH);
+		struct GFX_Image image;
+
+		const char gif[] = "GIF89a\x01\x00\x01\x00";
+		CHECK_EQUAL(Draw(std::vector<uint8_t>(gif, gif + sizeof(gif)), MEMORY, &canvas.surface, 0, 0, &image), GFX_IMAGE_EUNSUPPORTED);
+		CHECK_EQUAL(Draw({}, MEMORY, &canvas.surface, 0, 0, &image), GFX_IMAGE_EUNSUPPORTED);
+
+		// Interlaced, and a palette with 16 bits per sample
+		std::vector<uint8_t> png = images[0].file;
+		png[28] = 1;
+		CHECK_EQUAL(Draw(png, MEMORY, &canvas.surface, 0, 0, &image), GFX_IMAGE_EUNSUPPORTED);
+		png = images[0].file;
+		png[24] = 16;
+		png[25] = PNG_PALETTE;
+		CHECK_EQUAL(Draw(png, MEMORY, &canvas.surface, 0, 0, &image), GFX_IMAGE_EUNSUPPORTED);
+
+		CHECK(canvas.Matches());
+	}
+}
+
+int main() {
+	Stubs::Reset();
+
+	std::vector<struct TestImage> images = MakeImages();
+	TestDecode(images);
+	TestCorrupt(images);
+	TestUnsupported(images);
+	return TestResult("image_test");
+}
@@ -0,0 +1,567 @@
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+#include "apps.hpp"
+#include "elf_builder.hpp"
+#include "os_stubs.hpp"
+#include "test.hpp"
+#include "timing.hpp"
+
+namespace {
+	const char INDEX_PATH[] = "\\fls0\\.hhkindex";
+	const char INDEX_TEMP_PATH[] = "\\fls0\\.hhkindex.new";
+
+	// Mirror the layout of the app index in launcher/apps.cpp (version 5), so
+	// the tests can corrupt specific fields.
+	struct IndexHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t numApps;
+		uint32_t numDirs;
+		uint32_t stringsSize;
+	};
+
+	struct IndexRecord {
+		uint32_t fileSize;
+		uint16_t lastModifiedDate;
+		uint16_t lastModifiedTime;
+		uint16_t lengths[5];
+		uint16_t reserved;
+		uint32_t iconOffset;
+	};
+
+	struct IndexDirRecord {
+		uint32_t firstApp;
+		uint32_t numApps;
+		int32_t parent;
+		uint16_t lastModifiedDate;
+		uint16_t lastModifiedTime;
+		uint16_t pathLength;
+		uint16_t hasStat;
+		uint32_t numEntries;
+		uint32_t entriesSize;
+	};
+
+	std::vector<uint8_t> MakeApp(const char *name) {
+		ElfBuilder elf;
+		elf.SetEntry(Apps::APP_LOAD_ADDRESS);
+		elf.AddSegment(PT_LOAD, Apps::APP_LOAD_ADDRESS, {0x00, 0x09, 0x00, 0x0B});
+		elf.AddMeta(name, "A test app", "Tests", "1.0");
+		return elf.Build();
+	}
+
+	// An app from before .hollyhock_meta, with a section per field
+	std::vector<uint8_t> MakeOldApp(const char *name) {
+		ElfBuilder elf;
+		elf.SetEntry(Apps::APP_LOAD_ADDRESS);
+		elf.AddSegment(PT_LOAD, Apps::APP_LOAD_ADDRESS, {0x00, 0x09, 0x00, 0x0B});
+		elf.AddSection(".hollyhock_name", std::vector<uint8_t>(name, name + strlen(name) + 1));
+		return elf.Build();
+	}
+
+	// An app with a version 1 .hollyhock_meta header, which ended before
+	// the checksum. No released app has one, so it's not read.
+	std::vector<uint8_t> MakeVersion1App(const char *name) {
+		struct HollyhockMetaHeader header = {};
+		header.magic = HOLLYHOCK_META_MAGIC;
+		header.version = 1;
+		header.minSDKVersion = HOLLYHOCK_SDK_VERSION;
+
+		const uint32_t size = offsetof(struct HollyhockMetaHeader, crc32);
+		std::vector<uint8_t> meta(reinterpret_cast<uint8_t *>(&header), reinterpret_cast<uint8_t *>(&header) + size);
+		for (int i = 0; i < HollyhockMetaNumFields; ++i) {
+			header.fields[i].offset = meta.size();
+			header.fields[i].length = i == HollyhockMetaName ? strlen(name) : 0;
+			const char *field = i == HollyhockMetaName ? name : "";
+			meta.insert(meta.end(), field, field + strlen(field) + 1);
+		}
+		memcpy(meta.data(), &header, size);
+
+		ElfBuilder elf;
+		elf.SetEntry(Apps::APP_LOAD_ADDRESS);
+		elf.AddSegment(PT_LOAD, Apps::APP_LOAD_ADDRESS, {0x00, 0x09, 0x00, 0x0B});
+		elf.AddSection(".hollyhock_meta", meta);
+		return elf.Build();
+	}
+
+	void AddFiles() {
+		Stubs::Reset();
+		Stubs::AddFile("\\fls0\\a.hhk", MakeApp("Alpha"), 0x5A21, 0x6000);
+		Stubs::AddFile("\\fls0\\b.hhk", MakeApp("Beta"), 0x5A21, 0x6001);
+		Stubs::AddFile("\\fls0\\notes.txt", {'h', 'i'});
+		Stubs::AddFile("\\fls0\\broken.hhk", {0x7F, 'E', 'L', 'F', 1, 2, 3});
+		Stubs::AddDir("\\fls0\\games", 0x5A21, 0x6002);
+		Stubs::AddFile("\\fls0\\games\\c.hhk", MakeApp("Gamma"), 0x5A21, 0x6003);
+		Stubs::AddFile("\\fls0\\games\\old.HHK", MakeOldApp("Delta"), 0x5A21, 0x6004);
+		Stubs::AddDir("\\fls0\\games\\puzzles", 0x5A21, 0x6005);
+		Stubs::AddFile("\\fls0\\games\\puzzles\\d.hhk", MakeApp("Epsilon"), 0x5A21, 0x6006);
+		Stubs::AddDir("\\fls0\\.hidden");
+		Stubs::AddFile("\\fls0\\.hidden\\e.hhk", MakeApp("Hidden"));
+	}
+
+	const std::set<std::string> ALL_APPS = {
+		"\\fls0\\a.hhk|Alpha",
+		"\\fls0\\b.hhk|Beta",
+		"\\fls0\\games\\c.hhk|Gamma",
+		"\\fls0\\games\\old.HHK|Delta",
+		"\\fls0\\games\\puzzles\\d.hhk|Epsilon"
+	};
+
+	/**
+	 * Runs the launcher's search for apps.
+	 *
+	 * @param parsed Set to the number of apps whose files had to be parsed,
+	 * rather than being taken from the index.
+	 * @return The apps found, as "path|name".
+	 */
+	std::multiset<std::string> LoadApps(int *parsed = nullptr) {
+		Timing::Init(true);
+		Apps::LoadAppInfo();
+
+		if (parsed != nullptr) {
+			*parsed = Timing::GetTotal(Timing::PhaseParseMeta)->count;
+		}
+
+		std::multiset<std::string> apps;
+		for (int i = 0; i < Apps::g_numApps; ++i) {
+			apps.insert(std::string(Apps::g_apps[i].path) + "|" + Apps::g_apps[i].name);
+		}
+
+		return apps;
+	}
+
+	std::vector<uint8_t> ReadIndex() {
+		std::vector<uint8_t> index;
+		CHECK(Stubs::GetFile(INDEX_PATH, &index));
+		return index;
+	}
+
+	void TestScan() {
+		AddFiles();
+
+		int parsed;
+		std::multiset<std::string> apps = LoadApps(&parsed);
+		CHECK(apps == std::multiset<std::string>(ALL_APPS.begin(), ALL_APPS.end()));
+		CHECK_EQUAL(parsed, 5);
+
+		// Sorted by name
+		CHECK_EQUAL(Apps::g_numApps, 5);
+		for (int i = 1; i < Apps::g_numApps; ++i) {
+			CHECK(Apps::CompareNames(
+				Apps::g_apps[Apps::g_appOrder[i - 1]].name,
+				Apps::g_apps[Apps::g_appOrder[i]].name
+			) <= 0);
+		}
+
+		std::vector<uint8_t> index = ReadIndex();
+
+		// Nothing has changed, so everything comes from the index, which is
+		// left alone
+		apps = LoadApps(&parsed);
+		CHECK(apps == std::multiset<std::string>(ALL_APPS.begin(), ALL_APPS.end()));
+		CHECK_EQUAL(parsed, 0);
+		CHECK(ReadIndex() == index);
+	}
+
+	void TestMetaVersion() {
+		Stubs::Reset();
+		Stubs::AddFile("\\fls0\\v1.hhk", MakeVersion1App("Version 1"));
+		Stubs::AddFile("\\fls0\\v2.hhk", MakeApp("Version 2"));
+
+		// The version 1 app is still listed, just without its metadata
+		std::multiset<std::string> apps = LoadApps();
+		CHECK(apps == std::multiset<std::string>({"\\fls0\\v1.hhk|", "\\fls0\\v2.hhk|Version 2"}));
+	}
+
+	void TestChanges() {
+		AddFiles();
+		LoadApps();
+
+		// Overwriting a file doesn't change its directory's timestamp
+		Stubs::AddFile("\\fls0\\games\\c.hhk", MakeApp("Gamma 2"), 0x5A21, 0x6100);
+
+		int parsed;
+		std::multiset<std::string> apps = LoadApps(&parsed);
+		CHECK_EQUAL(parsed, 1);
+		CHECK(apps.count("\\fls0\\games\\c.hhk|Gamma 2") == 1);
+		CHECK(apps.count("\\fls0\\games\\c.hhk|Gamma") == 0);
+
+		// Only the new file is parsed
+		Stubs::AddFile("\\fls0\\games\\puzzles\\f.hhk", MakeApp("Zeta"), 0x5A21, 0x6101);
+		Stubs::TouchDir("\\fls0\\games\\puzzles", 0x5A21, 0x6101);
+		apps = LoadApps(&parsed);
+		CHECK_EQUAL(parsed, 1);
+		CHECK_EQUAL(apps.size(), 6u);
+		CHECK(apps.count("\\fls0\\games\\puzzles\\f.hhk|Zeta") == 1);
+
+		// Not every FAT driver updates a directory's timestamp when a file
+		// is added, so a new entry is noticed anyway
+		Stubs::AddFile("\\fls0\\games\\g.hhk", MakeApp("Eta"), 0x5A21, 0x6102);
+		apps = LoadApps(&parsed);
+		CHECK_EQUAL(parsed, 1);
+		CHECK_EQUAL(apps.size(), 7u);
+		CHECK(apps.count("\\fls0\\games\\g.hhk|Eta") == 1);
+
+		// As is one file being swapped for another, going by their sizes
+		Stubs::RemoveFile("\\fls0\\games\\g.hhk");
+		Stubs::AddFile("\\fls0\\games\\h.hhk", MakeApp("Theta (a longer name)"), 0x5A21, 0x6102);
+		apps = LoadApps(&parsed);
+		CHECK_EQUAL(parsed, 1);
+		CHECK_EQUAL(apps.size(), 7u);
+		CHECK(apps.count("\\fls0\\games\\g.hhk|Eta") == 0);
+		CHECK(apps.count("\\fls0\\games\\h.hhk|Theta (a longer name)") == 1);
+
+		Stubs::RemoveFile("\\fls0\\games\\h.hhk");
+		Stubs::RemoveFile("\\fls0\\b.hhk");
+		apps = LoadApps(&parsed);
+		CHECK_EQUAL(parsed, 0);
+		CHECK_EQUAL(apps.size(), 5u);
+		CHECK(apps.count("\\fls0\\b.hhk|Beta") == 0);
+
+		// The removal was saved
+		apps = LoadApps(&parsed);
+		CHECK_EQUAL(parsed, 0);
+		CHECK_EQUAL(apps.size(), 5u);
+	}
+
+	/**
+	 * Fills the root directory with @p count apps, and checks they're all
+	 * found, sorted, and then taken from the index. There used to be room for
+	 * only 64.
+	 */
+	void CheckAppCount(int count) {
+		Stubs::Reset();
+
+		std::multiset<std::string> expected;
+		for (int i = 0; i < count; ++i) {
+			// Names out of order, so they have to be sorted
+			std::string name = "App " + std::to_string((i * 37) % 1000);
+			std::string path = "\\fls0\\app" + std::to_string(i) + ".hhk";
+			Stubs::AddFile(path, MakeApp(name.c_str()));
+			expected.insert(path + "|" + name);
+		}
+
+		int parsed;
+		std::multiset<std::string> apps = LoadApps(&parsed);
+		CHECK(apps == expected);
+		CHECK_EQUAL(parsed, count);
+		for (int i = 1; i < Apps::g_numApps; ++i) {
+			CHECK(Apps::CompareNames(
+				Apps::g_apps[Apps::g_appOrder[i - 1]].name,
+				Apps::g_apps[Apps::g_appOrder[i]].name
+			) <= 0);
+		}
+
+		apps = LoadApps(&parsed);
+		CHECK(apps == expected);
+		CHECK_EQUAL(parsed, 0);
+	}
+
+	void TestAppCounts() {
+		CheckAppCount(0);
+		CheckAppCount(1);
+		CheckAppCount(64);
+		CheckAppCount(65);
+		CheckAppCount(500);
+	}
+
+	/**
+	 * A new index is written next to the old one, then renamed over it, so
+	 * being reset part way through saving never loses the index.
+	 */
+	void TestInterruptedSave() {
+		AddFiles();
+		LoadApps();
+		std::vector<uint8_t> good = ReadIndex();
+		std::vector<uint8_t> temp;
+		CHECK(!Stubs::GetFile(INDEX_TEMP_PATH, &temp));
+
+		// Reset while writing the new index - the old one is still used
+		Stubs::AddFile(INDEX_TEMP_PATH, std::vector<uint8_t>(good.begin(), good.begin() + 10));
+		int parsed;
+		std::multiset<std::string> apps = LoadApps(&parsed);
+		CHECK(apps == std::multiset<std::string>(ALL_APPS.begin(), ALL_APPS.end()));
+		CHECK_EQUAL(parsed, 0);
+
+		// Reset after removing the old index, but before renaming the new one
+		Stubs::RemoveFile(INDEX_PATH);
+		Stubs::AddFile(INDEX_TEMP_PATH, good);
+		apps = LoadApps(&parsed);
+		CHECK(apps == std::multiset<std::string>(ALL_APPS.begin(), ALL_APPS.end()));
+		CHECK_EQUAL(parsed, 0);
+		CHECK(ReadIndex() == good);
+		CHECK(!Stubs::GetFile(INDEX_TEMP_PATH, &temp));
+
+		// Saving again doesn't leave the new index behind
+		Stubs::AddFile(INDEX_TEMP_PATH, {1, 2, 3});
+		Stubs::RemoveFile("\\fls0\\b.hhk");
+		apps = LoadApps(&parsed);
+		CHECK_EQUAL(apps.size(), 4u);
+		CHECK(ReadIndex() != good);
+		CHECK(!Stubs::GetFile(INDEX_TEMP_PATH, &temp));
+	}
+
+	/**
+	 * Nests directories up to the longest path the launcher can hold (199
+	 * characters, plus the terminator). Anything which would go past that is
+	 * skipped, without writing past the end of the path.
+	 */
+	void TestLongPaths() {
+		Stubs::Reset();
+
+		std::string dir = std::string("\\fls0\\") + std::string(90, 'a');
+		Stubs::AddDir(dir);
+		dir += "\\" + std::string(60, 'b');
+		Stubs::AddDir(dir);
+		CHECK_EQUAL(dir.size(), 157u);
+
+		// Exactly as long as a path can be
+		std::string longest = dir + "\\" + std::string(37, 'c') + ".hhk";
+		CHECK_EQUAL(longest.size(), 199u);
+		Stubs::AddFile(longest, MakeApp("Longest"));
+		Stubs::AddFile(dir + "\\" + std::string(38, 'c') + ".hhk", MakeApp("Too long"));
+
+		// Directories whose own paths fit, but with no room for anything in
+		// them
+		std::string full = dir + "\\" + std::string(41, 'd');
+		CHECK_EQUAL(full.size(), 199u);
+		Stubs::AddDir(full);
+		Stubs::AddFile(full + "\\e.hhk", MakeApp("In a full directory"));
+		Stubs::AddDir(full + "\\f");
+		Stubs::AddFile(full + "\\f\\g.hhk", MakeApp("Below a full directory"));
+
+		std::string nearlyFull = dir + "\\" + std::string(40, 'h');
+		Stubs::AddDir(nearlyFull);
+		Stubs::AddFile(nearlyFull + "\\i", MakeApp("Not an app"));
+
+		std::multiset<std::string> apps = LoadApps();
+		CHECK(apps == std::multiset<std::string>({longest + "|Longest"}));
+
+		// The same again from the index
+		int parsed;
+		apps = LoadApps(&parsed);
+		CHECK(apps == std::multiset<std::string>({longest + "|Longest"}));
+		CHECK_EQUAL(parsed, 0);
+	}
+
+	/**
+	 * A synthetic tree with thousands of entries, spread over nested
+	 * directories - most of them not apps.
+	 */
+	void TestLargeTree() {
+		Stubs::Reset();
+
+		std::multiset<std::string> expected;
+		std::vector<std::string> dirs = {"\\fls0"};
+		for (int i = 0; i < 60; ++i) {
+			// Each directory goes in one of the ones before it
+			std::string dir = dirs[(i * 7) % dirs.size()] + "\\dir" + std::to_string(i);
+			if (std::count(dir.begin(), dir.end(), '\\') > 8) {
+				dir = "\\fls0\\dir" + std::to_string(i);
+			}
+			Stubs::AddDir(dir, 0x5A21, 0x6000 + i);
+			dirs.push_back(dir);
+
+			for (int j = 0; j < 60; ++j) {
+				std::string path = dir + "\\file" + std::to_string(j);
+				if (j % 3 == 0) {
+					std::string name = "App " + std::to_string(i) + "." + std::to_string(j);
+					Stubs::AddFile(path + ".hhk", MakeApp(name.c_str()));
+					expected.insert(path + ".hhk|" + name);
+				} else {
+					Stubs::AddFile(path + ".g3a", {1, 2, 3});
+				}
+			}
+		}
+		CHECK_EQUAL(expected.size(), 1200u);
+
+		int parsed;
+		std::multiset<std::string> apps = LoadApps(&parsed);
+		CHECK(apps == expected);
+		CHECK_EQUAL(parsed, 1200);
+
+		// Every directory is listed once more, just to count its entries
+		Stubs::ResetCounts();
+		apps = LoadApps(&parsed);
+		CHECK(apps == expected);
+		CHECK_EQUAL(parsed, 0);
+		CHECK(Stubs::GetCounts().finds <= 61 * 62);
+		CHECK_EQUAL(Stubs::GetCounts().opens, 1);
+
+		// A new app deep in the tree, without its directory's timestamp
+		// changing
+		std::string path = dirs.back() + "\\new.hhk";
+		Stubs::AddFile(path, MakeApp("New"));
+		expected.insert(path + "|New");
+		apps = LoadApps(&parsed);
+		CHECK(apps == expected);
+		CHECK_EQUAL(parsed, 1);
+	}
+
+	/**
+	 * Loads the apps with a corrupt index. The index must be ignored - every
+	 * app is parsed again, and a good index written in its place.
+	 */
+	void CheckRejected(const std::vector<uint8_t> &goodIndex, const std::vector<uint8_t> &badIndex, const char *what) {
+		Stubs::AddFile(INDEX_PATH, badIndex);
+
+		int parsed;
+		std::multiset<std::string> apps = LoadApps(&parsed);
+		if (apps != std::multiset<std::string>(ALL_APPS.begin(), ALL_APPS.end()) || parsed != 5) {
+			fprintf(stderr, "index with %s: found %zu apps, parsed %d\n", what, apps.size(), parsed);
+			++g_testFailures;
+		}
+
+		CHECK(ReadIndex() == goodIndex);
+	}
+
+	template <typename T>
+	T *At(std::vector<uint8_t> *index, uint32_t offset) {
+		return reinterpret_cast<T *>(index->data() + offset);
+	}
+
+	void TestCorruptIndex() {
+		AddFiles();
+		LoadApps();
+		std::vector<uint8_t> good = ReadIndex();
+
+		for (uint32_t length = 0; length < good.size(); ++length) {
+			CheckRejected(good, std::vector<uint8_t>(good.begin(), good.begin() + length), "truncation");
+		}
+
+		std::vector<uint8_t> bad = good;
+		At<struct IndexHeader>(&bad, 0)->magic ^= 1;
+		CheckRejected(good, bad, "bad magic");
+
+		bad = good;
+		At<struct IndexHeader>(&bad, 0)->version = 4;
+		CheckRejected(good, bad, "old version");
+
+		bad = good;
+		At<struct IndexHeader>(&bad, 0)->numApps = 0xFFFFFFFF;
+		CheckRejected(good, bad, "too many apps");
+
+		bad = good;
+		At<struct IndexHeader>(&bad, 0)->numDirs = 0x7FFFFFFF;
+		CheckRejected(good, bad, "too many directories");
+
+		// Find where every record starts
+		const struct IndexHeader *header = At<struct IndexHeader>(&good, 0);
+		std::vector<uint32_t> records;
+		uint32_t offset = sizeof(struct IndexHeader);
+		for (uint32_t i = 0; i < header->numApps; ++i) {
+			records.push_back(offset);
+
+			const struct IndexRecord *record = At<struct IndexRecord>(&good, offset);
+			uint32_t size = sizeof(struct IndexRecord);
+			for (int j = 0; j < 5; ++j) {
+				size += record->lengths[j] + 1;
+			}
+			offset += (size + 3) & ~3;
+		}
+
+		std::vector<uint32_t> dirRecords;
+		for (uint32_t i = 0; i < header->numDirs; ++i) {
+			dirRecords.push_back(offset);
+
+			const struct IndexDirRecord *record = At<struct IndexDirRecord>(&good, offset);
+			offset += (sizeof(struct IndexDirRecord) + record->pathLength + 1 + 3) & ~3;
+		}
+		CHECK_EQUAL(offset, good.size());
+		CHECK_EQUAL(dirRecords.size(), 3u);
+
+		for (uint32_t record : records) {
+			uint32_t terminator = record + sizeof(struct IndexRecord);
+			for (int j = 0; j < 5; ++j) {
+				terminator += At<struct IndexRecord>(&good, record)->lengths[j];
+
+				bad = good;
+				At<struct IndexRecord>(&bad, record)->lengths[j] = 0xFFFF;
+				CheckRejected(good, bad, "a string past the end");
+
+				bad = good;
+				bad[terminator] = 'x';
+				CheckRejected(good, bad, "a string without a terminator");
+
+				++terminator;
+			}
+		}
+
+		for (uint32_t i = 0; i < dirRecords.size(); ++i) {
+			uint32_t record = dirRecords[i];
+
+			bad = good;
+			At<struct IndexDirRecord>(&bad, record)->parent = -2;
+			CheckRejected(good, bad, "a parent below -1");
+
+			bad = good;
+			At<struct IndexDirRecord>(&bad, record)->parent = 0x80000000;
+			CheckRejected(good, bad, "a very negative parent");
+
+			bad = good;
+			At<struct IndexDirRecord>(&bad, record)->parent = i;
+			CheckRejected(good, bad, "a directory which is its own parent");
+
+			bad = good;
+			At<struct IndexDirRecord>(&bad, record)->firstApp = header->numApps + 1;
+			CheckRejected(good, bad, "apps out of range");
+
+			bad = good;
+			At<struct IndexDirRecord>(&bad, record)->numApps = 0xFFFFFFFF;
+			CheckRejected(good, bad, "too many apps in a directory");
+
+			bad = good;
+			At<struct IndexDirRecord>(&bad, record)->pathLength = 0xFFFF;
+			CheckRejected(good, bad, "a directory path past the end");
+		}
+	}
+
+	/**
+	 * Flips random bytes of a good index. A flip which still leaves a
+	 * consistent index may change what's listed, but nothing may be read out
+	 * of bounds (which the address sanitizer catches), and every app found
+	 * must be a real one.
+	 */
+	void TestRandomCorruption() {
+		AddFiles();
+		LoadApps();
+		std::vector<uint8_t> good = ReadIndex();
+
+		std::set<std::string> paths;
+		for (const std::string &app : ALL_APPS) {
+			paths.insert(app.substr(0, app.find('|')));
+		}
+
+		uint32_t seed = 1;
+		for (int i = 0; i < 2000; ++i) {
+			std::vector<uint8_t> bad = good;
+			for (int j = 0; j < 1 + i % 4; ++j) {
+				seed = seed * 1103515245 + 12345;
+				bad[(seed >> 8) % bad.size()] ^= 1 << (seed >> 28 & 7);
+			}
+
+			Stubs::AddFile(INDEX_PATH, bad);
+			LoadApps();
+
+			for (int j = 0; j < Apps::g_numApps; ++j) {
+				CHECK(paths.count(Apps::g_apps[j].path) == 1);
+			}
+		}
+	}
+}
+
+int main() {
+	TestScan();
+	TestMetaVersion();
+	TestChanges();
+	TestAppCounts();
+	TestInterruptedSave();
+	TestLongPaths();
+	TestLargeTree();
+	TestCorruptIndex();
+	TestRandomCorruption();
+	return TestResult("index_test");
+}
@@ -0,0 +1,185 @@
+#include <math.h>
+#include <stdlib.h>
+#include <sdk/gfx/line.hpp>
+#include "canvas.hpp"
+#include "test.hpp"
+
+namespace {
+	const int WIDTH = 60;
+	const int HEIGHT = 50;
+	const struct GFX_Rect CLIP = {10, 5, 40, 35};
+
+	// The largest coordinate lines may have
+	const int LIMIT = 16383;
+
+	uint32_t g_seed = 1;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	/**
+	 * Picks a coordinate around @p center, out to a range which is one of
+	 * just off the surface, well off it, or as far as lines can go.
+	 */
+	int RandomCoordinate(int center, int i) {
+		int range = i % 3 == 0 ? LIMIT : (i % 3 == 1 ? 400 : 40);
+		int coordinate = center + Random(2 * range + 1) - range;
+		return coordinate < -LIMIT ? -LIMIT : (coordinate > LIMIT ? LIMIT : coordinate);
+	}
+
+	/**
+	 * Checks whether a Bresenham line from @p x0, @p y0 to @p x1, @p y1
+	 * covers @p x, @p y. The pixel on the minor axis at each step is the one
+	 * nearest the true line, rounding halves up - each step is worked out
+	 * directly, rather than incrementally as GFX_DrawLine does.
+	 */
+	bool OnLine(int x0, int y0, int x1, int y1, int x, int y) {
+		int lengthX = abs(x1 - x0);
+		int lengthY = abs(y1 - y0);
+		int stepX = x1 < x0 ? -1 : 1;
+		int stepY = y1 < y0 ? -1 : 1;
+
+		bool xMajor = lengthX >= lengthY;
+		int major = xMajor ? lengthX : lengthY;
+		int minor = xMajor ? lengthY : lengthX;
+
+		int k = xMajor ? (x - x0) * stepX : (y - y0) * stepY;
+		if (k < 0 || k > major) {
+			return false;
+		}
+
+		long long m = major == 0 ? 0 : (2LL * k * minor + major) / (2LL * major);
+		return xMajor ? y == y0 + stepY * m : x == x0 + stepX * m;
+	}
+
+	void ExpectLine(Canvas *canvas, int x0, int y0, int x1, int y1, uint16_t color) {
+		for (int y = 0; y < HEIGHT; ++y) {
+			for (int x = 0; x < WIDTH; ++x) {
+				if (OnLine(x0, y0, x1, y1, x, y)) {
+					canvas->Set(x, y, color);
+				}
+			}
+		}
+	}
+
+	void TestLines() {
+		for (int i = 0; i < 20000; ++i) {
+			int x0 = RandomCoordinate(WIDTH / 2, i);
+			int y0 = RandomCoordinate(HEIGHT / 2, i);
+			int x1 = RandomCoordinate(WIDTH / 2, i);
+			int y1 = RandomCoordinate(HEIGHT / 2, i);
+
+			// Plenty of horizontal, vertical and diagonal lines too
+			if (i % 7 == 0) {
+				y1 = y0;
+			} else if (i % 11 == 0) {
+				x1 = x0;
+			} else if (i % 13 == 0) {
+				int length = Random(100) - 50;
+				x1 = x0 + length;
+				y1 = y0 + (Random(2) == 0 ? length : -length);
+			}
+
+			Canvas canvas(WIDTH, HEIGHT, WIDTH + Random(3), Random(2));
+			GFX_SetClip(&canvas.surface, &CLIP);
+
+			GFX_DrawLine(&canvas.surface, x0, y0, x1, y1, 0x1234);
+			ExpectLine(&canvas, x0, y0, x1, y1, 0x1234);
+			CHECK(canvas.Matches());
+		}
+	}
+
+	void TestPolyline() {
+		const struct GFX_Point points[] = {{12, 6}, {70, 20}, {30, 60}, {-5, 30}, {12, 6}, {12, 6}, {40, 30}};
+		const int numPoints = sizeof(points) / sizeof(points[0]);
+
+		for (int count = 1; count <= numPoints; ++count) {
+			Canvas canvas(WIDTH, HEIGHT, WIDTH);
+			GFX_SetClip(&canvas.surface, &CLIP);
+			GFX_DrawPolyline(&canvas.surface, points, count, 0x1234);
+
+			// The same pixels as drawing each line separately
+			canvas.Set(points[0].x, points[0].y, 0x1234);
+			for (int i = 1; i < count; ++i) {
+				ExpectLine(&canvas, points[i - 1].x, points[i - 1].y, points[i].x, points[i].y, 0x1234);
+			}
+			CHECK(canvas.Matches());
+		}
+	}
+
+	/**
+	 * Anti-aliased lines can't be checked against a simple reference, as the
+	 * exact shades are up to the implementation. Instead: straight and
+	 * diagonal lines are solid, every pixel touched is near the true line,
+	 * and clipping only takes away what's outside the clip rectangle.
+	 */
+	void TestAntiAliased() {
+		for (int i = 0; i < 5000; ++i) {
+			int x0 = RandomCoordinate(WIDTH / 2, i);
+			int y0 = RandomCoordinate(HEIGHT / 2, i);
+			int x1 = RandomCoordinate(WIDTH / 2, i);
+			int y1 = RandomCoordinate(HEIGHT / 2, i);
+			if (i % 7 == 0) {
+				y1 = y0;
+			} else if (i % 13 == 0) {
+				int length = Random(100) - 50;
+				x1 = x0 + length;
+				y1 = y0 - length;
+			}
+
+			int offset = Random(2);
+			Canvas unclipped(WIDTH, HEIGHT, WIDTH, offset);
+			Canvas clipped(WIDTH, HEIGHT, WIDTH, offset);
+			GFX_SetClip(&clipped.surface, &CLIP);
+
+			GFX_DrawLineAA(&unclipped.surface, x0, y0, x1, y1, 0xFFFF);
+			GFX_DrawLineAA(&clipped.surface, x0, y0, x1, y1, 0xFFFF);
+
+			int lengthX = abs(x1 - x0);
+			int lengthY = abs(y1 - y0);
+			bool solid = lengthX == 0 || lengthY == 0 || lengthX == lengthY;
+			double length = hypot(lengthX, lengthY);
+
+			for (int y = 0; y < HEIGHT; ++y) {
+				for (int x = 0; x < WIDTH; ++x) {
+					uint16_t pixel = unclipped.Get(x, y);
+					if (pixel == unclipped.Expected(x, y)) {
+						continue;
+					}
+
+					clipped.Set(x, y, pixel);
+					if (solid) {
+						CHECK(OnLine(x0, y0, x1, y1, x, y) && pixel == 0xFFFF);
+					} else {
+						// Distance from the line, which only goes as far as
+						// between the two pixels either side of it
+						double distance = fabs(
+							static_cast<double>(x1 - x0) * (y0 - y) - static_cast<double>(x0 - x) * (y1 - y0)
+						) / length;
+						CHECK(distance < 1.5);
+					}
+				}
+			}
+
+			if (solid) {
+				ExpectLine(&unclipped, x0, y0, x1, y1, 0xFFFF);
+				CHECK(unclipped.Matches());
+			}
+
+			if (x0 >= 0 && y0 >= 0 && x0 < WIDTH && y0 < HEIGHT) {
+				CHECK_EQUAL(unclipped.Get(x0, y0), 0xFFFF);
+			}
+
+			CHECK(clipped.Matches());
+		}
+	}
+}
+
+int main() {
+	TestLines();
+	TestPolyline();
+	TestAntiAliased();
+	return TestResult("line_test");
+}
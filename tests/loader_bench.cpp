@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <vector>
+#include "apps.hpp"
+#include "bench.hpp"
+#include "elf_builder.hpp"
+#include "lz4_compress.hpp"
+#include "os_stubs.hpp"
+#include "timing.hpp"
+
+namespace {
+	const char APP_PATH[] = "\\fls0\\app.hhk";
+
+	const uint32_t MEMORY_START = 0x8CFEF000;
+	const uint32_t MEMORY_END = 0x8D000000;
+
+	// Mirrors the flag in launcher/apps.cpp, set by tools/hhk_compress.py
+	const uint32_t PF_HHK_LZ4 = 0x00100000;
+
+	uint32_t g_seed = 3;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	/**
+	 * Picks a register, mostly from the low ones, as compiled code does.
+	 */
+	int RandomRegister() {
+		return Random(3) == 0 ? Random(16) : Random(8);
+	}
+
+	/**
+	 * Makes a stand-in for an app's code: a mix of common SH4 instructions,
+	 * with a literal pool of addresses after every few dozen of them. The
+	 * demos can't be built without the SH4 toolchain, and real apps are
+	 * big-endian, which the host-built launcher can't read - so this is what
+	 * gets compressed instead.
+	 */
+	std::vector<uint8_t> MakeCode(uint32_t size) {
+		std::vector<uint8_t> code;
+		auto add16 = [&code](uint16_t word) {
+			code.push_back(word >> 8);
+			code.push_back(word);
+		};
+
+		while (code.size() < size) {
+			int count = 16 + Random(48);
+			for (int i = 0; i < count; ++i) {
+				int n = RandomRegister();
+				int m = RandomRegister();
+				switch (Random(10)) {
+				case 0:
+					// mov.l @(disp,PC),Rn
+					add16(0xD000 | n << 8 | Random(16));
+					break;
+				case 1:
+					// mov Rm,Rn
+					add16(0x6003 | n << 8 | m << 4);
+					break;
+				case 2:
+					// add #imm,Rn
+					add16(0x7000 | n << 8 | ((Random(2) == 0 ? Random(16) : 0xFC + Random(4)) & 0xFF));
+					break;
+				case 3:
+					// mov.l @(disp,Rm),Rn
+					add16(0x5000 | n << 8 | m << 4 | Random(8));
+					break;
+				case 4:
+					// mov.l Rm,@(disp,Rn)
+					add16(0x1000 | n << 8 | m << 4 | Random(8));
+					break;
+				case 5:
+					// jsr @Rn, then a nop in the delay slot
+					add16(0x400B | n << 8);
+					add16(0x0009);
+					break;
+				case 6:
+					// bt/bf
+					add16((Random(2) == 0 ? 0x8900 : 0x8B00) | Random(32));
+					break;
+				case 7:
+					// cmp/eq Rm,Rn
+					add16(0x3000 | n << 8 | m << 4);
+					break;
+				case 8:
+					// The start and end of a function
+					add16(0x4F22);
+					add16(0x2FE6);
+					break;
+				default:
+					add16(0x6EF6);
+					add16(0x4F26);
+					add16(0x000B);
+					add16(0x0009);
+					break;
+				}
+			}
+
+			// The literal pool: addresses in the app, and of OS functions
+			for (int i = Random(6); i >= 0; --i) {
+				uint32_t address = Random(2) == 0 ? 0x8CFF0000 + Random(size) : 0x80000000 + Random(0x400000);
+				add16(address >> 16);
+				add16(address);
+			}
+		}
+
+		code.resize(size);
+		return code;
+	}
+
+	/**
+	 * Makes stand-in data: mostly zeros and small numbers, with some text.
+	 */
+	std::vector<uint8_t> MakeData(uint32_t size) {
+		const char TEXT[] = "Score: Game over! Press EXE to play again";
+
+		std::vector<uint8_t> data;
+		while (data.size() < size) {
+			int kind = Random(4);
+			if (kind == 0) {
+				data.insert(data.end(), TEXT, TEXT + Random(sizeof(TEXT)));
+			} else if (kind == 1) {
+				data.insert(data.end(), 4 * (1 + Random(8)), 0);
+			} else {
+				data.insert(data.end(), {0, 0, 0, static_cast<uint8_t>(Random(256))});
+			}
+		}
+
+		data.resize(size);
+		return data;
+	}
+
+	/**
+	 * Compresses a segment the way tools/hhk_compress.py does - its
+	 * uncompressed size, followed by an LZ4 block.
+	 */
+	std::vector<uint8_t> CompressSegment(const std::vector<uint8_t> &data) {
+		uint32_t size = data.size();
+		std::vector<uint8_t> segment(reinterpret_cast<uint8_t *>(&size), reinterpret_cast<uint8_t *>(&size + 1));
+
+		std::vector<uint8_t> block = CompressLZ4(data);
+		segment.insert(segment.end(), block.begin(), block.end());
+		return segment;
+	}
+
+	std::vector<uint8_t> MakeApp(const std::vector<uint8_t> &code, const std::vector<uint8_t> &data, bool compressed) {
+		uint32_t dataAddress = Apps::APP_LOAD_ADDRESS + ((code.size() + 3) & ~3);
+		uint32_t flags = compressed ? PF_HHK_LZ4 : 0;
+
+		ElfBuilder elf;
+		elf.SetEntry(Apps::APP_LOAD_ADDRESS);
+		elf.AddSegment(
+			PT_LOAD, Apps::APP_LOAD_ADDRESS, compressed ? CompressSegment(code) : code,
+			code.size(), PF_R | PF_X | flags
+		);
+		elf.AddSegment(
+			PT_LOAD, dataAddress, compressed ? CompressSegment(data) : data,
+			data.size() + 1024, PF_R | PF_W | flags
+		);
+		elf.AddMeta("Bench", "", "", "");
+		return elf.Build();
+	}
+
+	/**
+	 * Loads an app over and over.
+	 *
+	 * @param[out] segments The time spent loading the segments, out of each
+	 * load, from the launcher's timing probe.
+	 * @return The time each whole load took, in microseconds.
+	 */
+	double TimeLoad(const std::vector<uint8_t> &app, double *segments) {
+		Stubs::Reset();
+		Stubs::AddFile(APP_PATH, app);
+
+		Timing::Init(true);
+		double load = TimeCalls([]() {
+			g_benchSink += reinterpret_cast<uintptr_t>(Apps::LoadImage(APP_PATH, Apps::APP_LOAD_ADDRESS)) != 0;
+		});
+
+		const struct Timing::PhaseTotal *total = Timing::GetTotal(Timing::PhaseLoadSegments);
+		*segments = static_cast<double>(Timing::ToMicroseconds(total->ticks)) / total->count;
+		Timing::Shutdown();
+
+		return load;
+	}
+}
+
+/**
+ * Compares loading plain apps with loading LZ4-compressed ones, for a range
+ * of sizes, reporting how big each file is and how long it takes to load.
+ */
+int main() {
+	void *memory = mmap(
+		reinterpret_cast<void *>(MEMORY_START), MEMORY_END - MEMORY_START,
+		PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0
+	);
+	if (memory != reinterpret_cast<void *>(MEMORY_START)) {
+		perror("loader_bench: can't map the app's memory");
+		return 1;
+	}
+
+	const uint32_t CODE_SIZES[] = {4 * 1024, 16 * 1024, 48 * 1024};
+
+	printf("%-10s %-6s %10s %12s %12s\n", "app", "format", "file bytes", "load us", "segments us");
+	for (uint32_t codeSize : CODE_SIZES) {
+		std::vector<uint8_t> code = MakeCode(codeSize);
+		std::vector<uint8_t> data = MakeData(codeSize / 8);
+
+		char name[16];
+		snprintf(name, sizeof(name), "%uK", codeSize / 1024);
+
+		for (bool compressed : {false, true}) {
+			std::vector<uint8_t> app = MakeApp(code, data, compressed);
+			double segments;
+			double load = TimeLoad(app, &segments);
+			printf(
+				"%-10s %-6s %10zu %12.1f %12.1f\n",
+				name, compressed ? "lz4" : "plain", app.size(), load, segments
+			);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,702 @@
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <zlib.h>
+#include <algorithm>
+#include <vector>
+#include "apps.hpp"
+#include "elf_builder.hpp"
+#include "lz4_compress.hpp"
+#include "os_stubs.hpp"
+#include "test.hpp"
+#include "timing.hpp"
+
+namespace {
+	const char APP_PATH[] = "\\fls0\\app.hhk";
+	const char VERIFIED_PATH[] = "\\fls0\\.hhkverified";
+	const char VERIFIED_TEMP_PATH[] = "\\fls0\\.hhkverified.new";
+
+	// Apps are loaded to where they'd be on the calculator, along with the
+	// launcher's record of the last app loaded, just below
+	const uint32_t MEMORY_START = 0x8CFEF000;
+	const uint32_t MEMORY_END = 0x8D000000;
+
+	const uint32_t TEXT_ADDRESS = Apps::APP_LOAD_ADDRESS;
+	const uint32_t DATA_ADDRESS = Apps::APP_LOAD_ADDRESS + 0x1000;
+	const uint32_t OVERLAY_ADDRESS = Apps::APP_LOAD_ADDRESS + 0x2000;
+	const uint8_t UNTOUCHED = 0xAA;
+
+	// Mirrors the flag in launcher/apps.cpp, set by tools/hhk_compress.py
+	const uint32_t PF_HHK_LZ4 = 0x00100000;
+
+	// Mirrors the limit in launcher/apps.cpp, counting the terminator
+	const size_t MAX_PATH_LENGTH = 200;
+
+	uint8_t *At(uint32_t address) {
+		return reinterpret_cast<uint8_t *>(address);
+	}
+
+	std::vector<uint8_t> Pattern(uint32_t size, uint8_t seed) {
+		std::vector<uint8_t> data(size);
+		for (uint32_t i = 0; i < size; ++i) {
+			data[i] = seed + i * 7;
+		}
+
+		return data;
+	}
+
+	/**
+	 * Loads the app at @ref APP_PATH, with the app area filled with
+	 * @ref UNTOUCHED first.
+	 */
+	uint32_t Load() {
+		memset(At(Apps::APP_LOAD_ADDRESS), UNTOUCHED, MEMORY_END - Apps::APP_LOAD_ADDRESS);
+		return reinterpret_cast<uintptr_t>(Apps::LoadImage(APP_PATH, Apps::APP_LOAD_ADDRESS));
+	}
+
+	bool Untouched(uint32_t address, uint32_t size) {
+		for (uint32_t i = 0; i < size; ++i) {
+			if (At(address)[i] != UNTOUCHED) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool IsZero(uint32_t address, uint32_t size) {
+		for (uint32_t i = 0; i < size; ++i) {
+			if (At(address)[i] != 0) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	ElfBuilder MakeApp() {
+		ElfBuilder elf;
+		elf.SetEntry(TEXT_ADDRESS + 0x10);
+		elf.AddSegment(PT_LOAD, TEXT_ADDRESS, Pattern(100, 1), 0, PF_R | PF_X);
+		// .data followed by .bss
+		elf.AddSegment(PT_LOAD, DATA_ADDRESS, Pattern(24, 2), 256, PF_R | PF_W);
+		elf.AddMeta("Loader", "", "", "");
+		return elf;
+	}
+
+	void CheckLoaded(uint32_t entry) {
+		CHECK_EQUAL(entry, TEXT_ADDRESS + 0x10);
+		CHECK(memcmp(At(TEXT_ADDRESS), Pattern(100, 1).data(), 100) == 0);
+		CHECK(Untouched(TEXT_ADDRESS + 100, 16));
+		CHECK(memcmp(At(DATA_ADDRESS), Pattern(24, 2).data(), 24) == 0);
+		CHECK(IsZero(DATA_ADDRESS + 24, 256 - 24));
+		CHECK(Untouched(DATA_ADDRESS + 256, 16));
+	}
+
+	void TestSegments() {
+		Stubs::AddFile(APP_PATH, MakeApp().Build());
+		CheckLoaded(Load());
+	}
+
+	void TestStripped() {
+		ElfBuilder elf = MakeApp();
+		elf.Strip();
+		Stubs::AddFile(APP_PATH, elf.Build());
+		CheckLoaded(Load());
+	}
+
+	void TestOverlay() {
+		ElfBuilder elf = MakeApp();
+		// Linked to run at OVERLAY_ADDRESS, but loaded by the app itself
+		elf.AddSegment(PT_LOAD, OVERLAY_ADDRESS, Pattern(32, 3), 0, PF_R | PF_X, 0x8E000000);
+		Stubs::AddFile(APP_PATH, elf.Build());
+
+		CheckLoaded(Load());
+		CHECK(Untouched(OVERLAY_ADDRESS, 32));
+	}
+
+	// Without program headers, the sections are loaded one by one
+	void TestSections() {
+		ElfBuilder elf;
+		elf.SetEntry(TEXT_ADDRESS + 0x10);
+		elf.AddSection(".text", Pattern(100, 1), SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR, TEXT_ADDRESS);
+		elf.AddSection(".data", Pattern(24, 2), SHT_PROGBITS, SHF_ALLOC | SHF_WRITE, DATA_ADDRESS);
+		elf.AddSection(".bss", std::vector<uint8_t>(256 - 24), SHT_NOBITS, SHF_ALLOC | SHF_WRITE, DATA_ADDRESS + 24);
+		elf.AddSection(".comment", Pattern(16, 4));
+		Stubs::AddFile(APP_PATH, elf.Build());
+
+		CheckLoaded(Load());
+	}
+
+	/**
+	 * Compresses a segment the way tools/hhk_compress.py does - its
+	 * uncompressed size, followed by an LZ4 block.
+	 */
+	std::vector<uint8_t> CompressSegment(const std::vector<uint8_t> &data) {
+		uint32_t size = data.size();
+		std::vector<uint8_t> segment(reinterpret_cast<uint8_t *>(&size), reinterpret_cast<uint8_t *>(&size + 1));
+
+		std::vector<uint8_t> block = CompressLZ4(data);
+		segment.insert(segment.end(), block.begin(), block.end());
+		return segment;
+	}
+
+	ElfBuilder MakeCompressedApp(const std::vector<uint8_t> &text, const std::vector<uint8_t> &data) {
+		ElfBuilder elf;
+		elf.SetEntry(TEXT_ADDRESS + 0x10);
+		elf.AddSegment(PT_LOAD, TEXT_ADDRESS, text, 100, PF_R | PF_X | PF_HHK_LZ4);
+		elf.AddSegment(PT_LOAD, DATA_ADDRESS, data, 256, PF_R | PF_W | PF_HHK_LZ4);
+		return elf;
+	}
+
+	void TestCompressed() {
+		std::vector<uint8_t> text = CompressSegment(Pattern(100, 1));
+		std::vector<uint8_t> data = CompressSegment(Pattern(24, 2));
+
+		Stubs::AddFile(APP_PATH, MakeCompressedApp(text, data).Build());
+		CheckLoaded(Load());
+
+		// A segment which doesn't decompress to its full size is rejected
+		std::vector<uint8_t> truncated(text.begin(), text.end() - 1);
+		Stubs::AddFile(APP_PATH, MakeCompressedApp(truncated, data).Build());
+		CHECK_EQUAL(Load(), 0);
+
+		// As is one which would decompress past the end of the segment
+		std::vector<uint8_t> tooBig = CompressSegment(Pattern(300, 2));
+		Stubs::AddFile(APP_PATH, MakeCompressedApp(text, tooBig).Build());
+		CHECK_EQUAL(Load(), 0);
+		CHECK(Untouched(DATA_ADDRESS + 256, 16));
+
+		std::vector<uint8_t> noSize(data.begin(), data.begin() + 3);
+		Stubs::AddFile(APP_PATH, MakeCompressedApp(text, noSize).Build());
+		CHECK_EQUAL(Load(), 0);
+	}
+
+	ElfBuilder MakeChecksummedApp(const std::vector<uint8_t> &text, uint32_t crc) {
+		ElfBuilder elf;
+		elf.SetEntry(TEXT_ADDRESS + 0x10);
+		elf.AddSegment(PT_LOAD, TEXT_ADDRESS, text, 0, PF_R | PF_X);
+		elf.AddSegment(PT_LOAD, DATA_ADDRESS, Pattern(24, 2), 256, PF_R | PF_W);
+		elf.AddMeta("Checked", "", "", "", HOLLYHOCK_META_FLAG_CRC32, crc);
+		return elf;
+	}
+
+	void TestChecksum() {
+		// The CRC of each segment's file contents, in order
+		std::vector<uint8_t> text = Pattern(100, 1);
+		uint32_t crc = crc32(0, text.data(), text.size());
+		crc = crc32(crc, Pattern(24, 2).data(), 24);
+
+		Stubs::RemoveFile(VERIFIED_PATH);
+		Stubs::AddFile(APP_PATH, MakeChecksummedApp(text, crc).Build(), 0x5A21, 0x6000);
+		CheckLoaded(Load());
+
+		// Passing is remembered
+		std::vector<uint8_t> verified;
+		CHECK(Stubs::GetFile(VERIFIED_PATH, &verified));
+		CheckLoaded(Load());
+
+		std::vector<uint8_t> verifiedAgain;
+		CHECK(Stubs::GetFile(VERIFIED_PATH, &verifiedAgain));
+		CHECK(verified == verifiedAgain);
+
+		// The list is written next to the old one, then renamed over it. If
+		// that was cut short, the new list is still used - which shows as an
+		// app with the same timestamp not being checked again.
+		std::vector<uint8_t> temp;
+		CHECK(!Stubs::GetFile(VERIFIED_TEMP_PATH, &temp));
+		Stubs::RemoveFile(VERIFIED_PATH);
+		Stubs::AddFile(VERIFIED_TEMP_PATH, verified);
+
+		std::vector<uint8_t> unchecked = text;
+		unchecked[50] ^= 1;
+		Stubs::AddFile(APP_PATH, MakeChecksummedApp(unchecked, crc).Build(), 0x5A21, 0x6000);
+		CHECK(Load() != 0);
+		CHECK(Stubs::GetFile(VERIFIED_PATH, &verifiedAgain));
+		CHECK(verified == verifiedAgain);
+		CHECK(!Stubs::GetFile(VERIFIED_TEMP_PATH, &temp));
+
+		// A corrupt copy of the app has a new timestamp, so is checked again
+		text[50] ^= 1;
+		Stubs::AddFile(APP_PATH, MakeChecksummedApp(text, crc).Build(), 0x5A21, 0x6001);
+		CHECK_EQUAL(Load(), 0);
+		CHECK(Untouched(TEXT_ADDRESS, 100));
+	}
+
+	// Where each part of the position-independent app below is, relative to
+	// the address it's linked at (0)
+	const uint32_t PIE_DATA = 0x100;
+	const uint32_t PIE_DYNAMIC = 0x140;
+	const uint32_t PIE_RELOCATIONS = 0x180;
+	const uint32_t PIE_SYMBOLS = 0x200;
+	const uint32_t PIE_SIZE = 0x240;
+	const uint32_t PIE_MEM_SIZE = 0x300;
+	const uint32_t PIE_OS_FUNCTION = 0xA0001234;
+
+	template <typename T>
+	void Put(std::vector<uint8_t> *data, uint32_t offset, const T &value) {
+		memcpy(data->data() + offset, &value, sizeof(value));
+	}
+
+	struct PIE {
+		std::vector<uint8_t> data = std::vector<uint8_t>(PIE_SIZE);
+		std::vector<Elf32_Rela> relocations;
+		std::vector<Elf32_Dyn> dynamic;
+		uint32_t dynamicAddress = PIE_DYNAMIC;
+		uint32_t dynamicSize = 0;
+
+		/**
+		 * An app with one of each kind of relocation the launcher supports.
+		 */
+		PIE() {
+			std::vector<uint8_t> text = Pattern(PIE_DATA, 5);
+			std::copy(text.begin(), text.end(), data.begin());
+
+			// The null symbol, a symbol in the app, an absolute symbol, and
+			// an undefined weak symbol
+			Elf32_Sym symbols[4] = {};
+			symbols[1].st_value = 0x30;
+			symbols[1].st_shndx = 1;
+			symbols[2].st_value = PIE_OS_FUNCTION;
+			symbols[2].st_shndx = SHN_ABS;
+			symbols[3].st_info = ELF32_ST_INFO(STB_WEAK, STT_FUNC);
+			symbols[3].st_shndx = SHN_UNDEF;
+			for (int i = 0; i < 4; ++i) {
+				Put(&data, PIE_SYMBOLS + i * sizeof(Elf32_Sym), symbols[i]);
+			}
+
+			AddRelocation(PIE_DATA, R_SH_RELATIVE, 0, 0x20);
+			AddRelocation(PIE_DATA + 4, R_SH_DIR32, 1, 4);
+			AddRelocation(PIE_DATA + 8, R_SH_GLOB_DAT, 2, 0);
+			AddRelocation(PIE_DATA + 12, R_SH_JMP_SLOT, 3, 0);
+			// Unaligned, as R_SH_DIR32 can be
+			AddRelocation(PIE_DATA + 17, R_SH_DIR32, 0, 0x55);
+			AddRelocation(PIE_DATA + 22, R_SH_RELATIVE, 0, 0x40);
+			AddRelocation(PIE_DATA + 26, R_SH_NONE, 0, 0);
+
+			dynamic = {
+				{DT_RELA, {PIE_RELOCATIONS}},
+				{DT_RELASZ, {0}},
+				{DT_RELAENT, {sizeof(Elf32_Rela)}},
+				{DT_SYMTAB, {PIE_SYMBOLS}},
+				{DT_NULL, {0}}
+			};
+		}
+
+		void AddRelocation(uint32_t offset, uint32_t type, uint32_t symbol, int32_t addend) {
+			relocations.push_back({offset, ELF32_R_INFO(symbol, type), addend});
+		}
+
+		std::vector<uint8_t> Build() {
+			std::vector<uint8_t> image = data;
+			dynamic[1].d_un.d_val = relocations.size() * sizeof(Elf32_Rela);
+			memcpy(image.data() + PIE_DYNAMIC, dynamic.data(), dynamic.size() * sizeof(Elf32_Dyn));
+			memcpy(image.data() + PIE_RELOCATIONS, relocations.data(), relocations.size() * sizeof(Elf32_Rela));
+
+			ElfBuilder elf(ET_DYN);
+			elf.SetEntry(0x10);
+			elf.AddSegment(PT_LOAD, 0, image, PIE_MEM_SIZE, PF_R | PF_W | PF_X);
+			elf.AddSegment(
+				PT_DYNAMIC, dynamicAddress, std::vector<uint8_t>(image.begin() + PIE_DYNAMIC, image.begin() + PIE_RELOCATIONS),
+				dynamicSize, PF_R | PF_W
+			);
+			return elf.Build();
+		}
+	};
+
+	uint32_t Word(uint32_t address) {
+		uint32_t word;
+		memcpy(&word, At(address), sizeof(word));
+		return word;
+	}
+
+	/**
+	 * Checks a position-independent app was relocated to run at @p base.
+	 */
+	void CheckRelocated(uint32_t base, uint32_t entry) {
+		CHECK_EQUAL(entry, base + 0x10);
+		CHECK(memcmp(At(base), Pattern(PIE_DATA, 5).data(), PIE_DATA) == 0);
+
+		CHECK_EQUAL(Word(base + PIE_DATA), base + 0x20);
+		CHECK_EQUAL(Word(base + PIE_DATA + 4), base + 0x34);
+		CHECK_EQUAL(Word(base + PIE_DATA + 8), PIE_OS_FUNCTION);
+		CHECK_EQUAL(Word(base + PIE_DATA + 12), 0);
+		CHECK_EQUAL(Word(base + PIE_DATA + 17), 0x55);
+		CHECK_EQUAL(Word(base + PIE_DATA + 22), base + 0x40);
+		CHECK_EQUAL(Word(base + PIE_DATA + 26), 0);
+		CHECK(IsZero(base + PIE_SIZE, PIE_MEM_SIZE - PIE_SIZE));
+		CHECK(Untouched(base + PIE_MEM_SIZE, 16));
+	}
+
+	uint32_t LoadAt(uint32_t base) {
+		memset(At(Apps::APP_LOAD_ADDRESS), UNTOUCHED, MEMORY_END - Apps::APP_LOAD_ADDRESS);
+		return reinterpret_cast<uintptr_t>(Apps::LoadImage(APP_PATH, base));
+	}
+
+	/**
+	 * Loads the same position-independent app at two addresses. Only the
+	 * words the relocations point at may differ, by the distance between the
+	 * two.
+	 */
+	void TestRelocation() {
+		const uint32_t BASE_A = Apps::APP_LOAD_ADDRESS;
+		const uint32_t BASE_B = Apps::APP_LOAD_ADDRESS + 0x4000;
+
+		Stubs::AddFile(APP_PATH, PIE().Build());
+
+		CheckRelocated(BASE_A, LoadAt(BASE_A));
+		std::vector<uint8_t> imageA(At(BASE_A), At(BASE_A + PIE_MEM_SIZE));
+
+		CheckRelocated(BASE_B, LoadAt(BASE_B));
+		std::vector<uint8_t> imageB(At(BASE_B), At(BASE_B + PIE_MEM_SIZE));
+
+		for (uint32_t offset = 0; offset < PIE_MEM_SIZE; offset += 4) {
+			uint32_t a;
+			uint32_t b;
+			memcpy(&a, &imageA[offset], 4);
+			memcpy(&b, &imageB[offset], 4);
+			if (offset >= PIE_DATA && offset < PIE_DATA + 32) {
+				continue;
+			}
+
+			CHECK_EQUAL(a, b);
+		}
+
+		// Without a dynamic segment there's nothing to do
+		ElfBuilder elf(ET_DYN);
+		elf.SetEntry(0x10);
+		elf.AddSegment(PT_LOAD, 0, Pattern(64, 6));
+		Stubs::AddFile(APP_PATH, elf.Build());
+		CHECK_EQUAL(LoadAt(BASE_B), BASE_B + 0x10);
+		CHECK(memcmp(At(BASE_B), Pattern(64, 6).data(), 64) == 0);
+	}
+
+	void CheckRejected(PIE pie) {
+		Stubs::AddFile(APP_PATH, pie.Build());
+		CHECK_EQUAL(LoadAt(Apps::APP_LOAD_ADDRESS), 0);
+	}
+
+	void TestBadRelocations() {
+		PIE pie;
+		pie.AddRelocation(PIE_DATA, R_SH_DIR32, 4, 0);
+		CheckRejected(pie);
+
+		// Far enough past the symbol table to be outside the image
+		pie = PIE();
+		pie.AddRelocation(PIE_DATA, R_SH_DIR32, 0xFFFFFF, 0);
+		CheckRejected(pie);
+
+		pie = PIE();
+		pie.dynamic[3].d_tag = DT_NULL;
+		CheckRejected(pie);
+
+		pie = PIE();
+		pie.AddRelocation(PIE_MEM_SIZE - 2, R_SH_RELATIVE, 0, 0);
+		CheckRejected(pie);
+
+		pie = PIE();
+		pie.AddRelocation(0x10000000, R_SH_RELATIVE, 0, 0);
+		CheckRejected(pie);
+
+		pie = PIE();
+		pie.AddRelocation(PIE_DATA, R_SH_REL32, 0, 0);
+		CheckRejected(pie);
+
+		// A defined symbol which isn't weak can't be resolved
+		pie = PIE();
+		Put(&pie.data, PIE_SYMBOLS + 3 * sizeof(Elf32_Sym) + offsetof(Elf32_Sym, st_info), ELF32_ST_INFO(STB_GLOBAL, STT_FUNC));
+		CheckRejected(pie);
+
+		pie = PIE();
+		pie.dynamic[0].d_un.d_ptr = PIE_MEM_SIZE - 12;
+		CheckRejected(pie);
+
+		pie = PIE();
+		pie.dynamic[2].d_un.d_val = 4;
+		CheckRejected(pie);
+
+		// The dynamic section is read from the loaded image, so must be in it
+		pie = PIE();
+		pie.dynamicAddress = 0x100000;
+		CheckRejected(pie);
+
+		pie = PIE();
+		pie.dynamicAddress = PIE_MEM_SIZE - 8;
+		pie.dynamicSize = 64;
+		CheckRejected(pie);
+
+		// Nor is the dynamic section read past its end, even without
+		// DT_NULL - this one ends before DT_RELASZ, so has no relocations
+		pie = PIE();
+		pie.dynamicSize = sizeof(Elf32_Dyn);
+		Stubs::AddFile(APP_PATH, pie.Build());
+		CHECK(LoadAt(Apps::APP_LOAD_ADDRESS) != 0);
+		CHECK_EQUAL(Word(Apps::APP_LOAD_ADDRESS + PIE_DATA), 0);
+	}
+
+	/**
+	 * Like MakeApp, but with section headers covering the segments, as a
+	 * linked app has. The sections split the text segment at odd offsets.
+	 */
+	ElfBuilder MakeLinkedApp() {
+		ElfBuilder elf = MakeApp();
+		elf.AddSegmentSection(".text", 0, 0, 61);
+		elf.AddSegmentSection(".rodata", 0, 61, 39, SHT_PROGBITS, SHF_ALLOC);
+		elf.AddSegmentSection(".data", 1, 0, 24, SHT_PROGBITS, SHF_ALLOC | SHF_WRITE);
+		elf.AddSegmentSection(".bss", 1, 24, 256 - 24, SHT_NOBITS, SHF_ALLOC | SHF_WRITE);
+		return elf;
+	}
+
+	int SegmentLoads() {
+		return Timing::GetTotal(Timing::PhaseLoadSegments)->count;
+	}
+
+	/**
+	 * Runs the last app again, after it's scribbled over its .data and .bss.
+	 *
+	 * @param reloaded Whether it should have had to be loaded from scratch.
+	 */
+	void CheckRelaunch(bool reloaded) {
+		memset(At(DATA_ADDRESS), 0x55, 256);
+		int loads = SegmentLoads();
+		CheckLoaded(reinterpret_cast<uintptr_t>(Apps::RunLastApp()));
+		CHECK_EQUAL(SegmentLoads() - loads, reloaded ? 1 : 0);
+	}
+
+	void TestRelaunch() {
+		// Without section headers the image is checked by segment, and with
+		// them by section
+		for (int linked = 0; linked < 2; ++linked) {
+			Stubs::AddFile(APP_PATH, (linked ? MakeLinkedApp() : MakeApp()).Build(), 0x5000, 0x100);
+			CheckLoaded(Load());
+
+			// Still in memory, so only .data and .bss are put back
+			CheckRelaunch(false);
+			CheckRelaunch(false);
+
+			// A byte changed anywhere the app can't write to means loading
+			// it again
+			for (uint32_t offset : {0, 1, 60, 61, 62, 64, 98, 99}) {
+				At(TEXT_ADDRESS)[offset] ^= 0x10;
+				CheckRelaunch(true);
+			}
+
+			// As does the file changing
+			Stubs::AddFile(APP_PATH, (linked ? MakeLinkedApp() : MakeApp()).Build(), 0x5000, 0x101);
+			CheckRelaunch(true);
+			CheckRelaunch(false);
+		}
+
+		// An app that isn't there any more can't be run
+		Stubs::RemoveFile(APP_PATH);
+		CHECK(Apps::RunLastApp() == nullptr);
+
+		// Nor one replaced by something that isn't an app
+		std::vector<uint8_t> app = MakeApp().Build();
+		Stubs::AddFile(APP_PATH, app, 0x5000, 0x100);
+		CheckLoaded(Load());
+		reinterpret_cast<Elf32_Ehdr *>(app.data())->e_machine = EM_386;
+		Stubs::AddFile(APP_PATH, app, 0x5000, 0x102);
+		CHECK(Apps::RunLastApp() == nullptr);
+		CHECK(Apps::RunLastApp() == nullptr);
+
+		// Paths as long as the launcher allows are remembered too
+		std::string path = "\\fls0\\";
+		while (path.size() < MAX_PATH_LENGTH - 5) {
+			path += path.size() % 40 == 39 ? '\\' : 'a';
+		}
+		path += ".hhk";
+		CHECK_EQUAL(path.size(), MAX_PATH_LENGTH - 1);
+		Stubs::AddFile(path, MakeApp().Build());
+		memset(At(Apps::APP_LOAD_ADDRESS), UNTOUCHED, MEMORY_END - Apps::APP_LOAD_ADDRESS);
+		CheckLoaded(reinterpret_cast<uintptr_t>(Apps::LoadImage(path.c_str(), Apps::APP_LOAD_ADDRESS)));
+		CheckRelaunch(false);
+		Stubs::RemoveFile(path);
+	}
+
+	// Where the execute-in-place data of the app below is linked to run
+	const uint32_t XIP_ADDRESS = Apps::APP_LOAD_ADDRESS + 0x3000;
+	const uint32_t XIP_SIZE = 64;
+
+	std::vector<uint8_t> RelocationSection(uint32_t offset, uint32_t type, int32_t addend) {
+		std::vector<uint8_t> section(sizeof(Elf32_Rela));
+		Elf32_Rela relocation = {offset, ELF32_R_INFO(1, type), addend};
+		Put(&section, 0, relocation);
+		return section;
+	}
+
+	/**
+	 * An app with execute-in-place data, linked with --emit-relocs. The code
+	 * refers to the data at offset 0x20, and .data at offset 4.
+	 *
+	 * @param relocationType The type of the relocation in .data.
+	 * @param relocations Whether to keep the relocations at all.
+	 */
+	ElfBuilder MakeXIPApp(uint32_t relocationType = R_SH_DIR32, bool relocations = true) {
+		ElfBuilder elf = MakeLinkedApp();
+		// Linked to run at XIP_ADDRESS, but loaded by the launcher itself
+		elf.AddSegment(PT_LOAD, XIP_ADDRESS, Pattern(XIP_SIZE, 6), 0, PF_R, 0x8E100000);
+
+		uint32_t xip = elf.AddSegmentSection(".xip_rodata", 2, 0, XIP_SIZE, SHT_PROGBITS, SHF_ALLOC);
+		if (!relocations) {
+			return elf;
+		}
+
+		std::vector<uint8_t> symbols(2 * sizeof(Elf32_Sym));
+		Elf32_Sym symbol = {};
+		symbol.st_value = XIP_ADDRESS;
+		symbol.st_shndx = xip;
+		Put(&symbols, sizeof(Elf32_Sym), symbol);
+		uint32_t symbolTable = elf.AddSection(".symtab", symbols, SHT_SYMTAB);
+
+		// The first sections are the ones MakeLinkedApp added, after the
+		// metadata
+		elf.AddSection(
+			".rela.text", RelocationSection(TEXT_ADDRESS + 0x20, R_SH_DIR32, 8),
+			SHT_RELA, 0, 0, symbolTable, 2
+		);
+		elf.AddSection(
+			".rela.data", RelocationSection(DATA_ADDRESS + 4, relocationType, 16),
+			SHT_RELA, 0, 0, symbolTable, 4
+		);
+		return elf;
+	}
+
+	uint32_t XIPOffset() {
+		const uint8_t *file = Stubs::MappedFile(APP_PATH);
+		const Elf32_Ehdr *elf = reinterpret_cast<const Elf32_Ehdr *>(file);
+		return reinterpret_cast<const Elf32_Phdr *>(file + elf->e_phoff)[2].p_offset;
+	}
+
+	/**
+	 * Finds where the OS maps an app's XIP data, if the file isn't
+	 * fragmented - only the low 32 bits, as on the calculator.
+	 */
+	uint32_t MappedXIPAddress() {
+		return reinterpret_cast<uintptr_t>(Stubs::MappedFile(APP_PATH) + XIPOffset());
+	}
+
+	/**
+	 * Fragments the file from the start of its XIP data on. The rest of the
+	 * app is always read in one piece.
+	 */
+	void FragmentXIP(bool on) {
+		Stubs::SetMapSectors(on, XIPOffset());
+	}
+
+	/**
+	 * Checks that an XIP app's references to its XIP data point at
+	 * @p address, and whether the data was copied into RAM.
+	 */
+	void CheckXIP(uint32_t entry, uint32_t address, bool copied) {
+		CHECK_EQUAL(entry, TEXT_ADDRESS + 0x10);
+		CHECK_EQUAL(Word(TEXT_ADDRESS + 0x20), address + 8);
+		CHECK_EQUAL(Word(DATA_ADDRESS + 4), address + 16);
+
+		if (copied) {
+			CHECK(memcmp(At(XIP_ADDRESS), Pattern(XIP_SIZE, 6).data(), XIP_SIZE) == 0);
+		} else {
+			CHECK(Untouched(XIP_ADDRESS, XIP_SIZE));
+		}
+
+		// Everything else loads as usual
+		CHECK(memcmp(At(TEXT_ADDRESS), Pattern(100, 1).data(), 0x20) == 0);
+		CHECK(memcmp(At(TEXT_ADDRESS + 0x24), Pattern(100, 1).data() + 0x24, 100 - 0x24) == 0);
+		CHECK(memcmp(At(DATA_ADDRESS), Pattern(24, 2).data(), 4) == 0);
+		CHECK(IsZero(DATA_ADDRESS + 24, 256 - 24));
+	}
+
+	void TestXIP() {
+		// Left on flash, with the references to it pointed there
+		Stubs::AddFile(APP_PATH, MakeXIPApp().Build());
+		CheckXIP(Load(), MappedXIPAddress(), false);
+		Apps::FinishApp();
+
+		// A fragmented file can't be left on flash
+		FragmentXIP(true);
+		CheckXIP(Load(), XIP_ADDRESS, true);
+		FragmentXIP(false);
+
+		// Nor can data whose references can't all be found and fixed up
+		Stubs::AddFile(APP_PATH, MakeXIPApp(R_SH_DIR32, false).Build());
+		CheckLoaded(Load());
+		CHECK(memcmp(At(XIP_ADDRESS), Pattern(XIP_SIZE, 6).data(), XIP_SIZE) == 0);
+
+		Stubs::AddFile(APP_PATH, MakeXIPApp(R_SH_REL32).Build());
+		CheckLoaded(Load());
+		CHECK(memcmp(At(XIP_ADDRESS), Pattern(XIP_SIZE, 6).data(), XIP_SIZE) == 0);
+	}
+
+	/**
+	 * Relaunching an XIP app finds its data again, which may have gone from
+	 * being mapped to not, or the other way around - without loading the
+	 * rest of the app from scratch.
+	 */
+	void TestXIPRelaunch() {
+		Stubs::AddFile(APP_PATH, MakeXIPApp().Build());
+		uint32_t mapped = MappedXIPAddress();
+		CheckXIP(Load(), mapped, false);
+		Apps::FinishApp();
+
+		int loads = SegmentLoads();
+		CheckXIP(reinterpret_cast<uintptr_t>(Apps::RunLastApp()), mapped, false);
+		Apps::FinishApp();
+
+		// The fix-ups are undone, pointing the code back at the copy
+		FragmentXIP(true);
+		CheckXIP(reinterpret_cast<uintptr_t>(Apps::RunLastApp()), XIP_ADDRESS, true);
+		CheckXIP(reinterpret_cast<uintptr_t>(Apps::RunLastApp()), XIP_ADDRESS, true);
+
+		FragmentXIP(false);
+		memset(At(XIP_ADDRESS), UNTOUCHED, XIP_SIZE);
+		CheckXIP(reinterpret_cast<uintptr_t>(Apps::RunLastApp()), mapped, false);
+		Apps::FinishApp();
+		CHECK_EQUAL(SegmentLoads(), loads);
+	}
+
+	void TestNotAnApp() {
+		std::vector<uint8_t> app = MakeApp().Build();
+		reinterpret_cast<Elf32_Ehdr *>(app.data())->e_machine = EM_386;
+		Stubs::AddFile(APP_PATH, app);
+		CHECK_EQUAL(Load(), 0);
+		CHECK(Untouched(TEXT_ADDRESS, 100));
+
+		// With neither program nor section headers, there's nothing to load
+		ElfBuilder elf;
+		elf.SetEntry(TEXT_ADDRESS);
+		elf.Strip();
+		Stubs::AddFile(APP_PATH, elf.Build());
+		CHECK_EQUAL(Load(), 0);
+
+		Stubs::RemoveFile(APP_PATH);
+		CHECK_EQUAL(Load(), 0);
+	}
+}
+
+int main() {
+	void *memory = mmap(
+		At(MEMORY_START), MEMORY_END - MEMORY_START,
+		PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0
+	);
+	if (memory != At(MEMORY_START)) {
+		perror("loader_test: can't map the app's memory");
+		return 1;
+	}
+
+	Timing::Init(false);
+	Stubs::Reset();
+
+	TestSegments();
+	TestStripped();
+	TestOverlay();
+	TestSections();
+	TestCompressed();
+	TestChecksum();
+	TestRelocation();
+	TestBadRelocations();
+	TestRelaunch();
+	TestXIP();
+	TestXIPRelaunch();
+	TestNotAnApp();
+	return TestResult("loader_test");
+}
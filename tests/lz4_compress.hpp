@@ -0,0 +1,79 @@
+#pragma once
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+/**
+ * Compresses data into a single LZ4 block. A port of the greedy compressor in
+ * tools/hhk_compress.py, so the tests decompress the same kind of blocks real
+ * apps contain.
+ */
+inline std::vector<uint8_t> CompressLZ4(const std::vector<uint8_t> &data) {
+	const uint32_t MIN_MATCH = 4;
+	const uint32_t LAST_LITERALS = 5;
+	const uint32_t MATCH_FIND_LIMIT = 12;
+	const uint32_t MAX_OFFSET = 0xFFFF;
+
+	std::vector<uint8_t> out;
+
+	auto writeLength = [&out](uint32_t length) {
+		while (length >= 255) {
+			out.push_back(255);
+			length -= 255;
+		}
+		out.push_back(length);
+	};
+
+	auto writeSequence = [&](uint32_t literalsStart, uint32_t literalsEnd, uint32_t offset, uint32_t matchLength) {
+		uint32_t literalLength = literalsEnd - literalsStart;
+		uint8_t token = (literalLength < 15 ? literalLength : 15) << 4;
+		if (matchLength != 0) {
+			token |= matchLength - MIN_MATCH < 15 ? matchLength - MIN_MATCH : 15;
+		}
+
+		out.push_back(token);
+		if (literalLength >= 15) {
+			writeLength(literalLength - 15);
+		}
+		out.insert(out.end(), data.begin() + literalsStart, data.begin() + literalsEnd);
+
+		if (matchLength != 0) {
+			out.push_back(offset & 0xFF);
+			out.push_back(offset >> 8);
+			if (matchLength - MIN_MATCH >= 15) {
+				writeLength(matchLength - MIN_MATCH - 15);
+			}
+		}
+	};
+
+	std::map<uint32_t, uint32_t> lastSeen;
+	uint32_t anchor = 0;
+	uint32_t i = 0;
+
+	while (i + MATCH_FIND_LIMIT < data.size()) {
+		uint32_t key = data[i] | data[i + 1] << 8 | data[i + 2] << 16 | static_cast<uint32_t>(data[i + 3]) << 24;
+		auto seen = lastSeen.find(key);
+		bool found = seen != lastSeen.end() && i - seen->second <= MAX_OFFSET;
+		uint32_t candidate = found ? seen->second : 0;
+		lastSeen[key] = i;
+
+		if (!found) {
+			++i;
+			continue;
+		}
+
+		uint32_t matchLength = MIN_MATCH;
+		uint32_t maxMatchLength = data.size() - LAST_LITERALS - i;
+		while (matchLength < maxMatchLength && data[candidate + matchLength] == data[i + matchLength]) {
+			++matchLength;
+		}
+
+		writeSequence(anchor, i, i - candidate, matchLength);
+
+		i += matchLength;
+		anchor = i;
+	}
+
+	writeSequence(anchor, data.size(), 0, 0);
+	return out;
+}
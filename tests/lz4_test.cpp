@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "lz4.hpp"
+#include "lz4_compress.hpp"
+#include "test.hpp"
+
+namespace {
+	uint32_t g_seed = 1;
+
+	uint8_t Random() {
+		g_seed = g_seed * 1103515245 + 12345;
+		return g_seed >> 16;
+	}
+
+	/**
+	 * Decompresses @p block into a buffer of exactly @p destSize bytes, with
+	 * the block also copied to a buffer of exactly its size - so the address
+	 * sanitizer catches any access past the end of either.
+	 */
+	int Decompress(const std::vector<uint8_t> &block, uint32_t destSize, std::vector<uint8_t> *out = nullptr) {
+		std::unique_ptr<uint8_t[]> src(new uint8_t[block.size()]);
+		std::copy(block.begin(), block.end(), src.get());
+
+		std::unique_ptr<uint8_t[]> dest(new uint8_t[destSize]);
+		int ret = LZ4::Decompress(src.get(), block.size(), dest.get(), destSize);
+
+		if (out != nullptr && ret >= 0) {
+			out->assign(dest.get(), dest.get() + ret);
+		}
+
+		return ret;
+	}
+
+	std::vector<std::vector<uint8_t>> Samples() {
+		std::vector<std::vector<uint8_t>> samples;
+
+		for (uint32_t size : {0, 1, 5, 12, 13, 14, 100, 4096}) {
+			std::vector<uint8_t> random(size);
+			for (uint8_t &b : random) {
+				b = Random();
+			}
+			samples.push_back(random);
+		}
+
+		// Long runs give overlapping matches, and lengths needing several
+		// extra bytes
+		samples.push_back(std::vector<uint8_t>(1000, 0));
+		samples.push_back(std::vector<uint8_t>(70000, 0x55));
+
+		std::vector<uint8_t> text;
+		const char line[] = "The quick brown fox jumps over the lazy dog. ";
+		for (int i = 0; i < 200; ++i) {
+			text.insert(text.end(), line, line + sizeof(line) - 1 - i % 7);
+		}
+		samples.push_back(text);
+
+		// Repeats further apart than a match can reach
+		std::vector<uint8_t> far(70000);
+		for (uint8_t &b : far) {
+			b = Random();
+		}
+		std::vector<uint8_t> repeat(far.begin(), far.begin() + 1000);
+		far.insert(far.end(), repeat.begin(), repeat.end());
+		samples.push_back(far);
+
+		// Something like code - short repeats mixed with noise
+		std::vector<uint8_t> mixed;
+		while (mixed.size() < 20000) {
+			if (Random() < 128 && mixed.size() > 64) {
+				uint32_t start = mixed.size() - 1 - Random() % 64;
+				uint32_t length = 4 + Random() % 40;
+				for (uint32_t i = 0; i < length; ++i) {
+					mixed.push_back(mixed[start + i]);
+				}
+			} else {
+				mixed.push_back(Random());
+			}
+		}
+		samples.push_back(mixed);
+
+		return samples;
+	}
+
+	void TestRoundTrip() {
+		for (const std::vector<uint8_t> &data : Samples()) {
+			std::vector<uint8_t> block = CompressLZ4(data);
+
+			std::vector<uint8_t> out;
+			CHECK_EQUAL(Decompress(block, data.size(), &out), data.size());
+			CHECK(out == data);
+
+			// Extra room isn't written to
+			CHECK_EQUAL(Decompress(block, data.size() + 100, &out), data.size());
+			CHECK(out == data);
+
+			if (!data.empty()) {
+				CHECK_EQUAL(Decompress(block, data.size() - 1), -1);
+			}
+		}
+	}
+
+	// A truncated block must never decompress to the full size - the loader
+	// relies on that to reject it.
+	void TestTruncated() {
+		for (const std::vector<uint8_t> &data : Samples()) {
+			if (data.empty()) {
+				continue;
+			}
+
+			std::vector<uint8_t> block = CompressLZ4(data);
+			uint32_t step = block.size() > 4000 ? 37 : 1;
+			for (uint32_t length = 0; length < block.size(); length += step) {
+				std::vector<uint8_t> truncated(block.begin(), block.begin() + length);
+				int ret = Decompress(truncated, data.size());
+				CHECK(ret < static_cast<int>(data.size()));
+			}
+		}
+	}
+
+	void TestMalformed() {
+		std::vector<uint8_t> out;
+
+		// 'a', then a match of 4 repeating it
+		CHECK_EQUAL(Decompress({0x10, 'a', 0x01, 0x00, 0x00}, 16, &out), 5);
+		CHECK(out == std::vector<uint8_t>(5, 'a'));
+
+		// A match with an offset of 0
+		CHECK_EQUAL(Decompress({0x10, 'a', 0x00, 0x00}, 16), -1);
+		// A match from before the start of the output
+		CHECK_EQUAL(Decompress({0x10, 'a', 0x02, 0x00}, 16), -1);
+		// The offset cut short
+		CHECK_EQUAL(Decompress({0x10, 'a', 0x01}, 16), -1);
+		// A literal length missing its extra bytes
+		CHECK_EQUAL(Decompress({0xF0}, 16), -1);
+		CHECK_EQUAL(Decompress({0xF0, 0xFF, 0xFF}, 16), -1);
+		// A match length missing its extra bytes
+		CHECK_EQUAL(Decompress({0x1F, 'a', 0x01, 0x00}, 64), -1);
+		// More literals than there is input
+		CHECK_EQUAL(Decompress({0x50, 'a', 'b'}, 16), -1);
+
+		// Random input mustn't read or write out of bounds
+		for (int i = 0; i < 20000; ++i) {
+			std::vector<uint8_t> block(1 + Random() % 64);
+			for (uint8_t &b : block) {
+				b = Random();
+			}
+			Decompress(block, Random() % 256);
+		}
+	}
+}
+
+int main() {
+	TestRoundTrip();
+	TestTruncated();
+	TestMalformed();
+	return TestResult("lz4_test");
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+/**
+ * The OS's file functions have the same names as the host C library's. This
+ * is included before anything else in the launcher and SDK sources built for
+ * the tests, so their calls go to the stand-ins in os_stubs.cpp instead.
+ */
+#define close TestOS_close
+#define fstat TestOS_fstat
+#define lseek TestOS_lseek
+#define mkdir TestOS_mkdir
+#define open TestOS_open
+#define read TestOS_read
+#define remove TestOS_remove
+#define rename TestOS_rename
+#define stat TestOS_stat
+#define write TestOS_write
@@ -0,0 +1,445 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <memory>
+#include "os_stubs.hpp"
+
+// The host's headers define some of the OS's constants as macros, and declare
+// functions with the same names as the OS's (see os_names.hpp)
+#undef EACCES
+#undef EBADF
+#undef EEXIST
+#undef EINVAL
+#undef EMFILE
+#undef ENAMETOOLONG
+#undef ENOENT
+#undef ENOMEM
+#undef ENOSPC
+#undef ENOTEMPTY
+#undef SEEK_CUR
+#undef SEEK_END
+#undef SEEK_SET
+#include "os_names.hpp"
+#include <sdk/os/debug.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/os/lcd.hpp>
+
+namespace {
+	const char ROOT_DIR[] = "\\fls0";
+	const uint32_t SECTOR_SIZE = 512;
+
+	struct Entry {
+		std::vector<uint8_t> data;
+		uint16_t date;
+		uint16_t time;
+		bool isDir;
+	};
+
+	struct OpenFile {
+		// Shared, so a file which is removed while it's open can still be
+		// read through the handle (and getAddr's addresses stay valid)
+		std::shared_ptr<struct Entry> entry;
+		int flags;
+		uint32_t position;
+
+		// Copies handed out by getAddr when mapping a sector at a time, kept
+		// until the file is closed
+		std::vector<std::unique_ptr<uint8_t[]>> sectors;
+	};
+
+	struct OpenFind {
+		std::vector<std::string> names;
+		std::vector<std::shared_ptr<struct Entry>> entries;
+		size_t next;
+	};
+
+	std::map<std::string, std::shared_ptr<struct Entry>> g_entries;
+	std::map<int, struct OpenFile> g_files;
+	std::map<int, struct OpenFind> g_finds;
+	int g_nextHandle = 3;
+	std::vector<struct Stubs::PrintedLine> g_printed;
+	bool g_mapSectors = false;
+	uint32_t g_mapSectorsFrom;
+	struct Stubs::Counts g_counts;
+
+	uint16_t g_vram[320 * 528];
+
+	std::shared_ptr<struct Entry> FindEntry(const char *path) {
+		auto it = g_entries.find(path);
+		return it == g_entries.end() ? nullptr : it->second;
+	}
+
+	struct OpenFile *FindFile(int fd) {
+		auto it = g_files.find(fd);
+		return it == g_files.end() ? nullptr : &it->second;
+	}
+
+	std::string ParentPath(const std::string &path) {
+		size_t separator = path.rfind('\\');
+		return separator == std::string::npos ? "" : path.substr(0, separator);
+	}
+
+	bool Matches(const char *pattern, const char *name) {
+		if (*pattern == '\0') {
+			return *name == '\0';
+		}
+
+		if (*pattern == '*') {
+			return Matches(pattern + 1, name) || (*name != '\0' && Matches(pattern, name + 1));
+		}
+
+		return *pattern == *name && Matches(pattern + 1, name + 1);
+	}
+
+	void FillStat(const struct Entry *entry, struct stat *buf) {
+		*buf = {};
+		buf->fileSize = entry->data.size();
+		buf->lastModifiedDate = entry->date;
+		buf->lastModifiedTime = entry->time;
+	}
+
+	int NextFound(struct OpenFind *find, wchar_t *name, struct findInfo *findInfoBuf) {
+		if (find->next == find->names.size()) {
+			return ENOENT;
+		}
+
+		const std::string &foundName = find->names[find->next];
+		const struct Entry *entry = find->entries[find->next].get();
+		++find->next;
+
+		for (size_t i = 0; i < foundName.size(); ++i) {
+			name[i] = foundName[i];
+		}
+		name[foundName.size()] = 0x0000;
+
+		*findInfoBuf = {};
+		findInfoBuf->type = entry->isDir ? findInfoBuf->EntryTypeDirectory : findInfoBuf->EntryTypeFile;
+		findInfoBuf->size = entry->isDir ? 0 : entry->data.size();
+		return 0;
+	}
+}
+
+namespace Stubs {
+	void Reset() {
+		g_entries.clear();
+		g_printed.clear();
+		AddDir(ROOT_DIR);
+	}
+
+	void AddFile(const std::string &path, const std::vector<uint8_t> &data, uint16_t date, uint16_t time) {
+		g_entries[path] = std::make_shared<struct Entry>(Entry{data, date, time, false});
+	}
+
+	void AddDir(const std::string &path, uint16_t date, uint16_t time) {
+		g_entries[path] = std::make_shared<struct Entry>(Entry{{}, date, time, true});
+	}
+
+	void TouchDir(const std::string &path, uint16_t date, uint16_t time) {
+		std::shared_ptr<struct Entry> entry = FindEntry(path.c_str());
+		if (entry != nullptr) {
+			entry->date = date;
+			entry->time = time;
+		}
+	}
+
+	bool GetFile(const std::string &path, std::vector<uint8_t> *data) {
+		std::shared_ptr<struct Entry> entry = FindEntry(path.c_str());
+		if (entry == nullptr || entry->isDir) {
+			return false;
+		}
+
+		*data = entry->data;
+		return true;
+	}
+
+	const uint8_t *MappedFile(const std::string &path) {
+		std::shared_ptr<struct Entry> entry = FindEntry(path.c_str());
+		if (entry == nullptr || entry->isDir) {
+			return nullptr;
+		}
+
+		return entry->data.data();
+	}
+
+	void RemoveFile(const std::string &path) {
+		g_entries.erase(path);
+	}
+
+	int OpenFile(const std::string &path) {
+		return open(path.c_str(), OPEN_READ);
+	}
+
+	void CloseFile(int fd) {
+		close(fd);
+	}
+
+	void SetMapSectors(bool on, uint32_t from) {
+		g_mapSectors = on;
+		g_mapSectorsFrom = from;
+	}
+
+	const struct Counts &GetCounts() {
+		return g_counts;
+	}
+
+	const std::vector<struct PrintedLine> &GetPrinted() {
+		return g_printed;
+	}
+
+	void ResetCounts() {
+		g_counts = {};
+	}
+}
+
+extern "C" {
+	int open(const char *path, int flags) {
+		++g_counts.opens;
+
+		std::shared_ptr<struct Entry> entry = FindEntry(path);
+		if (entry == nullptr) {
+			if ((flags & OPEN_CREATE) == 0 || FindEntry(ParentPath(path).c_str()) == nullptr) {
+				return ENOENT;
+			}
+
+			Stubs::AddFile(path, {});
+			entry = FindEntry(path);
+		} else if (entry->isDir) {
+			return EISDIRECTORY;
+		}
+
+		int fd = g_nextHandle++;
+		struct OpenFile &file = g_files[fd];
+		file.entry = entry;
+		file.flags = flags;
+		file.position = (flags & OPEN_APPEND) != 0 ? entry->data.size() : 0;
+		return fd;
+	}
+
+	int close(int fd) {
+		return g_files.erase(fd) != 0 ? 0 : EBADF;
+	}
+
+	int read(int fd, void *buf, int count) {
+		struct OpenFile *file = FindFile(fd);
+		if (file == nullptr || (file->flags & OPEN_READ) == 0 || count < 0) {
+			return EBADF;
+		}
+
+		const std::vector<uint8_t> &data = file->entry->data;
+		uint32_t available = file->position < data.size() ? data.size() - file->position : 0;
+		uint32_t size = static_cast<uint32_t>(count) < available ? count : available;
+
+		std::copy(data.begin() + file->position, data.begin() + file->position + size, static_cast<uint8_t *>(buf));
+		file->position += size;
+		return size;
+	}
+
+	int write(int fd, const void *buf, int count) {
+		struct OpenFile *file = FindFile(fd);
+		if (file == nullptr || (file->flags & OPEN_WRITE) == 0 || count < 0) {
+			return EBADF;
+		}
+
+		std::vector<uint8_t> &data = file->entry->data;
+		if (data.size() < file->position + count) {
+			data.resize(file->position + count);
+			data.shrink_to_fit();
+		}
+
+		const uint8_t *bytes = static_cast<const uint8_t *>(buf);
+		std::copy(bytes, bytes + count, data.begin() + file->position);
+		file->position += count;
+		return count;
+	}
+
+	int lseek(int fd, int offset, int whence) {
+		struct OpenFile *file = FindFile(fd);
+		if (file == nullptr) {
+			return EBADF;
+		}
+
+		int64_t position;
+		if (whence == SEEK_SET) {
+			position = offset;
+		} else if (whence == SEEK_CUR) {
+			position = static_cast<int64_t>(file->position) + offset;
+		} else if (whence == SEEK_END) {
+			position = static_cast<int64_t>(file->entry->data.size()) + offset;
+		} else {
+			return EINVAL;
+		}
+
+		if (position < 0) {
+			return EINVAL;
+		}
+
+		file->position = position;
+		return position;
+	}
+
+	int getAddr(int fd, int offset, const void **addr) {
+		++g_counts.getAddrs;
+
+		struct OpenFile *file = FindFile(fd);
+		if (file == nullptr) {
+			return EBADF;
+		}
+
+		const std::vector<uint8_t> &data = file->entry->data;
+		if (offset < 0 || static_cast<uint32_t>(offset) >= data.size()) {
+			return EINVAL;
+		}
+
+		if (!g_mapSectors || static_cast<uint32_t>(offset) < g_mapSectorsFrom) {
+			*addr = data.data() + offset;
+			return 0;
+		}
+
+		uint32_t end = (offset | (SECTOR_SIZE - 1)) + 1;
+		if (end > data.size()) {
+			end = data.size();
+		}
+
+		std::unique_ptr<uint8_t[]> sector(new uint8_t[end - offset]);
+		std::copy(data.begin() + offset, data.begin() + end, sector.get());
+		*addr = sector.get();
+		file->sectors.push_back(std::move(sector));
+		return 0;
+	}
+
+	int fstat(int fd, struct stat *buf) {
+		struct OpenFile *file = FindFile(fd);
+		if (file == nullptr) {
+			return EBADF;
+		}
+
+		FillStat(file->entry.get(), buf);
+		return 0;
+	}
+
+	int stat(const char *path, struct stat *buf) {
+		++g_counts.stats;
+
+		std::shared_ptr<struct Entry> entry = FindEntry(path);
+		if (entry == nullptr) {
+			return ENOENT;
+		}
+
+		FillStat(entry.get(), buf);
+		return 0;
+	}
+
+	int remove(const char *path) {
+		return g_entries.erase(path) != 0 ? 0 : ENOENT;
+	}
+
+	int rename(const char *oldPath, const char *newPath) {
+		std::shared_ptr<struct Entry> entry = FindEntry(oldPath);
+		if (entry == nullptr) {
+			return ENOENT;
+		}
+
+		g_entries.erase(oldPath);
+		g_entries[newPath] = entry;
+		return 0;
+	}
+
+	int mkdir(const char *path) {
+		if (FindEntry(path) != nullptr) {
+			return EEXIST;
+		}
+
+		if (FindEntry(ParentPath(path).c_str()) == nullptr) {
+			return ENOENT;
+		}
+
+		Stubs::AddDir(path);
+		return 0;
+	}
+
+	int findFirst(const wchar_t *path, int *findHandle, wchar_t *name, struct findInfo *findInfoBuf) {
+		++g_counts.finds;
+
+		std::string pattern;
+		for (int i = 0; path[i] != 0x0000; ++i) {
+			pattern += static_cast<char>(path[i]);
+		}
+
+		std::string dir = ParentPath(pattern);
+		pattern = pattern.substr(dir.size() + 1);
+
+		*findHandle = g_nextHandle++;
+		struct OpenFind &find = g_finds[*findHandle];
+		find.next = 0;
+
+		std::string prefix = dir + "\\";
+		for (auto it = g_entries.lower_bound(prefix); it != g_entries.end(); ++it) {
+			if (it->first.compare(0, prefix.size(), prefix) != 0) {
+				break;
+			}
+
+			std::string entryName = it->first.substr(prefix.size());
+			if (entryName.find('\\') == std::string::npos && Matches(pattern.c_str(), entryName.c_str())) {
+				find.names.push_back(entryName);
+				find.entries.push_back(it->second);
+			}
+		}
+
+		return NextFound(&find, name, findInfoBuf);
+	}
+
+	int findNext(int findHandle, wchar_t *name, struct findInfo *findInfoBuf) {
+		++g_counts.finds;
+
+		auto it = g_finds.find(findHandle);
+		if (it == g_finds.end()) {
+			return EBADF;
+		}
+
+		return NextFound(&it->second, name, findInfoBuf);
+	}
+
+	int findClose(int findHandle) {
+		return g_finds.erase(findHandle) != 0 ? 0 : EBADF;
+	}
+
+	void Debug_Printf(int x, int y, bool, int, const char *format, ...) {
+		// Only plain conversions, with no flags or field widths
+		for (const char *c = format; *c != '\0'; ++c) {
+			if (*c == '%' && strchr("%sduxXc", c[1]) == nullptr) {
+				g_printed.push_back({x, y, "<unsupported format>"});
+				return;
+			}
+			c += *c == '%';
+		}
+
+		char text[256];
+		va_list args;
+		va_start(args, format);
+		vsnprintf(text, sizeof(text), format, args);
+		va_end(args);
+		g_printed.push_back({x, y, text});
+	}
+
+	int Debug_WaitKey() {
+		return 0;
+	}
+
+	void LCD_ClearScreen() {
+
+	}
+
+	void LCD_GetSize(int *width, int *height) {
+		*width = 320;
+		*height = 528;
+	}
+
+	uint16_t *LCD_GetVRAMAddress() {
+		return g_vram;
+	}
+
+	void LCD_Refresh() {
+
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Stand-ins for the parts of the OS the tests reach, implemented on the host.
+ *
+ * Files live in memory, keyed by the path the OS would see (for example
+ * @c \\fls0\\app.hhk). Directories have to be added before anything in them
+ * can be listed by @c findFirst.
+ */
+namespace Stubs {
+	/**
+	 * Removes every file and directory, apart from the root @c \\fls0.
+	 */
+	void Reset();
+
+	/**
+	 * Adds a file, replacing any file already at @p path. @p date and
+	 * @p time are reported as its last modified date and time.
+	 */
+	void AddFile(const std::string &path, const std::vector<uint8_t> &data, uint16_t date = 0, uint16_t time = 0);
+	void AddDir(const std::string &path, uint16_t date = 0, uint16_t time = 0);
+
+	/**
+	 * Updates a directory's last modified date and time, like the OS does
+	 * when a file is added to or removed from it.
+	 */
+	void TouchDir(const std::string &path, uint16_t date, uint16_t time);
+
+	/**
+	 * Gets the contents of a file.
+	 *
+	 * @return False if there's no file at @p path.
+	 */
+	bool GetFile(const std::string &path, std::vector<uint8_t> *data);
+
+	/**
+	 * Gets the address @c getAddr maps the start of a file at, while
+	 * @ref SetMapSectors is off.
+	 *
+	 * @return nullptr if there's no file at @p path.
+	 */
+	const uint8_t *MappedFile(const std::string &path);
+	void RemoveFile(const std::string &path);
+
+	/**
+	 * Opens a file for reading with the OS's @c open, for code under test
+	 * which takes a file descriptor.
+	 *
+	 * @return The file descriptor, or a negative error code.
+	 */
+	int OpenFile(const std::string &path);
+	void CloseFile(int fd);
+
+	/**
+	 * When on, @c getAddr only returns a copy of the file up to the end of
+	 * the 512-byte sector the offset is in - as the OS does for a fragmented
+	 * file. Reading past the end of the sector is caught by the address
+	 * sanitizer.
+	 *
+	 * Offsets before @p from are still mapped as a whole, as when only the
+	 * end of a file is fragmented.
+	 */
+	void SetMapSectors(bool on, uint32_t from = 0);
+
+	/**
+	 * The number of calls made to each of the OS's file functions since the
+	 * last call to @ref ResetCounts.
+	 */
+	struct Counts {
+		int opens;
+		int stats;
+		int getAddrs;
+		int finds;
+	};
+
+	const struct Counts &GetCounts();
+	void ResetCounts();
+
+	/**
+	 * Text printed with @c Debug_Printf since the last call to @ref Reset.
+	 * Only plain conversions like @c %s and @c %u are accepted, as the OS's
+	 * printf may not support flags or field widths - anything else is
+	 * recorded as @c "<unsupported format>".
+	 */
+	struct PrintedLine {
+		int x;
+		int y;
+		std::string text;
+	};
+
+	const std::vector<struct PrintedLine> &GetPrinted();
+}
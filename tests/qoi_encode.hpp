@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Appends a big-endian 32-bit number, as QOI and PNG files store them.
+ */
+inline void Put32(std::vector<uint8_t> *out, uint32_t value) {
+	out->push_back(value >> 24);
+	out->push_back(value >> 16);
+	out->push_back(value >> 8);
+	out->push_back(value);
+}
+
+struct RGBA {
+	uint8_t r, g, b, a;
+
+	bool operator==(const struct RGBA &other) const {
+		return r == other.r && g == other.g && b == other.b && a == other.a;
+	}
+};
+
+/**
+ * Encodes pixels as a QOI image, as the reference encoder at qoiformat.org
+ * does.
+ */
+inline std::vector<uint8_t> EncodeQOI(const std::vector<struct RGBA> &pixels, int width, int height, bool alpha) {
+	std::vector<uint8_t> out = {'q', 'o', 'i', 'f'};
+	Put32(&out, width);
+	Put32(&out, height);
+	out.push_back(alpha ? 4 : 3);
+	out.push_back(0);
+
+	struct RGBA index[64] = {};
+	struct RGBA previous = {0, 0, 0, 255};
+	int run = 0;
+
+	for (size_t i = 0; i < pixels.size(); ++i) {
+		const struct RGBA &pixel = pixels[i];
+		if (pixel == previous) {
+			++run;
+			if (run == 62 || i == pixels.size() - 1) {
+				out.push_back(0xC0 | (run - 1));
+				run = 0;
+			}
+			continue;
+		}
+
+		if (run > 0) {
+			out.push_back(0xC0 | (run - 1));
+			run = 0;
+		}
+
+		int hash = (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+		if (index[hash] == pixel) {
+			out.push_back(hash);
+		} else {
+			index[hash] = pixel;
+
+			int8_t red = pixel.r - previous.r;
+			int8_t green = pixel.g - previous.g;
+			int8_t blue = pixel.b - previous.b;
+			int redGreen = red - green;
+			int blueGreen = blue - green;
+
+			if (pixel.a != previous.a) {
+				out.insert(out.end(), {0xFF, pixel.r, pixel.g, pixel.b, pixel.a});
+			} else if (red >= -2 && red <= 1 && green >= -2 && green <= 1 && blue >= -2 && blue <= 1) {
+				out.push_back(0x40 | (red + 2) << 4 | (green + 2) << 2 | (blue + 2));
+			} else if (green >= -32 && green <= 31 && redGreen >= -8 && redGreen <= 7 && blueGreen >= -8 && blueGreen <= 7) {
+				out.push_back(0x80 | (green + 32));
+				out.push_back((redGreen + 8) << 4 | (blueGreen + 8));
+			} else {
+				out.insert(out.end(), {0xFE, pixel.r, pixel.g, pixel.b});
+			}
+		}
+
+		previous = pixel;
+	}
+
+	out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+	return out;
+}
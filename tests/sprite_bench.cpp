@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <vector>
+#include <sdk/gfx/sprite.hpp>
+#include "bench.hpp"
+
+namespace {
+	const int WIDTH = 320;
+	const int HEIGHT = 528;
+	const uint16_t KEY = 0xF81F;
+
+	// Sprites drawn per timed call, at different places
+	const int DRAWS = 64;
+
+	uint32_t g_seed = 8;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	/**
+	 * Makes a round sprite: transparent outside the circle that fits in it,
+	 * which leaves about a fifth of it transparent.
+	 */
+	std::vector<uint16_t> MakeSprite(int size) {
+		std::vector<uint16_t> pixels(size * size);
+		double radius = size / 2.0;
+		for (int y = 0; y < size; ++y) {
+			for (int x = 0; x < size; ++x) {
+				double dx = x + 0.5 - radius;
+				double dy = y + 0.5 - radius;
+				pixels[y * size + x] = dx * dx + dy * dy < radius * radius ? Random(0xF800) : KEY;
+			}
+		}
+
+		return pixels;
+	}
+
+	/**
+	 * What games on the SDK did before the sprite module: a test for the key
+	 * and the edges of the surface at every pixel.
+	 */
+	void DrawByPixel(struct GFX_Surface *surface, const struct GFX_Sprite *sprite, int x, int y) {
+		for (int row = 0; row < sprite->height; ++row) {
+			for (int column = 0; column < sprite->width; ++column) {
+				uint16_t pixel = sprite->pixels[row * sprite->width + column];
+				int px = x + column;
+				int py = y + row;
+				if (pixel != KEY && px >= 0 && py >= 0 && px < surface->width && py < surface->height) {
+					surface->pixels[py * surface->stride + px] = pixel;
+				}
+			}
+		}
+	}
+
+	template <typename Function>
+	void Report(const char *name, int size, Function function) {
+		double time = TimeCalls(function) / DRAWS;
+		printf("%-10s %5dx%-3d %10.0f %10.1f\n", name, size, size, time * 1000, size * size / time);
+	}
+}
+
+/**
+ * Times drawing sprites of typical sizes with each of the three ways the
+ * sprite module has, against a loop over every pixel.
+ */
+int main() {
+	std::vector<uint16_t> screen(WIDTH * HEIGHT);
+	struct GFX_Surface surface;
+	GFX_InitSurface(&surface, screen.data(), WIDTH, HEIGHT);
+
+	const int SIZES[] = {16, 32, 64};
+
+	printf("%-10s %9s %10s %10s\n", "path", "size", "ns/sprite", "Mpixel/s");
+	for (int size : SIZES) {
+		std::vector<uint16_t> pixels = MakeSprite(size);
+		struct GFX_Sprite sprite = {pixels.data(), size, size};
+
+		std::vector<uint16_t> rle(GFX_EncodeRLESprite(&sprite, KEY, nullptr, 0));
+		GFX_EncodeRLESprite(&sprite, KEY, rle.data(), rle.size());
+		struct GFX_RLESprite rleSprite = {rle.data(), size, size};
+
+		// Some clipped by the edges of the screen
+		int xs[DRAWS];
+		int ys[DRAWS];
+		for (int i = 0; i < DRAWS; ++i) {
+			xs[i] = Random(WIDTH + size) - size / 2;
+			ys[i] = Random(HEIGHT + size) - size / 2;
+		}
+
+		Report("opaque", size, [&]() {
+			for (int i = 0; i < DRAWS; ++i) {
+				GFX_DrawSprite(&surface, &sprite, xs[i], ys[i], 0);
+			}
+		});
+		Report("rle", size, [&]() {
+			for (int i = 0; i < DRAWS; ++i) {
+				GFX_DrawRLESprite(&surface, &rleSprite, xs[i], ys[i], 0);
+			}
+		});
+		Report("keyed", size, [&]() {
+			for (int i = 0; i < DRAWS; ++i) {
+				GFX_DrawKeyedSprite(&surface, &sprite, xs[i], ys[i], KEY, 0);
+			}
+		});
+		Report("per pixel", size, [&]() {
+			for (int i = 0; i < DRAWS; ++i) {
+				DrawByPixel(&surface, &sprite, xs[i], ys[i]);
+			}
+		});
+		Report("rle flip", size, [&]() {
+			for (int i = 0; i < DRAWS; ++i) {
+				GFX_DrawRLESprite(&surface, &rleSprite, xs[i], ys[i], GFX_FlipHorizontal | GFX_FlipVertical);
+			}
+		});
+
+		g_benchSink += screen[WIDTH * HEIGHT / 2];
+	}
+
+	return 0;
+}
@@ -0,0 +1,139 @@
+#include <vector>
+#include <sdk/gfx/sprite.hpp>
+#include "canvas.hpp"
+#include "test.hpp"
+
+namespace {
+	const uint16_t KEY = 0xF81F;
+
+	uint32_t g_seed = 4;
+
+	int Random(int range) {
+		g_seed = g_seed * 1103515245 + 12345;
+		return (g_seed >> 8) % range;
+	}
+
+	/**
+	 * Makes a sprite's pixels, with transparent pixels either scattered,
+	 * about half of them, or nearly all of them - so runs of every length
+	 * come up.
+	 */
+	std::vector<uint16_t> MakePixels(int width, int height) {
+		int mode = Random(3);
+		std::vector<uint16_t> pixels(width * height);
+
+		for (uint16_t &pixel : pixels) {
+			bool transparent;
+			if (mode == 0) {
+				transparent = Random(4) == 0;
+			} else if (mode == 1) {
+				transparent = Random(2) == 0;
+			} else {
+				transparent = Random(50) != 0;
+			}
+
+			pixel = transparent ? KEY : Random(0x10000);
+		}
+
+		return pixels;
+	}
+
+	void ExpectSprite(
+		Canvas *canvas, const std::vector<uint16_t> &pixels, int width, int height,
+		int x, int y, int flags, bool keyed
+	) {
+		for (int j = 0; j < height; ++j) {
+			for (int i = 0; i < width; ++i) {
+				int sourceX = (flags & GFX_FlipHorizontal) != 0 ? width - 1 - i : i;
+				int sourceY = (flags & GFX_FlipVertical) != 0 ? height - 1 - j : j;
+				uint16_t pixel = pixels[sourceY * width + sourceX];
+
+				if (!keyed || pixel != KEY) {
+					canvas->Set(x + i, y + j, pixel);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Draws random sprites with each of the three functions, hanging off
+	 * the edges of surfaces with odd alignments and clip rectangles.
+	 */
+	void TestDraw() {
+		for (int i = 0; i < 6000; ++i) {
+			int width = i % 3 == 0 ? 1 + Random(300) : 1 + Random(40);
+			int height = 1 + Random(20);
+
+			// Kept in vectors of exactly the right size, so the address
+			// sanitizer catches reading past the end
+			std::vector<uint16_t> pixels = MakePixels(width, height);
+			struct GFX_Sprite sprite = {pixels.data(), width, height};
+
+			int size = GFX_EncodeRLESprite(&sprite, KEY, nullptr, 0);
+			CHECK(size > 0);
+			std::vector<uint16_t> rle(size);
+			CHECK_EQUAL(GFX_EncodeRLESprite(&sprite, KEY, rle.data(), size), size);
+			struct GFX_RLESprite rleSprite = {rle.data(), width, height};
+
+			int surfaceWidth = 20 + Random(30);
+			int surfaceHeight = 20 + Random(20);
+			int offset = Random(2);
+			bool clipped = Random(2) == 0;
+			struct GFX_Rect clip = {Random(30) - 5, Random(30) - 5, Random(40), Random(40)};
+
+			int x = Random(surfaceWidth + width) - width;
+			int y = Random(surfaceHeight + height) - height;
+			int flags = Random(4);
+
+			for (int function = 0; function < 3; ++function) {
+				Canvas canvas(surfaceWidth, surfaceHeight, surfaceWidth + 3, offset);
+				if (clipped) {
+					GFX_SetClip(&canvas.surface, &clip);
+				}
+
+				if (function == 0) {
+					GFX_DrawSprite(&canvas.surface, &sprite, x, y, flags);
+				} else if (function == 1) {
+					GFX_DrawKeyedSprite(&canvas.surface, &sprite, x, y, KEY, flags);
+				} else {
+					GFX_DrawRLESprite(&canvas.surface, &rleSprite, x, y, flags);
+				}
+
+				ExpectSprite(&canvas, pixels, width, height, x, y, flags, function != 0);
+				CHECK(canvas.Matches());
+			}
+		}
+	}
+
+	void TestEncode() {
+		std::vector<uint16_t> pixels = {KEY, KEY, 1, 2, KEY, 3};
+		struct GFX_Sprite sprite = {pixels.data(), 3, 2};
+
+		// Each row's offset, then the rows' runs: 2 transparent pixels and 1
+		// opaque one, then 1 opaque, and 1 transparent and 1 opaque
+		std::vector<uint16_t> expected = {2, 4, 0x0201, 1, 0x0001, 2, 0x0101, 3};
+
+		int size = GFX_EncodeRLESprite(&sprite, KEY, nullptr, 0);
+		std::vector<uint16_t> rle(size, 0xDEAD);
+		CHECK_EQUAL(GFX_EncodeRLESprite(&sprite, KEY, rle.data(), size), size);
+		CHECK(rle == expected);
+
+		// Too little space writes nothing, but still gives the size
+		std::vector<uint16_t> small(size - 1, 0xDEAD);
+		CHECK_EQUAL(GFX_EncodeRLESprite(&sprite, KEY, small.data(), size - 1), size);
+		CHECK(small == std::vector<uint16_t>(size - 1, 0xDEAD));
+
+		// Decoding it with nothing in the way gives back the original
+		Canvas canvas(3, 2, 3);
+		struct GFX_RLESprite rleSprite = {rle.data(), 3, 2};
+		GFX_DrawRLESprite(&canvas.surface, &rleSprite, 0, 0, 0);
+		ExpectSprite(&canvas, pixels, 3, 2, 0, 0, 0, true);
+		CHECK(canvas.Matches());
+	}
+}
+
+int main() {
+	TestDraw();
+	TestEncode();
+	return TestResult("sprite_test");
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <stdio.h>
+
+/**
+ * The number of checks which have failed. A failed check doesn't stop the
+ * test, so one run reports everything that's wrong.
+ */
+inline int g_testFailures = 0;
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			++g_testFailures; \
+		} \
+	} while (0)
+
+#define CHECK_EQUAL(actual, expected) \
+	do { \
+		long long actualValue = (actual); \
+		long long expectedValue = (expected); \
+		if (actualValue != expectedValue) { \
+			fprintf( \
+				stderr, "%s:%d: %s is %lld, expected %lld\n", \
+				__FILE__, __LINE__, #actual, actualValue, expectedValue \
+			); \
+			++g_testFailures; \
+		} \
+	} while (0)
+
+/**
+ * Reports the result of the test, to be returned from @c main.
+ */
+inline int TestResult(const char *name) {
+	if (g_testFailures != 0) {
+		fprintf(stderr, "%s: %d check(s) failed\n", name, g_testFailures);
+		return 1;
+	}
+
+	printf("%s: passed\n", name);
+	return 0;
+}
@@ -0,0 +1,169 @@
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include "os_stubs.hpp"
+#include "test.hpp"
+#include "timing.hpp"
+
+namespace {
+	const char LOG_PATH[] = "\\fls0\\hhk_timing.log";
+
+	void Sleep(uint32_t microseconds) {
+		struct timespec duration = {0, static_cast<long>(microseconds) * 1000};
+		nanosleep(&duration, nullptr);
+	}
+
+	/**
+	 * The host's default timer is clock_gettime, counting in microseconds.
+	 */
+	void TestClock() {
+		Timing::Init(true);
+
+		uint32_t start = Timing::Now();
+		Sleep(5000);
+		uint32_t elapsed = Timing::ToMicroseconds(Timing::Now() - start);
+		CHECK(elapsed >= 5000 && elapsed < 1000000);
+
+		{
+			Timing::Probe outer(Timing::PhaseRunApp);
+			for (int i = 0; i < 3; ++i) {
+				Timing::Probe inner(Timing::PhaseVerify);
+				Sleep(1000);
+			}
+		}
+
+		const struct Timing::PhaseTotal *outer = Timing::GetTotal(Timing::PhaseRunApp);
+		const struct Timing::PhaseTotal *inner = Timing::GetTotal(Timing::PhaseVerify);
+		CHECK_EQUAL(outer->count, 1);
+		CHECK_EQUAL(inner->count, 3);
+		CHECK(inner->ticks >= 3000);
+		CHECK(outer->ticks >= inner->ticks);
+
+		Timing::Shutdown();
+
+		// Starting again clears the totals
+		Timing::Init(true);
+		CHECK_EQUAL(Timing::GetTotal(Timing::PhaseRunApp)->count, 0);
+		CHECK_EQUAL(Timing::GetTotal(Timing::PhaseRunApp)->ticks, 0);
+		Timing::Shutdown();
+	}
+
+	void TestDisabled() {
+		Timing::Init(false);
+		{
+			Timing::Probe probe(Timing::PhaseSort);
+			Sleep(1000);
+		}
+
+		// Still counted, but with no time taken
+		CHECK_EQUAL(Timing::GetTotal(Timing::PhaseSort)->count, 1);
+		CHECK_EQUAL(Timing::GetTotal(Timing::PhaseSort)->ticks, 0);
+	}
+
+	// A counter that steps by 3 each time it's read, starting just before it
+	// wraps around, with ticks half a microsecond long
+	uint32_t g_ticks;
+
+	uint32_t FakeRead() {
+		g_ticks += 3;
+		return g_ticks;
+	}
+
+	uint32_t FakeToMicroseconds(uint32_t ticks) {
+		return ticks / 2;
+	}
+
+	const struct Timing::TimerSource FAKE_TIMER_SOURCE = {
+		FakeRead, FakeToMicroseconds
+	};
+
+	void StartFakeTimer() {
+		Timing::Init(false);
+		g_ticks = 0xFFFFFFFA;
+		Timing::SetTimerSource(&FAKE_TIMER_SOURCE);
+	}
+
+	void TestWrapAround() {
+		StartFakeTimer();
+		{
+			Timing::Probe probe(Timing::PhaseFind);
+		}
+		{
+			Timing::Probe probe(Timing::PhaseFind);
+		}
+
+		CHECK_EQUAL(Timing::GetTotal(Timing::PhaseFind)->count, 2);
+		CHECK_EQUAL(Timing::GetTotal(Timing::PhaseFind)->ticks, 6);
+		CHECK_EQUAL(Timing::ToMicroseconds(Timing::GetTotal(Timing::PhaseFind)->ticks), 3);
+	}
+
+	/**
+	 * The table is laid out by the launcher itself, rather than with field
+	 * widths the OS's printf may not support.
+	 */
+	void TestBreakdown() {
+		StartFakeTimer();
+		for (int i = 0; i < 12; ++i) {
+			Timing::Probe probe(Timing::PhaseRunApp);
+		}
+		Timing::Record(Timing::PhaseLauncher, Timing::Now() - 2000000);
+
+		Stubs::Reset();
+		Timing::ShowBreakdown();
+
+		const std::vector<struct Stubs::PrintedLine> &printed = Stubs::GetPrinted();
+		CHECK_EQUAL(printed.size(), Timing::NumPhases + 1);
+		if (printed.size() != Timing::NumPhases + 1) {
+			return;
+		}
+
+		CHECK(printed[0].text == "Phase                  us  count");
+		CHECK(printed[1 + Timing::PhaseLauncher].text == "Launcher          1000001      1");
+		CHECK(printed[1 + Timing::PhaseRunApp].text == "RunApp                 18     12");
+		CHECK(printed[1 + Timing::PhaseLoadAppInfo].text == " LoadAppInfo            0      0");
+
+		for (size_t i = 0; i < printed.size(); ++i) {
+			CHECK_EQUAL(printed[i].y, i * 12);
+			CHECK_EQUAL(printed[i].text.size(), 32);
+		}
+	}
+
+	void TestLog() {
+		Stubs::Reset();
+		StartFakeTimer();
+		{
+			Timing::Probe probe(Timing::PhaseRelocate);
+		}
+
+		// Only written to once it's been created
+		CHECK(!Timing::LogEnabled(LOG_PATH));
+		Timing::AppendToLog(LOG_PATH);
+		std::vector<uint8_t> log;
+		CHECK(!Stubs::GetFile(LOG_PATH, &log));
+
+		Stubs::AddFile(LOG_PATH, {});
+		CHECK(Timing::LogEnabled(LOG_PATH));
+		Timing::AppendToLog(LOG_PATH);
+		Timing::AppendToLog(LOG_PATH);
+		CHECK(Stubs::GetFile(LOG_PATH, &log));
+
+		std::string entry;
+		for (int i = 0; i < Timing::NumPhases; ++i) {
+			Timing::Phase phase = static_cast<Timing::Phase>(i);
+			entry += Timing::GetPhaseName(phase);
+			entry += phase == Timing::PhaseRelocate ? ": 1us x1\n" : ": 0us x0\n";
+		}
+		entry += "\n";
+		CHECK(std::string(log.begin(), log.end()) == entry + entry);
+	}
+}
+
+int main() {
+	TestClock();
+	TestDisabled();
+	TestWrapAround();
+	TestBreakdown();
+	TestLog();
+	return TestResult("timing_test");
+}
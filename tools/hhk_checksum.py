@@ -0,0 +1,121 @@
+import argparse
+import struct
+import zlib
+
+# Big-endian, as that's what the fx-CP400 uses
+ELF_HEADER_FORMAT = '>16sHHIIIIIHHHHHH'
+PROGRAM_HEADER_FORMAT = '>IIIIIIII'
+SECTION_HEADER_FORMAT = '>IIIIIIIIII'
+
+PT_LOAD = 1
+
+# Must match sdk/include/appdef.hpp
+HOLLYHOCK_META_MAGIC = 0x48484B4D
+HOLLYHOCK_META_VERSION = 2
+HOLLYHOCK_META_FLAG_CRC32 = 1 << 0
+META_FLAGS_OFFSET = 6
+META_CRC32_OFFSET = 32
+META_HEADER_SIZE = 36
+
+def checksum_segments(elf):
+	"""Computes the CRC-32 the launcher checks an app against.
+
+	This covers the file contents of every PT_LOAD segment, in program header
+	order. For a compressed app, that's the compressed data.
+
+	Args:
+		elf: The contents of the ELF file.
+
+	Returns:
+		The CRC-32, as an unsigned integer.
+	"""
+
+	header = struct.unpack_from(ELF_HEADER_FORMAT, elf)
+	e_phoff, e_phentsize, e_phnum = header[5], header[9], header[10]
+
+	crc = 0
+	for i in range(e_phnum):
+		p_type, p_offset, _, _, p_filesz, _, _, _ = struct.unpack_from(
+			PROGRAM_HEADER_FORMAT, elf, e_phoff + i * e_phentsize
+		)
+
+		if p_type == PT_LOAD:
+			crc = zlib.crc32(elf[p_offset:p_offset + p_filesz], crc)
+
+	return crc & 0xFFFFFFFF
+
+def find_meta(elf):
+	"""Finds the app's .hollyhock_meta section.
+
+	Args:
+		elf: The contents of the ELF file.
+
+	Returns:
+		The file offset of the section, or None if there isn't one (or it was
+		built with an SDK too old to have room for a checksum).
+	"""
+
+	header = struct.unpack_from(ELF_HEADER_FORMAT, elf)
+	e_shoff, e_shentsize, e_shnum, e_shstrndx = header[6], header[11], header[12], header[13]
+	if e_shoff == 0:
+		return None
+
+	section_headers = [
+		struct.unpack_from(SECTION_HEADER_FORMAT, elf, e_shoff + i * e_shentsize)
+		for i in range(e_shnum)
+	]
+	string_table_offset = section_headers[e_shstrndx][4]
+
+	for section_header in section_headers:
+		sh_name, sh_offset, sh_size = section_header[0], section_header[4], section_header[5]
+
+		name_start = string_table_offset + sh_name
+		name = elf[name_start:elf.index(b'\0', name_start)]
+		if name != b'.hollyhock_meta':
+			continue
+
+		if sh_size < META_HEADER_SIZE:
+			return None
+
+		magic, version = struct.unpack_from('>IH', elf, sh_offset)
+		if magic != HOLLYHOCK_META_MAGIC or version != HOLLYHOCK_META_VERSION:
+			return None
+
+		return sh_offset
+
+	return None
+
+def parse_args():
+	parser = argparse.ArgumentParser(
+		description='Stores a checksum in a .hhk file, which the launcher verifies before running the app.'
+	)
+	parser.add_argument(
+		'path',
+		help='Path to the .hhk file. It\'s modified in place, so this must be run after anything else which changes the file (such as hhk_compress.py).'
+	)
+
+	return parser.parse_args()
+
+def main():
+	args = parse_args()
+
+	with open(args.path, 'rb') as f:
+		elf = bytearray(f.read())
+
+	if elf[0:4] != b'\x7fELF':
+		raise SystemExit('{} is not an ELF file'.format(args.path))
+
+	meta_offset = find_meta(elf)
+	if meta_offset is None:
+		raise SystemExit('{} has no .hollyhock_meta section (use APP_INFO), or it was built with an older SDK'.format(args.path))
+
+	flags, = struct.unpack_from('>H', elf, meta_offset + META_FLAGS_OFFSET)
+	struct.pack_into('>H', elf, meta_offset + META_FLAGS_OFFSET, flags | HOLLYHOCK_META_FLAG_CRC32)
+	# The metadata isn't part of any segment, so this doesn't change the CRC
+	struct.pack_into('>I', elf, meta_offset + META_CRC32_OFFSET, checksum_segments(elf))
+
+	with open(args.path, 'wb') as f:
+		f.write(elf)
+
+if __name__ == '__main__':
+	main()
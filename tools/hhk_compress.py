@@ -0,0 +1,262 @@
+import argparse
+import struct
+
+# Big-endian, as that's what the fx-CP400 uses
+ELF_HEADER_FORMAT = '>16sHHIIIIIHHHHHH'
+PROGRAM_HEADER_FORMAT = '>IIIIIIII'
+SECTION_HEADER_FORMAT = '>IIIIIIIIII'
+
+PT_LOAD = 1
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+# Must match the value in launcher/apps.cpp
+PF_HHK_LZ4 = 0x00100000
+
+LZ4_MIN_MATCH = 4
+LZ4_LAST_LITERALS = 5
+LZ4_MATCH_FIND_LIMIT = 12
+LZ4_MAX_OFFSET = 0xFFFF
+
+def lz4_write_length(out, length):
+	"""Writes the extra bytes of an LZ4 literal/match length.
+
+	Args:
+		out: The bytearray to append to.
+		length: The length, minus the 15 already stored in the token.
+	"""
+
+	while length >= 255:
+		out.append(255)
+		length -= 255
+	out.append(length)
+
+def lz4_write_sequence(out, literals, offset=0, match_length=0):
+	"""Writes an LZ4 sequence (some literals, optionally followed by a match).
+
+	Args:
+		out: The bytearray to append to.
+		literals: The literal bytes of the sequence.
+		offset: How far back the match starts. Ignored if match_length is 0.
+		match_length: The length of the match, or 0 for the final sequence.
+	"""
+
+	literal_length = len(literals)
+	token = min(literal_length, 15) << 4
+	if match_length:
+		token |= min(match_length - LZ4_MIN_MATCH, 15)
+
+	out.append(token)
+	if literal_length >= 15:
+		lz4_write_length(out, literal_length - 15)
+	out += literals
+
+	if match_length:
+		out += struct.pack('<H', offset)
+		if match_length - LZ4_MIN_MATCH >= 15:
+			lz4_write_length(out, match_length - LZ4_MIN_MATCH - 15)
+
+def lz4_compress(data):
+	"""Compresses data into a single LZ4 block, using a greedy match finder.
+
+	Args:
+		data: The bytes to compress.
+
+	Returns:
+		The compressed block, as a bytearray.
+	"""
+
+	out = bytearray()
+	last_seen = {}
+	anchor = 0
+	i = 0
+
+	# The format requires the last match to start at least 12 bytes before the
+	# end of the block, and the last 5 bytes to be literals.
+	while i < len(data) - LZ4_MATCH_FIND_LIMIT:
+		key = data[i:i + LZ4_MIN_MATCH]
+		candidate = last_seen.get(key)
+		last_seen[key] = i
+
+		if candidate is None or i - candidate > LZ4_MAX_OFFSET:
+			i += 1
+			continue
+
+		match_length = LZ4_MIN_MATCH
+		max_match_length = len(data) - LZ4_LAST_LITERALS - i
+		while match_length < max_match_length and data[candidate + match_length] == data[i + match_length]:
+			match_length += 1
+
+		lz4_write_sequence(out, data[anchor:i], i - candidate, match_length)
+
+		i += match_length
+		anchor = i
+
+	lz4_write_sequence(out, data[anchor:])
+	return out
+
+def align(out, alignment):
+	"""Pads a bytearray with zeroes to a multiple of alignment bytes."""
+
+	if alignment > 1:
+		out += bytes(-len(out) % alignment)
+
+def compress_elf(elf):
+	"""Compresses the PT_LOAD segments of an app's ELF file.
+
+	The file is laid out again from scratch: the ELF header, the program
+	headers, the (compressed) segments, the non-allocated sections (such as
+	the app's metadata) and finally the section headers. Segments which don't
+	get any smaller are stored uncompressed.
+
+	Sections which are part of a segment no longer have their own data in the
+	file, so their sh_offset is zeroed. The same goes for the p_offset of
+	segments other than PT_LOAD - their contents are only available once the
+	app has been loaded.
+
+	Overlay segments (whose load address differs from their run address) are
+	always stored uncompressed, as apps load them straight from the file. The
+	same goes for execute-in-place data, which is linked the same way.
+
+	Args:
+		elf: The contents of the ELF file.
+
+	Returns:
+		A tuple of the compressed ELF file, and a list of (virtual address,
+		original size, stored size) for each PT_LOAD segment.
+	"""
+
+	header = list(struct.unpack_from(ELF_HEADER_FORMAT, elf))
+	(
+		e_ident, e_type, e_machine, e_version, e_entry, e_phoff, e_shoff,
+		e_flags, e_ehsize, e_phentsize, e_phnum, e_shentsize, e_shnum,
+		e_shstrndx
+	) = header
+
+	program_headers = [
+		list(struct.unpack_from(PROGRAM_HEADER_FORMAT, elf, e_phoff + i * e_phentsize))
+		for i in range(e_phnum)
+	]
+	section_headers = [
+		list(struct.unpack_from(SECTION_HEADER_FORMAT, elf, e_shoff + i * e_shentsize))
+		for i in range(e_shnum)
+	] if e_shoff != 0 else []
+
+	out = bytearray(struct.calcsize(ELF_HEADER_FORMAT))
+	new_phoff = len(out)
+	out += bytes(e_phnum * struct.calcsize(PROGRAM_HEADER_FORMAT))
+
+	stats = []
+	# (old offset, size, new offset) of each overlay segment
+	overlays = []
+	for program_header in program_headers:
+		p_type, p_offset, p_vaddr, p_paddr, p_filesz, p_memsz, p_flags, p_align = program_header
+
+		if p_type != PT_LOAD:
+			program_header[1] = 0
+			continue
+
+		data = elf[p_offset:p_offset + p_filesz]
+
+		align(out, 4)
+		program_header[1] = len(out)
+
+		if p_paddr != p_vaddr:
+			overlays.append((p_offset, p_filesz, len(out)))
+			out += data
+			stats.append((p_vaddr, p_filesz, p_filesz))
+			continue
+
+		compressed = struct.pack('>I', p_filesz) + lz4_compress(data)
+		if p_filesz > 0 and len(compressed) < p_filesz:
+			out += compressed
+			program_header[4] = len(compressed)
+			program_header[6] = p_flags | PF_HHK_LZ4
+		else:
+			out += data
+
+		stats.append((p_vaddr, p_filesz, program_header[4]))
+
+	for section_header in section_headers[1:]:
+		sh_type, sh_flags, sh_offset, sh_size, sh_addralign = (
+			section_header[1], section_header[2], section_header[4],
+			section_header[5], section_header[8]
+		)
+
+		if sh_flags & SHF_ALLOC:
+			# Overlays are found through their section headers, so keep those
+			# pointing at the right place.
+			section_header[4] = 0
+			for old_offset, size, new_offset in overlays:
+				if sh_type != SHT_NOBITS and old_offset <= sh_offset < old_offset + size:
+					section_header[4] = new_offset + sh_offset - old_offset
+			continue
+
+		if sh_type == SHT_NOBITS:
+			continue
+
+		align(out, sh_addralign)
+		section_header[4] = len(out)
+		out += elf[sh_offset:sh_offset + sh_size]
+
+	align(out, 4)
+	new_shoff = len(out) if section_headers else 0
+	for section_header in section_headers:
+		out += struct.pack(SECTION_HEADER_FORMAT, *section_header)
+
+	for i, program_header in enumerate(program_headers):
+		struct.pack_into(
+			PROGRAM_HEADER_FORMAT, out,
+			new_phoff + i * struct.calcsize(PROGRAM_HEADER_FORMAT),
+			*program_header
+		)
+
+	header[5] = new_phoff
+	header[6] = new_shoff
+	header[9] = struct.calcsize(PROGRAM_HEADER_FORMAT)
+	header[11] = struct.calcsize(SECTION_HEADER_FORMAT)
+	struct.pack_into(ELF_HEADER_FORMAT, out, 0, *header)
+
+	return out, stats
+
+def parse_args():
+	parser = argparse.ArgumentParser(
+		description='Compresses the loadable segments of a .hhk file, to reduce its size on flash.'
+	)
+	parser.add_argument(
+		'input_path',
+		help='Path to the .hhk file to compress.'
+	)
+	parser.add_argument(
+		'output_path',
+		help='Path to save the compressed .hhk file to. May be the same as the input path.'
+	)
+	parser.add_argument(
+		'-v', '--verbose',
+		action='store_true',
+		help='Print the size of each segment before and after compression.'
+	)
+
+	return parser.parse_args()
+
+def main():
+	args = parse_args()
+
+	with open(args.input_path, 'rb') as f:
+		elf = f.read()
+
+	if elf[0:4] != b'\x7fELF':
+		raise SystemExit('{} is not an ELF file'.format(args.input_path))
+
+	compressed, stats = compress_elf(elf)
+
+	with open(args.output_path, 'wb') as f:
+		f.write(compressed)
+
+	if args.verbose:
+		for vaddr, original_size, stored_size in stats:
+			print('segment 0x{:08X}: {} -> {} bytes'.format(vaddr, original_size, stored_size))
+		print('{}: {} -> {} bytes'.format(args.output_path, len(elf), len(compressed)))
+
+if __name__ == '__main__':
+	main()